@@ -13,13 +13,17 @@
 #include <texpress/events/event_manager.hpp>
 #include <texpress/events/event.hpp>
 #include <texpress/compression/compressor.hpp>
+#include <texpress/compression/bricks.hpp>
 #include <texpress/io/file_io.hpp>
 #include <texpress/io/image_io.hpp>
 #include <texpress/io/hdf_io.hpp>
+#include <texpress/io/mapped_io.hpp>
+#include <texpress/io/ktx_index.hpp>
 #include <texpress/io/regular_grid_io.hpp>
 #include <texpress/types/image.hpp>
 #include <texpress/types/regular_grid.hpp>
 #include <texpress/types/texture.hpp>
+#include <texpress/types/texture_view.hpp>
 #include <texpress/helpers/datahelper.hpp>
 #include <texpress/helpers/typehelper.hpp>
 #include <texpress/helpers/ktxhelper.hpp>
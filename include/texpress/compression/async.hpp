@@ -0,0 +1,61 @@
+#pragma once
+
+#include <texpress/compression/compressor.hpp>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+
+namespace texpress
+{
+    struct  CompressionProgress {
+        uint64_t bytes_done = 0;                // Encoded bytes written so far
+        uint64_t bytes_total = 0;
+        float fraction = 0.0f;                  // bytes_done / bytes_total
+        double seconds_elapsed = 0.0;
+        double seconds_remaining = -1.0;        // Estimated from the rate so far, negative until the first slice is done
+    };
+
+    typedef std::function<void(const CompressionProgress&)> CompressionCallback;
+
+    // Handle of a compression running on its own thread. Copies share the same task.
+    // Destroying the last handle of a running task waits for it, cancel first to abort.
+    class  CompressionTask {
+    public:
+        CompressionTask() = default;
+
+        bool valid() const { return state != nullptr; }
+        bool ready() const;
+        void wait() const;
+        // Waits and returns the result of Encoder::compress, false if failed or cancelled
+        bool get() const;
+        // Output of the compression, complete once ready
+        const EncoderData& output() const { return state->output; }
+
+        // Cooperative, the encoder stops after the slices currently being compressed
+        void cancel();
+        bool cancelled() const;
+        CompressionProgress progress() const;
+
+    private:
+        friend CompressionTask compress_async(const EncoderSettings& settings, const EncoderData& input, const EncoderData& output, CompressionCallback callback);
+
+        struct State {
+            EncoderData output;
+            std::atomic<bool> cancel = false;
+            std::chrono::steady_clock::time_point start;
+            mutable std::mutex mutex;           // Guards latest
+            CompressionProgress latest;
+        };
+
+        std::shared_ptr<State> state;
+        std::shared_future<bool> result;
+    };
+
+    // Starts Encoder::compress on a new thread and returns immediately. settings are copied, progress_ptr and
+    // cancel_ptr of them are replaced by the task. input data and the buffer of output must stay valid until the task is ready.
+    // callback is called from the encoder threads after every slice.
+    CompressionTask compress_async(const EncoderSettings& settings, const EncoderData& input, const EncoderData& output, CompressionCallback callback = {});
+}
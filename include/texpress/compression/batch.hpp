@@ -0,0 +1,39 @@
+#pragma once
+
+#include <texpress/compression/pipeline.hpp>
+#include <string>
+#include <vector>
+
+namespace texpress
+{
+    struct  BatchSettings {
+        std::vector<std::string> inputs;                        // Files or patterns with * and ? in the file name, e.g. "data/step_*.h5"
+        PipelineSettings pipeline;                              // Used for every file, input and output paths are set per job
+        std::string output_dir;                                 // Compressed files are written as <output_dir>/<stem><output_extension>, nothing is saved if empty
+        std::string output_extension = ".ktx";                  // .ktx or .raw
+        bool save_decoded = false;                              // Also write <stem>_decoded<output_extension>
+        bool save_error = false;                                // Also write the component error as <stem>_error.raw
+        uint32_t jobs = 0;                                      // Files processed concurrently, 0 uses all hardware threads
+        uint64_t memory_budget = 0;                             // Upper bound of the estimated memory of all running jobs in bytes, 0 is unlimited
+        int* progress_ptr = nullptr;                            // Percentage of finished files, console output if null
+    };
+
+    struct  BatchResult {
+        std::string input;
+        uint64_t memory_estimate = 0;                           // Bytes reserved from the memory budget
+        PipelineStats stats;
+    };
+
+    // Expands patterns into existing files, sorted by name. Entries without wildcards are passed through.
+    std::vector<std::string> expand_inputs(const std::vector<std::string>& patterns);
+
+    // Rough peak memory of running the pipeline on one file: source, normalized copy, compressed and decoded data.
+    uint64_t estimate_memory(const PipelineSettings& settings);
+
+    // Runs the pipeline on every input. Jobs are distributed largest first over per-worker queues, a worker whose queue
+    // is empty takes from the back of the others; all queues share one scheduler lock. Each job runs its own Encoder. A job only starts if its estimate fits into what is
+    // left of the memory budget; a job larger than the whole budget runs once nothing else is running.
+    // Fails before running anything if two inputs would write the same output file, e.g. a/step_0.h5 and b/step_0.h5.
+    // results holds one entry per input in the order of expand_inputs.
+    bool batch_compress(const BatchSettings& settings, std::vector<BatchResult>& results);
+}
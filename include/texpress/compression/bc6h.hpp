@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstdint>
+
+namespace texpress
+{
+    // Effort of the native encoder, mirrors nvtt::Quality.
+    enum  BC6HQuality {
+        BC6H_FASTEST = 0,   // Single region modes, no refinement
+        BC6H_NORMAL,        // All modes, best partition, one refinement pass
+        BC6H_PRODUCTION,    // All modes, 4 best partitions, two refinement passes
+        BC6H_HIGHEST        // All modes, 8 best partitions, four refinement passes and endpoint perturbation
+    };
+
+    struct  BC6HOptions {
+        bool is_signed = true;                          // BC6HS (signed) or BC6HU (unsigned, negative values are clamped to 0)
+        BC6HQuality quality = BC6HQuality::BC6H_FASTEST;
+        float weights[3] = { 1.0f, 1.0f, 1.0f };        // Per channel weights of the squared error
+    };
+
+    constexpr uint32_t BC6H_BLOCK_BYTES = 16;           // Every 4x4 block is encoded as 128 bits
+
+    // Bytes of a single encoded 2D slice, dimensions are padded to multiples of 4.
+    uint64_t bc6h_encoded_size(uint32_t dim_x, uint32_t dim_y);
+
+    // Encodes 16 texels given as planar RGB floats (rgb[c * 16 + y * 4 + x]) into a single block.
+    void bc6h_encode_block(const float* rgb, const BC6HOptions& options, uint8_t* block);
+
+    // Encodes an interleaved 2D slice of 1 to 4 channels with 16 (half) or 32 (float) bits per channel.
+    // Missing channels are treated as 0, a 4th channel is ignored. Edge blocks repeat the border texels.
+    bool bc6h_encode_slice(const uint8_t* data_ptr, uint32_t dim_x, uint32_t dim_y, uint8_t channels, uint8_t bits, const BC6HOptions& options, uint8_t* output);
+
+    // Decodes a single block into 16 interleaved RGB half floats (rgb[(y * 4 + x) * 3 + c]).
+    void bc6h_decode_block(const uint8_t* block, bool is_signed, uint16_t* rgb);
+
+    // Decodes a 2D slice into interleaved texels of 1 to 4 channels with 16 (half) or 32 (float) bits per channel.
+    // Channels beyond RGB are dropped, a 4th channel is set to 1.
+    bool bc6h_decode_slice(const uint8_t* blocks, uint32_t dim_x, uint32_t dim_y, bool is_signed, uint8_t channels, uint8_t bits, uint8_t* output);
+
+    // Decodes consecutive slices like bc6h_decode_slice, block rows are spread over threads (0 uses all hardware threads).
+    bool bc6h_decode_volume(const uint8_t* blocks, uint32_t dim_x, uint32_t dim_y, uint64_t slices, bool is_signed, uint8_t channels, uint8_t bits, uint8_t* output, uint32_t threads);
+}
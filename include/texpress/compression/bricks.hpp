@@ -0,0 +1,41 @@
+#pragma once
+
+#include <texpress/compression/compressor.hpp>
+#include <glm/vec3.hpp>
+#include <vector>
+
+namespace texpress
+{
+    // Volume tiled into 3D bricks, each compressed as a short stack of BC6H slices.
+    // Spatially local queries (trilinear sampling, particle tracing) touch a few contiguous bricks instead of every slice.
+    struct  BrickedVolume {
+        glm::ivec4 dimensions = glm::ivec4(0);              // extents of the whole volume
+        glm::ivec3 brick_size = glm::ivec3(32);             // extents of a full brick, bricks at the upper borders are cropped
+        glm::ivec4 bricks = glm::ivec4(0);                  // bricks along x, y, z and number of time steps
+        uint8_t channels = 0;                               // channels of the uncompressed volume
+        gl::GLenum gl_internal = gl::GLenum::GL_NONE;       // encoding of every brick
+        std::vector<uint64_t> directory;                    // byte offset of each brick in data (t, z, y, x order, x fastest) and the total size
+        std::vector<uint8_t> data;
+
+        uint64_t brick_count() const;
+        uint64_t brick_bytes(uint64_t id) const;
+        // Brick containing voxel (x, y, z, t)
+        uint64_t brick_id(const glm::ivec4& voxel) const;
+        // First voxel (x, y, z, t) of a brick
+        glm::ivec4 brick_origin(uint64_t id) const;
+        // Extents of a brick, smaller than brick_size at the upper borders
+        glm::ivec3 brick_extent(uint64_t id) const;
+    };
+
+    // Compresses an uncompressed volume (BC6H only) brick by brick. Bricks are spread over settings.threads workers sharing one Encoder, each brick is encoded single threaded.
+    // Fused normalization peaks (settings.normalize_peaks) describe the whole volume, each brick is normalized with those of its own slices.
+    bool compress_bricked(const EncoderSettings& settings, const EncoderData& input, BrickedVolume& output, const glm::ivec3& brick_size = glm::ivec3(32));
+
+    // Decodes a single brick into interleaved 32 bit floats, blocks defaults to the brick inside volume.data.
+    bool decompress_brick(const BrickedVolume& volume, uint64_t id, Texture& output, uint8_t channels = 3, const uint8_t* blocks = nullptr);
+
+    // File layout: header, brick directory, brick data. Single bricks can be read without loading the rest.
+    bool save_bricked(const char* path, const BrickedVolume& volume);
+    bool load_bricked(const char* path, BrickedVolume& volume, bool load_data = true);
+    bool read_brick(const char* path, const BrickedVolume& volume, uint64_t id, std::vector<uint8_t>& blocks);
+}
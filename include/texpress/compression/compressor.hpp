@@ -6,13 +6,22 @@
 #include <texpress/core/system.hpp>
 #include <texpress/events/event.hpp>
 #include <texpress/types/texture.hpp>
+#include <texpress/types/texture_view.hpp>
 #include <texpress/types/image.hpp>
+#include <texpress/io/output_sink.hpp>
+#include <texpress/utility/normalizer.hpp>
 
 #include <nvtt/nvtt.h>
 #include <atomic>
+#include <functional>
 
 namespace texpress
 {
+    enum EncoderBackend {
+        BACKEND_NVTT = 0,   // NVIDIA Texture Tools, uses CUDA if available
+        BACKEND_NATIVE      // Built-in CPU encoder, see bc6h.hpp
+    };
+
     struct  EncoderData {
         uint32_t gl_internal = 0;       // OpenGL internalformat, https://registry.khronos.org/OpenGL-Refpages/gl4/html/glTexImage2D.xhtml
         uint32_t gl_format = 0;         // OpenGL format, https://registry.khronos.org/OpenGL-Refpages/gl4/html/glTexImage2D.xhtml
@@ -34,12 +43,32 @@ namespace texpress
         nvtt::Quality quality = nvtt::Quality::Quality_Fastest;   // Encoding quality, for BC6H only "Fastest" and "Normal" are available
         nvtt::Format encoding = nvtt::Format::Format_BC6S;        // Target encoding
         int* progress_ptr = nullptr;                            // Use this if you want to display compression progress else than in console
+        uint32_t threads = 1;                                     // Worker threads compressing (t, z) slices in parallel, 0 uses all hardware threads
+        EncoderBackend backend = EncoderBackend::BACKEND_NVTT;    // Encoder implementation, the native backend supports all four qualities
+        std::vector<float> normalize_peaks;                       // If set, 32 bit float input is normalized slice by slice right before encoding, peaks as returned by find_peaks_parallel
+        NormalizeMode normalize_mode = NormalizeMode::NORMALIZE_SLICE;  // Peaks used for each slice, NORMALIZE_VOLUME reduces normalize_peaks first
+        std::function<void(uint64_t, uint64_t)> progress_callback;  // Called with (encoded bytes done, total) after every slice, from the worker threads one at a time
+        const std::atomic<bool>* cancel_ptr = nullptr;            // Checked between slices, compress stops and returns false once it is true
+    };
+
+    struct  DecompressSettings {
+        uint32_t t_offset = 0;                                    // First time step to decode
+        uint32_t t_count = 0;                                     // Time steps to decode, 0 decodes to the last one
+        uint32_t z_offset = 0;                                    // First z slice of every time step
+        uint32_t z_count = 0;                                     // z slices per time step, 0 decodes to the last one
+        std::vector<float> denormalize_peaks;                     // If set, every slice is denormalized right after decoding, peaks of the whole encoded volume as returned by find_peaks_parallel
+        NormalizeMode denormalize_mode = NormalizeMode::NORMALIZE_SLICE;  // Peaks used for each slice, NORMALIZE_VOLUME reduces denormalize_peaks first
+        uint32_t threads = 0;                                     // Worker threads decoding (t, z) slices in parallel, 0 uses all hardware threads
     };
 
+    // Encoder holds no state besides its default settings, which never change after construction.
+    // All compress and decompress calls are reentrant and may run concurrently on one instance,
+    // except decompress_gpu which needs the calling thread's OpenGL context and is serialized.
     class  Encoder : public system
     {
     public:
         Encoder() = default;
+        explicit Encoder(const EncoderSettings& settings) : defaults(settings) {}
         Encoder(const Encoder& that) = delete;
         Encoder(Encoder&& temp) = delete;
         ~Encoder() = default;
@@ -49,10 +78,11 @@ namespace texpress
         void listener(const Event& e);
 
     public:
-        static uint64_t decoded_size(const EncoderData& input, bool hdr = true);
+        static uint64_t decoded_size(const EncoderData& input, bool hdr = true, bool half = false);
         static uint64_t encoded_size(const EncoderSettings& settings, const EncoderData& input);
         static bool populate_EncoderData(EncoderData& enc_data, Texture& tex_input);
         static bool populate_EncoderData(EncoderData& enc_data, image& img_input);
+        static bool populate_EncoderData(EncoderData& enc_data, const TextureView& view_input);   // Input only, data is never written
         static bool populate_Texture(Texture& tex, EncoderData& enc_data);
         static bool populate_Image(image& img, EncoderData& enc_data);
 
@@ -80,20 +110,32 @@ namespace texpress
             delete buffer;
         }
 
-        bool compress(const EncoderSettings& settings, const EncoderData& input, EncoderData& output);
-        bool decompress(const EncoderData& input, EncoderData& output);
-        bool decompress(const EncoderData& input, EncoderData& output, uint64_t slice);
-        bool decompress(const nvtt::Format encoding, const EncoderData& input, EncoderData& output);
-        bool decompress(const nvtt::Format encoding, const EncoderData& input, EncoderData& output, uint64_t slice);
-        bool decompress_gpu(const nvtt::Format encoding, const EncoderData& input, EncoderData& output);
+        const EncoderSettings& default_settings() const { return defaults; }
+
+        // Compresses with the settings given at construction; progress_ptr of those is shared by all concurrent calls
+        bool compress(const EncoderData& input, EncoderData& output) const { return compress(defaults, input, output); }
+        bool compress(const EncoderSettings& settings, const EncoderData& input, EncoderData& output) const;
+        // Slices are encoded straight into sink at their offsets (slice * encoded slice size), output only receives the metadata
+        bool compress(const EncoderSettings& settings, const EncoderData& input, EncoderData& output, OutputSink& sink) const;
+        // Decoded texels are floats, or halves if output.gl_internal is set to a 16 bit float format (e.g. gl_internal(channels, 16, true)) beforehand
+        bool decompress(const EncoderData& input, EncoderData& output) const;
+        // Appends one (t, z) slice at output.data_ptr and advances it, use one output per thread to decode slices in parallel
+        bool decompress(const EncoderData& input, EncoderData& output, uint64_t slice) const;
+        bool decompress(const nvtt::Format encoding, const EncoderData& input, EncoderData& output) const;
+        bool decompress(const nvtt::Format encoding, const EncoderData& input, EncoderData& output, uint64_t slice) const;
+        // Decodes the (t, z) range of settings in parallel, every slice goes to its own offset in output, which holds
+        // t_count * z_count slices afterwards. Halves or floats like decompress, output.data_bytes must fit the range.
+        bool decompress_volume(const DecompressSettings& settings, const EncoderData& input, EncoderData& output) const;
+        bool decompress_gpu(const nvtt::Format encoding, const EncoderData& input, EncoderData& output) const;
 
         //static Texture<uint8_t> compress_bc6h_nvtt(const Texture<float>& input);
         //static Texture<float> decompress_bc6h_nvtt(const Texture<uint8_t>& input);
 
     private:
+        static uint8_t decoded_bits(const EncoderData& output);
         static bool populate_EncoderData_base(EncoderData& enc_data, uint32_t dim_x, uint32_t dim_y, uint32_t dim_z, uint32_t dim_t, uint8_t channels, uint64_t data_bytes, uint8_t* data_ptr);
 
     private:
-        std::atomic<bool> busy = false;
+        const EncoderSettings defaults;
     };
 }
\ No newline at end of file
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <texpress/compression/compressor.hpp>
+#include <texpress/compression/bricks.hpp>
+#include <texpress/io/hdf_io.hpp>
+#include <texpress/utility/error_metrics.hpp>
+#include <texpress/utility/normalizer.hpp>
+#include <string>
+#include <vector>
+
+namespace texpress
+{
+    enum PipelineNormalize {
+        PIPELINE_NORMALIZE_NONE = 0,
+        PIPELINE_NORMALIZE_SLICE,       // see NormalizeMode
+        PIPELINE_NORMALIZE_VOLUME
+    };
+
+    // A single load -> normalize -> compress -> decompress -> error metrics -> save run, needs no window or OpenGL context.
+    struct  PipelineSettings {
+        std::string input_path;                                 // .raw (dimension header or "_dims" sidecar), .h5/.hdf5, .ktx (compressed KTX skips compression) or abc[:extent], see parse_abc
+        std::vector<std::string> datasets;                      // HDF5 component datasets, e.g. { "/u", "/v", "/w" }
+        HDF5Region region;                                      // HDF5 region of interest
+        bool half = false;                                      // Load and decode as 16 bit halves
+        PipelineNormalize normalize = PipelineNormalize::PIPELINE_NORMALIZE_NONE;
+        bool fused = true;                                      // Normalize slice by slice while compressing instead of into a normalized copy
+        EncoderSettings encoder;
+        bool decompress = false;                                // Decode the compressed data again
+        bool denormalize = true;                                // Map decoded data back to the range of the source
+        bool error = false;                                     // Error metrics of the decoded data against the source, implies decompress
+        std::string output_path;                                // Compressed data, .ktx or .raw, peaks are stored next to it as .peaks
+        std::string bricked_path;                               // Compressed data in the bricked layout, see save_bricked
+        glm::ivec3 brick_size = glm::ivec3(32);                 // Extents of the bricks of bricked_path
+        std::string decoded_path;                               // Decoded data, .ktx or .raw
+        std::string error_path;                                 // Per texel component error, .raw
+    };
+
+    struct  PipelineStats {
+        bool success = false;
+        uint64_t bytes_source = 0;
+        uint64_t bytes_compressed = 0;
+        double seconds_load = 0.0;
+        double seconds_normalize = 0.0;
+        double seconds_compress = 0.0;
+        double seconds_decompress = 0.0;
+        double seconds_error = 0.0;
+        double seconds_save = 0.0;
+        ErrorStats error;                                       // Valid if settings.error is set
+    };
+
+    // Runs all stages requested in settings.
+    bool run_pipeline(const PipelineSettings& settings, PipelineStats* stats = nullptr);
+
+    // Parses command line flags (without the program name) into settings, see pipeline_usage for the flags.
+    bool parse_pipeline_args(const std::vector<std::string>& args, PipelineSettings& settings);
+
+    // Reads a job file: one job per line given as command line flags, empty lines and lines starting with # are skipped.
+    // Arguments may be quoted with "" to contain spaces.
+    bool read_job_file(const char* path, std::vector<std::vector<std::string>>& jobs);
+
+    // Splits a line into arguments, see read_job_file.
+    std::vector<std::string> split_args(const std::string& line);
+
+    // Description of all flags understood by parse_pipeline_args.
+    const char* pipeline_usage();
+}
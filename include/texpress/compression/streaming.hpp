@@ -0,0 +1,46 @@
+#pragma once
+
+#include <texpress/compression/compressor.hpp>
+#include <texpress/io/hdf_io.hpp>
+#include <texpress/utility/synthetic.hpp>
+#include <string>
+#include <vector>
+
+namespace texpress
+{
+    enum StreamFormat {
+        STREAM_RAW = 0,     // Interleaved floats, dimensions as xyzw integers in a leading header or a "_dims" sidecar
+        STREAM_HDF5,        // One dataset per component in (t, z, y, x) order, input only
+        STREAM_KTX,         // KTX1 holding BC6H blocks, output only
+        STREAM_ABC          // Synthetic ABC flow generated slab by slab, input only
+    };
+
+    struct  StreamSettings {
+        StreamFormat input_format = StreamFormat::STREAM_RAW;
+        std::string input_path;
+        std::vector<std::string> datasets;                      // HDF5 component datasets, e.g. { "/u", "/v", "/w" }
+        HDF5Region region;                                      // HDF5 region of interest, e.g. a range of time steps
+        ABCSettings abc;                                        // Extent and parameters of a STREAM_ABC input
+        StreamFormat output_format = StreamFormat::STREAM_KTX;
+        std::string output_path;
+        bool monolithic = false;                                // KTX: single file instead of one file per time step, limited to 4GB
+        uint32_t slab_slices = 0;                               // z slices read and compressed at once, 0 uses whole time steps
+        uint32_t queue_size = 2;                                // Slabs buffered between reader and compressor, bounds the peak memory
+        bool mapped_output = true;                              // Encode into a shared mapping of the output file, else each slice is written at its offset
+        EncoderSettings encoder;                                // Used for every slab, progress_ptr is ignored
+        int* progress_ptr = nullptr;                            // Percentage of written slices, console output if null
+    };
+
+    struct  StreamStats {
+        uint64_t slabs = 0;
+        uint64_t bytes_read = 0;
+        uint64_t bytes_written = 0;
+        double seconds = 0.0;
+    };
+
+    // Compresses a dataset too large for memory slab by slab. A reader and a compressor thread are connected by a
+    // bounded queue, so at most about queue_size + 2 slabs are resident at any time. Encoded blocks are never buffered,
+    // the encoder writes them straight to their offset in the output file through an output sink.
+    // Slabs never span time steps, the encoded output is identical to compressing the whole volume at once.
+    bool stream_compress(const StreamSettings& settings, StreamStats* stats = nullptr);
+}
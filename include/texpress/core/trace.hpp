@@ -0,0 +1,92 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace texpress
+{
+    enum  TraceEventType {
+        TRACE_SCOPE = 0,        // Time span of a TraceScope
+        TRACE_COUNTER           // Value of a trace_counter at a point in time
+    };
+
+    struct  TraceEvent {
+        const char* name = nullptr;                     // Static string, stage names nest with '/' (e.g. "compress/slice")
+        TraceEventType type = TraceEventType::TRACE_SCOPE;
+        uint64_t begin_ns = 0;                          // Wallclock nanoseconds
+        uint64_t end_ns = 0;
+        uint64_t bytes = 0;                             // Bytes processed within the scope
+        double value = 0.0;                             // Counter value
+        uint32_t thread = 0;                            // Index of the recording thread, in order of their first event
+    };
+
+    // Aggregate of all scopes with the same name
+    struct  TraceStage {
+        std::string name;
+        uint64_t calls = 0;
+        uint64_t bytes = 0;
+        double seconds = 0.0;                           // Sum of all scopes, exceeds the wall time if they ran in parallel
+        double seconds_wall = 0.0;                      // Time at least one of the scopes was running
+        double mb_per_second = 0.0;                     // bytes / seconds_wall
+    };
+
+    namespace detail {
+        inline std::atomic<bool> trace_active = false;
+    }
+
+    // Tracing is off by default, a disabled TraceScope costs a single relaxed load.
+    // Defining TEXPRESS_DISABLE_TRACE removes all scopes at compile time.
+    inline bool trace_enabled() {
+#if defined(TEXPRESS_DISABLE_TRACE)
+        return false;
+#else
+        return detail::trace_active.load(std::memory_order_relaxed);
+#endif
+    }
+
+    // Enabling starts a new trace, events recorded so far are dropped
+    void trace_enable(bool enable = true);
+    void trace_clear();
+    uint64_t trace_now();
+
+    // Every thread records into its own buffer, only the first event of a thread takes a lock on the shared registry.
+    void trace_record(const char* name, uint64_t begin_ns, uint64_t end_ns, uint64_t bytes);
+    void trace_counter(const char* name, double value);
+
+    // Events of all threads ordered by begin, may be called while threads are still recording
+    std::vector<TraceEvent> trace_events();
+    std::vector<TraceStage> trace_summary();
+    std::string trace_summary_table(const std::vector<TraceStage>& stages);
+
+    // Chrome trace event format, opens in chrome://tracing or ui.perfetto.dev
+    bool save_trace(const char* path);
+
+    // Records the time from construction to destruction as one event of name, which has to outlive the trace (e.g. a string literal)
+    class  TraceScope
+    {
+    public:
+        explicit TraceScope(const char* name, uint64_t bytes = 0)
+            : name(name)
+            , bytes(bytes)
+            , begin_ns((trace_enabled()) ? trace_now() : 0)
+        {}
+        TraceScope(const TraceScope& that) = delete;
+        TraceScope(TraceScope&& temp) = delete;
+        ~TraceScope() {
+            if (begin_ns)
+                trace_record(name, begin_ns, trace_now(), bytes);
+        }
+        TraceScope& operator=(const TraceScope& that) = delete;
+        TraceScope& operator=(TraceScope&& temp) = delete;
+
+        // For sizes only known at the end of the scope
+        void set_bytes(uint64_t bytes) { this->bytes = bytes; }
+
+    private:
+        const char* name;
+        uint64_t bytes;
+        uint64_t begin_ns;
+    };
+}
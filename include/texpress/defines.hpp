@@ -1,4 +1,11 @@
 #pragma once
 
 #define TEXPRESS_ENABLE
+// Headless tools have no GLFW, their clock is std::chrono
+#if !defined(TEXPRESS_HEADLESS)
 #define TEXPRESS_GLFW_CLOCK
+#endif
+// F16C half conversions, MSVC has no __F16C__ but every AVX2 target supports them
+#if defined(__F16C__) || (defined(_MSC_VER) && defined(__AVX2__))
+#define TEXPRESS_F16C
+#endif
@@ -0,0 +1,113 @@
+#pragma once
+
+#include <texpress/graphics/thumbnail_pyramid.hpp>
+#include <texpress/types/texture_view.hpp>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#if !defined(TEXPRESS_HEADLESS)
+namespace globjects {
+    class Texture;
+}
+#endif
+
+namespace texpress
+{
+    // One resident (t, z) slice of a texture.
+    struct  PreviewSlice {
+#if !defined(TEXPRESS_HEADLESS)
+        std::unique_ptr<globjects::Texture> texture;    // Slice uploaded as is, compressed or not, or a thumbnail level as RGBA8
+#endif
+        std::vector<uint8_t> rgba;                      // Headless: thumbnail level as RGBA8
+        glm::ivec2 size = glm::ivec2(0);                // Extents of texture or rgba
+        uint64_t bytes = 0;                             // Memory held by the slice, counted against the budget
+
+        PreviewSlice();
+        ~PreviewSlice();
+        PreviewSlice(PreviewSlice&& temp);
+        PreviewSlice& operator=(PreviewSlice&& temp);
+
+        // GL name for ImGui::Image, 0 in headless builds
+        uint32_t id() const;
+    };
+
+    // Keeps recently viewed slices resident so the preview panels only upload when the slice or the data changes.
+    // Slices are kept per owning Texture, least recently used ones are dropped once budget_bytes are exceeded.
+    // Every owner also gets a ThumbnailPyramid on the CPU for scrubbing, it is not counted against the budget.
+    // Changes of the data pointer, size, dimensions or format of a view are detected, data rewritten in place
+    // (e.g. decoding into the same buffer again) has to be announced with invalidate.
+    class  PreviewCache {
+    public:
+        explicit PreviewCache(uint64_t budget_bytes = 256ull << 20, const ThumbnailSettings& thumbnail_settings = ThumbnailSettings());
+        PreviewCache(const PreviewCache& that) = delete;
+        PreviewCache(PreviewCache&& temp) = delete;
+        ~PreviewCache();
+        PreviewCache& operator=(const PreviewCache& that) = delete;
+        PreviewCache& operator=(PreviewCache&& temp) = delete;
+
+        // Slice of view, which shows the data of owner. Uploaded on a miss, nullptr if the slice is out of range.
+        // Headless builds have nothing to upload to and return level 0 of the thumbnail instead.
+        const PreviewSlice* get(const Texture* owner, const TextureView& view, uint64_t slice);
+        // Smallest thumbnail level of the slice covering size pixels, reduced from the full resolution on first access
+        const PreviewSlice* thumbnail(const Texture* owner, const TextureView& view, uint64_t slice, uint32_t size);
+        // Reduces all slices of view to thumbnails in parallel, e.g. right after loading
+        bool build_thumbnails(const Texture* owner, const TextureView& view);
+
+        // Drops all slices of owner, or of every texture if owner is nullptr
+        void invalidate(const Texture* owner = nullptr);
+
+        void set_budget(uint64_t budget_bytes);
+        uint64_t budget() const { return budget_bytes; }
+        uint64_t resident_bytes() const { return bytes; }
+        uint64_t resident_slices() const { return lru.size(); }
+        uint64_t hits() const { return count_hits; }
+        uint64_t uploads() const { return count_uploads; }
+
+    private:
+        struct Key {
+            const Texture* owner;
+            uint64_t slice;
+            uint32_t level;                 // 0 is the full resolution, 1 + i thumbnail level i
+
+            bool operator==(const Key& other) const { return owner == other.owner && slice == other.slice && level == other.level; }
+        };
+
+        struct KeyHash {
+            size_t operator()(const Key& key) const { return std::hash<const void*>()(key.owner) ^ (std::hash<uint64_t>()((key.slice << 5) | key.level) * 0x9E3779B97F4A7C15ull); }
+        };
+
+        // What a view looked like when its slices were cached
+        struct Fingerprint {
+            const uint8_t* data = nullptr;
+            uint64_t data_bytes = 0;
+            glm::ivec4 dimensions = glm::ivec4(0);
+            uint8_t channels = 0;
+            gl::GLenum gl_internal = gl::GLenum::GL_NONE;
+            gl::GLenum gl_type = gl::GLenum::GL_NONE;
+
+            bool operator==(const Fingerprint& other) const;
+        };
+
+        typedef std::list<std::pair<Key, PreviewSlice>> LruList;   // Most recently used first
+
+        // Drops the slices of owner if view changed, returns its pyramid
+        ThumbnailPyramid& track(const Texture* owner, const TextureView& view);
+        const PreviewSlice* fetch(const Texture* owner, const TextureView& view, uint64_t slice, uint32_t level);
+        bool load(const TextureView& view, uint64_t slice, uint32_t level, ThumbnailPyramid& pyramid, PreviewSlice& output) const;
+        void evict(uint64_t keep_bytes);
+
+        uint64_t budget_bytes;
+        ThumbnailSettings thumbnail_settings;
+        uint64_t bytes = 0;
+        uint64_t count_hits = 0;
+        uint64_t count_uploads = 0;
+
+        LruList lru;
+        std::unordered_map<Key, LruList::iterator, KeyHash> slices;
+        std::unordered_map<const Texture*, Fingerprint> fingerprints;
+        std::unordered_map<const Texture*, ThumbnailPyramid> pyramids;
+    };
+}
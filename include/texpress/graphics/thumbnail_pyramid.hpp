@@ -0,0 +1,64 @@
+#pragma once
+
+#include <texpress/types/texture_view.hpp>
+#include <glm/vec2.hpp>
+#include <cstdint>
+#include <vector>
+
+namespace texpress
+{
+    enum  ThumbnailMode {
+        THUMBNAIL_RGB = 0,          // Channels as color, a 4th channel as alpha
+        THUMBNAIL_MAGNITUDE         // Length of the vector of all channels as gray
+    };
+
+    struct  ThumbnailSettings {
+        uint32_t size = 128;                            // Longest side of level 0, slices that are smaller keep their size
+        uint32_t min_size = 8;                          // Levels are halved until their longest side would drop below it
+        ThumbnailMode mode = ThumbnailMode::THUMBNAIL_RGB;
+        float range_min = 0.0f;                         // Values mapped to 0 and 255, every slice (and channel) is
+        float range_max = 0.0f;                         // scaled by its own range if they are equal
+        uint32_t threads = 0;                           // Slices reduced in parallel by build, 0 uses all hardware threads
+    };
+
+    struct  ThumbnailLevel {
+        glm::ivec2 size = glm::ivec2(0);
+        std::vector<uint8_t> rgba;                      // size.x * size.y RGBA8 texels
+    };
+
+    // Reduces slice of view to RGBA8 levels, level 0 is box filtered from the full resolution and every further level halves the previous one.
+    // BC6H slices are decoded block by block, so no full resolution copy of the slice is ever held.
+    bool build_thumbnail(const TextureView& view, uint64_t slice, const ThumbnailSettings& settings, std::vector<ThumbnailLevel>& levels);
+
+    // Reduced previews of every (t, z) slice of a view, e.g. for scrubbing through thousands of slices without touching the full data.
+    // Slices are reduced in parallel by build or one by one on first access. Not thread safe, the view has to outlive the pyramid or the next reset.
+    class  ThumbnailPyramid {
+    public:
+        ThumbnailPyramid() = default;
+
+        // Binds view and drops all thumbnails
+        void reset(const TextureView& view, const ThumbnailSettings& settings = ThumbnailSettings());
+        void clear();
+
+        // Reduces all slices not reduced yet
+        bool build();
+
+        // Level of the given slice, reduced now if it is missing. nullptr if it is out of range or could not be reduced.
+        const ThumbnailLevel* get(uint64_t slice, uint32_t level = 0);
+        // Smallest level whose longest side still covers size pixels
+        uint32_t level(uint32_t size) const;
+        uint32_t levels() const;
+
+        bool built(uint64_t slice) const { return slice < thumbnails.size() && !thumbnails[slice].empty(); }
+        uint64_t slices() const { return thumbnails.size(); }
+        uint64_t bytes() const { return bytes_total; }
+        const TextureView& view() const { return source; }
+        const ThumbnailSettings& settings() const { return options; }
+
+    private:
+        TextureView source;
+        ThumbnailSettings options;
+        std::vector<std::vector<ThumbnailLevel>> thumbnails;    // Levels per slice, empty until reduced
+        uint64_t bytes_total = 0;
+    };
+}
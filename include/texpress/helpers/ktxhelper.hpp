@@ -9,6 +9,10 @@ namespace texpress {
     bool save_ktx(const uint8_t* data_ptr, const char* path, const glm::ivec4& dimensions, gl::GLenum gl_internal_format, uint64_t size, bool as_texture_array = false, bool save_monolithic = false);
     bool save_ktx2(const uint8_t* data_ptr, const char* path, const glm::ivec4& dimensions, gl::GLenum gl_internal_format, uint64_t size, bool as_texture_array = false, bool save_monolithic = false);
     bool save_ktx2(const uint8_t* data_ptr, const char* path, const glm::ivec4& dimensions, VkFormat vk_format, uint32_t channels, uint32_t type_size, uint64_t size, bool as_texture_array = false, bool save_monolithic = false);
+    // Header, key/value data and image size of a KTX1 file holding a single compressed 3D level of the given depth.
+    // Appending image_bytes of block data afterwards yields a file equivalent to save_ktx, so data can be written incrementally.
+    // Returns an empty header if image_bytes exceeds the 32 bit imageSize field.
+    std::vector<uint8_t> ktx_header(const glm::ivec4& dimensions, gl::GLenum gl_internal_format, uint32_t depth, uint64_t image_bytes);
     void load_ktx(const char* path, uint8_t* data_ptr, uint8_t& channels, glm::ivec4& dimensions, gl::GLenum& gl_internal_format, gl::GLenum& gl_format, gl::GLenum& gl_type);
 
     bool save_ktx(const Texture& input, const char* path, bool as_texture_array = false, bool save_monolithic = false);
@@ -0,0 +1,62 @@
+#pragma once
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+
+namespace texpress {
+    // Blocking FIFO of limited capacity connecting producer and consumer threads.
+    // Producers wait while the queue is full, consumers wait while it is empty.
+    // After close() pushing fails and popping fails once the remaining items are consumed.
+    template <typename T>
+    class BoundedQueue {
+    public:
+        BoundedQueue(std::size_t capacity) :
+            capacity(std::max<std::size_t>(capacity, 1))
+            , closed(false)
+        {}
+
+        BoundedQueue(const BoundedQueue& that) = delete;
+        BoundedQueue& operator=(const BoundedQueue& that) = delete;
+
+        bool push(T&& item) {
+            std::unique_lock<std::mutex> lock(mutex);
+            not_full.wait(lock, [this]() { return closed || items.size() < capacity; });
+
+            if (closed)
+                return false;
+
+            items.push_back(std::move(item));
+            not_empty.notify_one();
+            return true;
+        }
+
+        bool pop(T& item) {
+            std::unique_lock<std::mutex> lock(mutex);
+            not_empty.wait(lock, [this]() { return closed || !items.empty(); });
+
+            if (items.empty())
+                return false;
+
+            item = std::move(items.front());
+            items.pop_front();
+            not_full.notify_one();
+            return true;
+        }
+
+        void close() {
+            std::lock_guard<std::mutex> lock(mutex);
+            closed = true;
+            not_full.notify_all();
+            not_empty.notify_all();
+        }
+
+    private:
+        std::size_t capacity;
+        bool closed;
+        std::deque<T> items;
+        std::mutex mutex;
+        std::condition_variable not_full;
+        std::condition_variable not_empty;
+    };
+}
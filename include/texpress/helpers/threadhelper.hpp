@@ -0,0 +1,44 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+namespace texpress {
+    // The requested thread count, 0 uses all hardware threads.
+    inline uint32_t thread_count(uint32_t requested) {
+        return (requested) ? requested : std::max(std::thread::hardware_concurrency(), 1u);
+    }
+
+    // Threads used for jobs independent items: the requested count, at most one per job and at least one.
+    inline uint32_t worker_count(uint32_t requested, uint64_t jobs) {
+        return (uint32_t)std::max<uint64_t>(std::min<uint64_t>(thread_count(requested), jobs), 1);
+    }
+
+    // Runs worker(w) for every w in [0, workers), worker 0 on the calling thread, and returns once all of them have finished.
+    template <typename F>
+    void run_workers(uint32_t workers, const F& worker) {
+        std::vector<std::thread> pool;
+        for (uint32_t w = 1; w < workers; w++) {
+            pool.push_back(std::thread([&worker, w]() { worker(w); }));
+        }
+        worker(0);
+
+        for (auto& thread : pool) {
+            if (thread.joinable())
+                thread.join();
+        }
+    }
+
+    // Runs job(id) for every id in [0, jobs) on worker_count(threads, jobs) threads, ids are handed out one at a time.
+    template <typename F>
+    void parallel_for(uint64_t jobs, uint32_t threads, const F& job) {
+        std::atomic<uint64_t> next = 0;
+        run_workers(worker_count(threads, jobs), [&](uint32_t) {
+            for (uint64_t id = next++; id < jobs; id = next++) {
+                job(id);
+            }
+        });
+    }
+}
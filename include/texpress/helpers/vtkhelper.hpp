@@ -1,6 +1,7 @@
 #pragma once
 #include <fstream>
 #include <texpress/types/texture.hpp>
+#include <texpress/core/trace.hpp>
 #include <array>
 #include <filesystem>
 
@@ -276,6 +277,7 @@ namespace texpress {
 
 
     bool save_vtk(const char* path, const char* vtk_title, const Texture& tex, int sx = 1, int sy = 1, int sz = 1, bool binary = true) {
+        TraceScope trace("save/vtk", tex.bytes());
         vtk_points points;
         points.nx = tex.dimensions.x;
         points.ny = tex.dimensions.y;
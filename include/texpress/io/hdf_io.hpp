@@ -4,8 +4,16 @@
 #include <highfive/H5DataSet.hpp>
 #include <highfive/H5DataSpace.hpp>
 #include <glm/glm.hpp>
+#include <spdlog/spdlog.h>
 
+#include <texpress/core/trace.hpp>
+#include <texpress/helpers/threadhelper.hpp>
 #include <texpress/io/file_io.hpp>
+#include <texpress/utility/half.hpp>
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <type_traits>
 
 
 
@@ -46,6 +54,14 @@ namespace texpress
         bool parse(HighFive::File& file, std::string internal_path);
     };
 
+    // Region of interest in grid axis order x, y, z, t.
+    struct  HDF5Region {
+        uint64_t offset[4] = { 0, 0, 0, 0 };        // First element read along each axis
+        uint64_t count[4] = { 0, 0, 0, 0 };         // Elements read along each axis after striding, 0 reads up to the end
+        uint64_t stride[4] = { 1, 1, 1, 1 };
+        int axes[4] = { -1, -1, -1, -1 };           // HDF5 dimension of each axis, -1 assumes the descending (t, z, y, x) layout
+    };
+
     class hdf5 {
     public:
         hdf5(const char* path, bool write = false);
@@ -55,6 +71,9 @@ namespace texpress
         hdf5& operator=(const hdf5& that) = delete;
         hdf5& operator=(hdf5&& temp) = delete;
 
+        // False if the file could not be opened, every read then fails. Library errors are logged and reported as failures, never thrown.
+        bool is_open() const { return file != nullptr; }
+
         /* =========================================================================*/
         /*                             Getter / Setter
         /* =========================================================================*/
@@ -70,62 +89,154 @@ namespace texpress
         /* =========================================================================*/
         /*                             I/O
         /* =========================================================================*/
+        // Reads the component datasets into an interleaved buffer. Offsets and strides are given per grid axis in x, y, z, t order,
+        // xyzt_hdf_indices maps each grid axis to its HDF5 dimension (empty: descending (t, z, y, x) layout).
         template <typename T>
         bool read_datasets(std::vector<const char*> paths, std::vector<uint64_t> offsets, std::vector<uint64_t> strides, std::vector<int> xyzt_hdf_indices, std::vector<uint8_t>& input) {
-            auto dataset = file->getDataSet(paths[0]);
-            auto dimensions = get_grid_fixsize(paths[0]);
-            auto element_space = paths.size();
-            std::vector<uint64_t> elements;
-            uint64_t elements_flat = 0;
-            dataset.getStorageSize();
-
-            // Missing offsets / strides are assumed as regular read operation
-            for (int i = 0; i < element_space; i++) {
-                if (offsets.size() < dimensions.size())
-                    offsets.push_back(0);
-                if (strides.size() < dimensions.size())
-                    strides.push_back(1);
+            HDF5Region region;
+            for (int d = 0; d < 4; d++) {
+                region.offset[d] = (d < offsets.size()) ? offsets[d] : 0;
+                region.stride[d] = (d < strides.size()) ? strides[d] : 1;
+                region.axes[d] = (d < xyzt_hdf_indices.size()) ? xyzt_hdf_indices[d] : -1;
             }
 
-            // Count elements to initialize buffer
-            for (int i = 0; i < element_space; i++) {
-                dataset = file->getDataSet(paths[i]);
-                elements.push_back((dataset.getElementCount() - offsets[i]) / strides[i]);
-                elements_flat += elements.back();
+            return read_region<T>(std::vector<std::string>(paths.begin(), paths.end()), region, input);
+        }
+
+        // Reads a region of interest of every component dataset and interleaves it into input, see read_region(paths, region, data_ptr).
+        template <typename T>
+        bool read_region(const std::vector<std::string>& paths, const HDF5Region& region, std::vector<uint8_t>& input, uint32_t threads = 0, bool half = false) {
+            auto extent = region_dimensions(paths[0].c_str(), region);
+            if (extent.empty())
+                return false;
+
+            input.resize(extent[0] * extent[1] * extent[2] * extent[3] * paths.size() * ((half) ? sizeof(uint16_t) : sizeof(T)));
+            return read_region<T>(paths, region, input.data(), threads, half);
+        }
+
+        // Reads a region of interest of component datasets of identical shape and interleaves it into data_ptr.
+        // The region is pushed down to a hyperslab selection, nothing outside of it is read from disk.
+        // The selection is split into blocks along the outermost HDF5 dimension selecting more than one element, so a single
+        // time step of a (t, z, y, x) dataset is still read in bounded blocks of z slices, aligned to the chunk layout if there is one.
+        // Workers read the components of a block and interleave it while it is still in cache. Library calls are
+        // serialized, so the reads of one worker overlap with the interleaving of the others (0 uses all hardware threads).
+        // With half, float datasets are stored as half floats, each block is converted right after it is interleaved.
+        template <typename T>
+        bool read_region(const std::vector<std::string>& paths, const HDF5Region& region, uint8_t* data_ptr, uint32_t threads = 0, bool half = false) {
+            const uint64_t element_space = paths.size();
+            if (element_space == 0)
+                return false;
+
+            if (half && !std::is_same<T, float>::value) {
+                spdlog::error("Only float datasets can be read as half");
+                return false;
             }
 
-            spdlog::info(elements_flat * sizeof(T));
-            input.resize(elements_flat * sizeof(T));
-            T* input_ptr = (T*)input.data();
-            std::vector<T> slice(*std::max_element(elements.begin(), elements.end()));
-
-            // Fill buffer
-            uint64_t buffer_offset = 0;
-            for (int i = 0; i < element_space; i++) {
-                dataset = file->getDataSet(paths[i]);
-                dimensions = dataset.getDimensions();
-
-                // Selection parameters specific to current dataset
-                std::vector<uint64_t> i_offsets{ offsets[i] };
-                std::vector<uint64_t> i_strides{ strides[i] };
-                std::vector<uint64_t> i_elements{ (dimensions[0] - i_offsets[0]) / i_strides[0] };
-
-                for (int j = 1; j < dimensions.size(); j++) {
-                    i_offsets.push_back(0);
-                    i_strides.push_back(1);
-                    i_elements.push_back((dimensions[j] - i_offsets[j]) / i_strides[j]);
+            if (!file)
+                return false;
+
+            LockedDataSets datasets;
+            std::vector<std::size_t> dimensions;
+            {
+                std::lock_guard<std::mutex> lock(library_mutex);
+                try {
+                    for (const auto& path : paths) {
+                        datasets.handles.push_back(file->getDataSet(path));
+                    }
+
+                    dimensions = datasets.handles[0].getDimensions();
+                    for (const auto& dataset : datasets.handles) {
+                        if (dataset.getDimensions() != dimensions) {
+                            spdlog::error("Datasets of " + paths[0] + " differ in shape");
+                            return false;
+                        }
+                    }
+                }
+                catch (const HighFive::Exception& e) {
+                    spdlog::error("Datasets of " + std::string(filepath) + " could not be opened: " + e.what());
+                    return false;
                 }
+            }
 
-                // Read into temporary buffer
-                dataset.select(i_offsets, i_elements, i_strides).read<T>(slice.data());
+            std::vector<std::size_t> offsets, counts, strides;
+            if (dimensions.empty() || !hyperslab(dimensions, region, offsets, counts, strides))
+                return false;
 
-                // Copy to correct positions in input buffer
-                for (uint64_t k = 0; k < elements[i]; k++) {
-                    input_ptr[i + k * element_space] = std::move(slice[k]);
-                }
+            // Leading dimensions of a single element do not change the memory layout, blocks are rows of the split dimension
+            uint64_t split = 0;
+            while (split + 1 < counts.size() && counts[split] == 1) {
+                split++;
+            }
+
+            uint64_t row_elements = 1;
+            for (uint64_t j = split + 1; j < counts.size(); j++) {
+                row_elements *= counts[j];
             }
 
-            return true;
+            const uint64_t rows = counts[split];
+            const uint64_t rows_block = std::min<uint64_t>(block_rows(paths[0], split, row_elements * sizeof(T), strides[split]), std::max<uint64_t>(rows, 1));
+            const uint64_t blocks = (rows + rows_block - 1) / rows_block;
+            T* dest_base = reinterpret_cast<T*>(data_ptr);
+            TraceScope trace("load/hdf5", rows * row_elements * element_space * sizeof(T));
+
+            std::atomic<uint64_t> next_block = 0;
+            std::atomic<bool> failed = false;
+
+            run_workers(worker_count(threads, blocks), [&](uint32_t) {
+                // Component planes of one block, reused for every block of this worker
+                std::vector<T> block(element_space * rows_block * row_elements);
+                std::vector<T> interleaved((half) ? element_space * rows_block * row_elements : 0);
+
+                for (uint64_t b = next_block++; b < blocks && !failed; b = next_block++) {
+                    const uint64_t row = b * rows_block;
+                    const uint64_t block_elements = std::min(rows_block, rows - row) * row_elements;
+                    TraceScope trace_block("load/hdf5/block", block_elements * element_space * sizeof(T));
+
+                    std::vector<std::size_t> i_offsets = offsets;
+                    std::vector<std::size_t> i_counts = counts;
+                    i_offsets[split] = offsets[split] + row * strides[split];
+                    i_counts[split] = std::min(rows_block, rows - row);
+
+                    for (uint64_t i = 0; i < element_space; i++) {
+                        std::lock_guard<std::mutex> lock(library_mutex);
+                        try {
+                            datasets.handles[i].select(i_offsets, i_counts, strides).read<T>(block.data() + i * block_elements);
+                        }
+                        catch (const HighFive::Exception& e) {
+                            spdlog::error("Reading " + paths[i] + " failed: " + e.what());
+                            failed = true;
+                            return;
+                        }
+                    }
+
+                    T* dest_ptr = (half) ? interleaved.data() : dest_base + row * row_elements * element_space;
+                    for (uint64_t k = 0; k < block_elements; k++) {
+                        for (uint64_t i = 0; i < element_space; i++) {
+                            dest_ptr[k * element_space + i] = block[i * block_elements + k];
+                        }
+                    }
+
+                    if (half) {
+                        uint16_t* half_ptr = reinterpret_cast<uint16_t*>(data_ptr) + row * row_elements * element_space;
+                        convert_to_half(reinterpret_cast<const float*>(interleaved.data()), half_ptr, block_elements * element_space);
+                    }
+                }
+            });
+
+            return !failed;
+        }
+
+        // Reads the (t, z) slices [z, z + slices) of time step t of a region of every component dataset and interleaves them into data_ptr.
+        // t and z count selected steps and slices, i.e. they are relative to the region offset and scaled by its stride.
+        template <typename T>
+        bool read_slab(const std::vector<std::string>& paths, const HDF5Region& region, uint64_t t, uint64_t z, uint64_t slices, uint8_t* data_ptr) {
+            HDF5Region slab = region;
+            slab.offset[2] = region.offset[2] + z * std::max<uint64_t>(region.stride[2], 1);
+            slab.count[2] = slices;
+            slab.offset[3] = region.offset[3] + t * std::max<uint64_t>(region.stride[3], 1);
+            slab.count[3] = 1;
+
+            return read_region<T>(paths, slab, data_ptr, 1);
         }
 
         /*
@@ -167,9 +278,32 @@ namespace texpress
         */
 
         std::vector<uint64_t> dataset_dimensions(const char* dataset);
+        // Returns the extent of a region of interest in x, y, z, t order, empty if the region does not fit the dataset
+        std::vector<uint64_t> region_dimensions(const char* dataset, const HDF5Region& region);
 
     private:
         bool read(HighFive::DataSet dataset, uint64_t offset, uint64_t stride, uint8_t* data_ptr);
+        // Dimensions of a dataset in HDF5 order, empty if it cannot be opened
+        std::vector<std::size_t> shape(const char* dataset);
+        // Translates a region into a hyperslab in HDF5 dimension order
+        bool hyperslab(const std::vector<std::size_t>& dimensions, const HDF5Region& region, std::vector<std::size_t>& offsets, std::vector<std::size_t>& counts, std::vector<std::size_t>& strides);
+        // Rows of HDF5 dimension split read at once, a multiple of the chunk extent for unstrided chunked reads
+        uint64_t block_rows(const std::string& dataset, uint64_t split, uint64_t row_bytes, uint64_t stride);
+
+        // The HDF5 library is not reentrant unless built thread-safe. Every library call goes through it,
+        // including opening and closing files and the reference counting of copied and destroyed handles.
+        static std::mutex library_mutex;
+
+        // DataSet handles close their HDF5 objects on destruction, so they are released under the library lock
+        struct LockedDataSets {
+            std::vector<HighFive::DataSet> handles;
+            ~LockedDataSets() {
+                std::lock_guard<std::mutex> lock(library_mutex);
+                handles.clear();
+            }
+        };
+
+        friend struct HDF5Tree;
 
 
     private:
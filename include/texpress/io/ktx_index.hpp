@@ -0,0 +1,46 @@
+#pragma once
+#include <texpress/types/texture.hpp>
+#include <string>
+#include <vector>
+
+namespace texpress {
+    // Byte offsets of every (t, z) slice of a dataset stored in one or more KTX1 files.
+    // Saved as a "_index.bin" sidecar, so single slices can be located without parsing or loading the KTX files.
+    struct  KTXIndex {
+        glm::ivec4 dimensions = glm::ivec4(0);              // extents of each grid dimension
+        gl::GLenum gl_internal = gl::GLenum::GL_NONE;
+        uint64_t slice_bytes = 0;                           // every slice has the same size
+        std::vector<std::string> files;                     // file names, relative to the directory of the index
+        std::vector<uint32_t> slice_files;                  // file of slice t * dim_z + z
+        std::vector<uint64_t> slice_offsets;                // absolute byte offset of slice t * dim_z + z in its file
+
+        uint64_t slices() const { return slice_offsets.size(); }
+    };
+
+    // Path of the sidecar for a dataset saved with save_ktx(..., path, ...)
+    std::string ktx_index_path(const char* path);
+
+    // Parses the headers of the given KTX1 files, which hold consecutive time steps (or all of them if monolithic).
+    bool build_ktx_index(const std::vector<std::string>& paths, KTXIndex& index);
+    bool save_ktx_index(const char* path, const KTXIndex& index);
+    bool load_ktx_index(const char* path, KTXIndex& index);
+
+    // Random access to slices of a KTX dataset, reads only the bytes of the requested slices.
+    class KTXReader {
+    public:
+        // Opens the dataset saved with save_ktx(..., path, ...). Uses the index sidecar if present, parses the headers otherwise.
+        bool open(const char* path);
+
+        const KTXIndex& index() const { return idx; }
+
+        // Copies slices [z, z + slices) of time step t as stored, i.e. still compressed for compressed formats.
+        bool read(uint64_t t, uint64_t z, uint64_t slices, uint8_t* data_ptr) const;
+
+        // Reads slices [z, z + slices) of time step t into output, BC6H blocks are decoded to 32 bit floats.
+        bool decode(uint64_t t, uint64_t z, uint64_t slices, Texture& output, uint8_t channels = 3, uint32_t threads = 0) const;
+
+    private:
+        KTXIndex idx;
+        std::string directory;
+    };
+}
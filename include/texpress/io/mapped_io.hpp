@@ -0,0 +1,37 @@
+#pragma once
+#include <texpress/types/texture_view.hpp>
+#include <cstdint>
+
+namespace texpress {
+    // Read-only memory mapping of a whole file, pages are loaded on first access.
+    class MappedFile {
+    public:
+        MappedFile() = default;
+        MappedFile(const MappedFile& that) = delete;
+        MappedFile(MappedFile&& temp) = delete;
+        ~MappedFile();
+        MappedFile& operator=(const MappedFile& that) = delete;
+        MappedFile& operator=(MappedFile&& temp) = delete;
+
+        bool open(const char* path);
+        void close();
+
+        bool is_open() const { return ptr != nullptr; }
+        const uint8_t* data() const { return ptr; }
+        uint64_t size() const { return bytes; }
+
+    private:
+        const uint8_t* ptr = nullptr;
+        uint64_t bytes = 0;
+#if defined(_WIN32)
+        void* file_handle = nullptr;
+        void* mapping_handle = nullptr;
+#else
+        int descriptor = -1;
+#endif
+    };
+
+    // Maps a raw float dataset and points view at its texels without copying.
+    // Dimensions are parsed from the leading xyzw header or the "_dims" sidecar, like the regular raw loader.
+    bool load_raw_mapped(const char* path, MappedFile& file, TextureView& view);
+}
@@ -0,0 +1,95 @@
+#pragma once
+#include <cstdint>
+
+namespace texpress {
+    // Destination of encoded data. Writes go to absolute offsets, so independent slices may be written
+    // in any order and from several threads at once as long as their ranges do not overlap.
+    class OutputSink {
+    public:
+        virtual ~OutputSink() = default;
+
+        // Memory backing [offset, offset + bytes) to encode into directly, nullptr if the sink only supports write
+        virtual uint8_t* data(uint64_t offset, uint64_t bytes) = 0;
+        virtual bool write(uint64_t offset, const void* data, uint64_t bytes) = 0;
+        // Bytes available, writes past it fail
+        virtual uint64_t size() const = 0;
+        virtual bool flush() { return true; }
+    };
+
+    // Caller owned buffer.
+    class MemorySink : public OutputSink {
+    public:
+        MemorySink(uint8_t* buffer, uint64_t buffer_bytes) : ptr(buffer), capacity(buffer_bytes) {}
+
+        uint8_t* data(uint64_t offset, uint64_t bytes) override;
+        bool write(uint64_t offset, const void* data, uint64_t bytes) override;
+        uint64_t size() const override { return capacity; }
+
+    private:
+        uint8_t* ptr = nullptr;
+        uint64_t capacity = 0;
+    };
+
+    // Positional writes to a file kept open, no seeking and no locking between writers.
+    // Offsets are relative to base, e.g. the end of a file header.
+    class FileSink : public OutputSink {
+    public:
+        FileSink() = default;
+        FileSink(const FileSink& that) = delete;
+        FileSink(FileSink&& temp) = delete;
+        ~FileSink();
+        FileSink& operator=(const FileSink& that) = delete;
+        FileSink& operator=(FileSink&& temp) = delete;
+
+        // truncate discards existing content, otherwise the file is created if missing
+        bool open(const char* path, uint64_t base = 0, bool truncate = true, uint64_t bytes = UINT64_MAX);
+        void close();
+        bool is_open() const;
+
+        uint8_t* data(uint64_t offset, uint64_t bytes) override { return nullptr; }
+        bool write(uint64_t offset, const void* data, uint64_t bytes) override;
+        uint64_t size() const override { return capacity; }
+        bool flush() override;
+
+    private:
+        uint64_t origin = 0;            // File offset of sink offset 0
+        uint64_t capacity = 0;
+#if defined(_WIN32)
+        void* file_handle = nullptr;
+#else
+        int descriptor = -1;
+#endif
+    };
+
+    // Writable shared mapping of [base, base + bytes) of a file, which is created or grown to fit.
+    // Encoders write into the page cache directly, dirty pages are written back by the OS or on flush.
+    class MappedSink : public OutputSink {
+    public:
+        MappedSink() = default;
+        MappedSink(const MappedSink& that) = delete;
+        MappedSink(MappedSink&& temp) = delete;
+        ~MappedSink();
+        MappedSink& operator=(const MappedSink& that) = delete;
+        MappedSink& operator=(MappedSink&& temp) = delete;
+
+        bool open(const char* path, uint64_t base, uint64_t bytes);
+        void close();
+        bool is_open() const { return ptr != nullptr; }
+
+        uint8_t* data(uint64_t offset, uint64_t bytes) override;
+        bool write(uint64_t offset, const void* data, uint64_t bytes) override;
+        uint64_t size() const override { return capacity; }
+        bool flush() override;
+
+    private:
+        uint8_t* ptr = nullptr;         // Start of the mapping, aligned down from base
+        uint64_t shift = 0;             // base - start of the mapping
+        uint64_t capacity = 0;
+#if defined(_WIN32)
+        void* file_handle = nullptr;
+        void* mapping_handle = nullptr;
+#else
+        int descriptor = -1;
+#endif
+    };
+}
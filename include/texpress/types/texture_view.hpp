@@ -0,0 +1,56 @@
+#pragma once
+
+#include <texpress/types/texture.hpp>
+#include <algorithm>
+
+namespace texpress
+{
+    // Non-owning view on texels stored elsewhere, e.g. in a Texture or a memory-mapped file.
+    struct TextureView {
+        const uint8_t* data = nullptr;                      // first texel, not owned
+        uint64_t data_bytes = 0;
+        uint8_t channels = 0;
+        glm::ivec4 dimensions = glm::ivec4(0);              // extents of each grid dimension
+        gl::GLenum gl_type = gl::GLenum::GL_NONE;           // data type (unsigned int, float, ...) as glenum
+        gl::GLenum gl_internal = gl::GLenum::GL_NONE;       // internal format as glenum
+        gl::GLenum gl_format = gl::GLenum::GL_NONE;
+
+        uint64_t bytes() const {
+            return data_bytes;
+        }
+
+        bool empty() const {
+            return !data || !data_bytes;
+        }
+
+        bool compressed() const {
+            return gl_compressed(gl_internal);
+        }
+
+        uint64_t slices() const {
+            return (uint64_t)std::max(dimensions.z, 1) * (uint64_t)std::max(dimensions.w, 1);
+        }
+
+        // Every (t, z) slice has the same size, compressed or not
+        uint64_t slice_bytes() const {
+            return data_bytes / slices();
+        }
+
+        const uint8_t* slice(uint64_t id) const {
+            return data + id * slice_bytes();
+        }
+    };
+
+    inline TextureView texture_view(const Texture& tex) {
+        TextureView view;
+        view.data = tex.data.data();
+        view.data_bytes = tex.bytes();
+        view.channels = tex.channels;
+        view.dimensions = tex.dimensions;
+        view.gl_type = tex.gl_type;
+        view.gl_internal = tex.gl_internal;
+        view.gl_format = tex.gl_format;
+
+        return view;
+    }
+}
@@ -0,0 +1,37 @@
+#pragma once
+#include <cstdint>
+#include <texpress/types/texture_view.hpp>
+
+namespace texpress {
+    // Error of a reconstruction against its reference, gathered in a single pass.
+    struct  ErrorStats {
+        uint64_t texels = 0;
+        uint8_t channels = 0;
+        double mean[4] = { 0.0, 0.0, 0.0, 0.0 };      // mean absolute error per channel
+        double rms[4] = { 0.0, 0.0, 0.0, 0.0 };       // root mean squared error per channel
+        double max[4] = { 0.0, 0.0, 0.0, 0.0 };       // maximum absolute error per channel
+        double psnr[4] = { 0.0, 0.0, 0.0, 0.0 };      // peak signal to noise ratio per channel in dB, peak is the value range of the reference
+        double range[4] = { 0.0, 0.0, 0.0, 0.0 };     // value range (max - min) of the reference per channel
+        double rms_total = 0.0;                       // over all channels
+        double psnr_total = 0.0;                      // over all channels, peak is the largest channel range
+        double distance_mean = 0.0;                   // euclidean distance of the texel vectors
+        double distance_rms = 0.0;
+        double distance_max = 0.0;
+    };
+
+    // Compares interleaved float fields, channels beyond those of b are compared against 0.
+    // Texels are split over threads (0 uses all hardware threads), each thread reduces its range and the partial results are combined.
+    // Per texel errors are written to component_field (channels_a floats) and distance_field (1 float) if given.
+    bool compute_error(const float* a_ptr, uint8_t channels_a, const float* b_ptr, uint8_t channels_b, uint64_t texels, ErrorStats& stats,
+        float* component_field = nullptr, float* distance_field = nullptr, uint32_t threads = 0);
+
+    // Texture convenience, both textures have to be uncompressed halves or floats of the same dimensions. Halves are widened to floats block by block during the reduction.
+    bool error_stats(const Texture& reference, const Texture& reconstruction, ErrorStats& stats, uint32_t threads = 0);
+    bool component_error(const Texture& reference, const Texture& reconstruction, Texture& error, ErrorStats* stats = nullptr, uint32_t threads = 0);
+    bool distance_error(const Texture& reference, const Texture& reconstruction, Texture& error, ErrorStats* stats = nullptr, uint32_t threads = 0);
+
+    // Same for texels that are not owned by a Texture, e.g. a memory-mapped reference.
+    bool error_stats(const TextureView& reference, const TextureView& reconstruction, ErrorStats& stats, uint32_t threads = 0);
+    bool component_error(const TextureView& reference, const TextureView& reconstruction, Texture& error, ErrorStats* stats = nullptr, uint32_t threads = 0);
+    bool distance_error(const TextureView& reference, const TextureView& reconstruction, Texture& error, ErrorStats* stats = nullptr, uint32_t threads = 0);
+}
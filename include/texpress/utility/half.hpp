@@ -0,0 +1,16 @@
+#pragma once
+#include <cstdint>
+#include <texpress/types/texture_view.hpp>
+
+namespace texpress {
+    // Converts count floats to IEEE half floats and back, eight at a time with F16C if available, fp16 otherwise.
+    void convert_to_half(const float* src, uint16_t* dest, uint64_t count);
+    void convert_to_float(const uint16_t* src, float* dest, uint64_t count);
+
+    // Bits per value of an uncompressed float texture, 16 (half), 32 (float) or 0 if it is neither.
+    uint8_t float_bits(const Texture& texture);
+    uint8_t float_bits(const TextureView& view);
+
+    // Converts an uncompressed float or half texture to bits (16 or 32) per value, chunks are spread over threads (0 uses all hardware threads).
+    bool convert_texture(const Texture& input, Texture& output, uint8_t bits, uint32_t threads = 0);
+}
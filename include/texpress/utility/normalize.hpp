@@ -149,7 +149,7 @@ namespace texpress {
         std::size_t               vec_len
     )
     {
-        std::size_t max_components = std::max(i, vec_len);
+        std::size_t max_components = std::max<std::size_t>(i, vec_len);
         return find_peaks_per_component(static_cast<T*>(data), grid, max_components);
     }
 
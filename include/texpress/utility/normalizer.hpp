@@ -0,0 +1,44 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include <texpress/types/texture_view.hpp>
+
+namespace texpress {
+    enum NormalizeMode {
+        NORMALIZE_SLICE = 0,    // min/max per (t, z) slice and component
+        NORMALIZE_VOLUME        // min/max per component over the whole volume
+    };
+
+    // Parallel replacement of find_peaks_per_component with the same peaks layout:
+    // (min, max) per component per slice, i.e. peaks[2 * (slice * channels + c)] and peaks[2 * (slice * channels + c) + 1].
+    // Slices are split into cache sized chunks which are reduced by all threads (0 uses all hardware threads).
+    // Half input (uint16_t) is widened chunk by chunk, here and in the functions below.
+    bool find_peaks_parallel(const float* data_ptr, const glm::ivec4& dimensions, uint8_t channels, std::vector<float>& peaks, uint32_t threads = 0);
+    bool find_peaks_parallel(const uint16_t* data_ptr, const glm::ivec4& dimensions, uint8_t channels, std::vector<float>& peaks, uint32_t threads = 0);
+
+    // Reduces slice peaks to a single (min, max) pair per component.
+    std::vector<float> volume_peaks(const std::vector<float>& peaks, uint8_t channels);
+
+    // Maps every value to [0, 1] with the peaks of its slice (NORMALIZE_SLICE) or of the volume (NORMALIZE_VOLUME, 2 * channels peaks).
+    // Same results as normalize_val_per_component, written as 32 bit floats or 16 bit halves (bits) to output_ptr.
+    bool normalize(const float* data_ptr, const glm::ivec4& dimensions, uint8_t channels, const std::vector<float>& peaks, NormalizeMode mode, uint8_t bits, uint8_t* output_ptr, uint32_t threads = 0);
+    bool normalize(const uint16_t* data_ptr, const glm::ivec4& dimensions, uint8_t channels, const std::vector<float>& peaks, NormalizeMode mode, uint8_t bits, uint8_t* output_ptr, uint32_t threads = 0);
+
+    // Normalizes the values of a single slice of texels with its 2 * channels peaks on the calling thread, e.g. right before it is encoded.
+    bool normalize_slice(const float* data_ptr, uint64_t texels, uint8_t channels, const float* slice_peaks, uint8_t bits, uint8_t* output_ptr);
+    bool normalize_slice(const uint16_t* data_ptr, uint64_t texels, uint8_t channels, const float* slice_peaks, uint8_t bits, uint8_t* output_ptr);
+
+    // Inverse of normalize keeping the precision of the input, data_ptr and output_ptr may be the same buffer.
+    bool denormalize(const float* data_ptr, const glm::ivec4& dimensions, uint8_t channels, const std::vector<float>& peaks, NormalizeMode mode, float* output_ptr, uint32_t threads = 0);
+    bool denormalize(const uint16_t* data_ptr, const glm::ivec4& dimensions, uint8_t channels, const std::vector<float>& peaks, NormalizeMode mode, uint16_t* output_ptr, uint32_t threads = 0);
+
+    // Denormalizes a single slice with its 2 * channels peaks on the calling thread, e.g. right after it is decoded. May be in place.
+    bool denormalize_slice(const float* data_ptr, uint64_t texels, uint8_t channels, const float* slice_peaks, float* output_ptr);
+    bool denormalize_slice(const uint16_t* data_ptr, uint64_t texels, uint8_t channels, const float* slice_peaks, uint16_t* output_ptr);
+
+    // Texture convenience for half or float textures: finds the peaks of input (as requested by mode) and normalizes it into output.
+    bool normalize(const Texture& input, Texture& output, std::vector<float>& peaks, NormalizeMode mode = NormalizeMode::NORMALIZE_SLICE, uint8_t bits = 32, uint32_t threads = 0);
+    // Same for texels that are not owned by a Texture, e.g. a memory-mapped source.
+    bool normalize(const TextureView& input, Texture& output, std::vector<float>& peaks, NormalizeMode mode = NormalizeMode::NORMALIZE_SLICE, uint8_t bits = 32, uint32_t threads = 0);
+    bool denormalize(const Texture& input, Texture& output, const std::vector<float>& peaks, NormalizeMode mode = NormalizeMode::NORMALIZE_SLICE, uint32_t threads = 0);
+}
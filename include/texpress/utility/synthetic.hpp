@@ -0,0 +1,36 @@
+#pragma once
+
+#include <texpress/types/texture.hpp>
+#include <cstdint>
+#include <string>
+
+namespace texpress
+{
+    // Time dependent Arnold-Beltrami-Childress flow, sampled at integer grid positions in [begin, end):
+    // u = a(t) sin(s z) + b cos(s y), v = b sin(s x) + c cos(s z), w = c sin(s y) + a(t) cos(s x)
+    // with a(t) = a + time_amplitude * t * sin(pi * time_frequency * t) and s = scale.
+    struct  ABCSettings {
+        glm::ivec4 begin = glm::ivec4(-100, 0, -100, 0);        // First grid position (x, y, z, t)
+        glm::ivec4 end = glm::ivec4(125, 250, 100, 151);        // One past the last grid position
+        float a = 1.73205080757f;                               // sqrt(3)
+        float b = 1.41421356237f;                               // sqrt(2)
+        float c = 1.0f;
+        float scale = 0.05f;                                    // Spatial frequency s
+        float time_amplitude = 0.05f;
+        float time_frequency = 0.01f;
+        uint32_t threads = 0;                                   // (t, z) slices generated in parallel, 0 uses all hardware threads
+    };
+
+    // Extents of the sampled grid, 3 float channels per texel
+    glm::ivec4 abc_dimensions(const ABCSettings& settings);
+
+    // Writes slices [first_slice, first_slice + slices) of the field, counted as t * dim_z + z, to output.
+    // sin and cos are separable per axis, so they are only evaluated once per axis and time step.
+    bool generate_abc_slices(const ABCSettings& settings, uint64_t first_slice, uint64_t slices, float* output);
+
+    // Fills output with the whole field as 32 bit float RGB texture.
+    bool generate_abc(const ABCSettings& settings, Texture& output);
+
+    // Parses "abc" (defaults) or "abc:x0,y0,z0,t0,x1,y1,z1,t1" into settings.
+    bool parse_abc(const std::string& spec, ABCSettings& settings);
+}
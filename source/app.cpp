@@ -1,18 +1,22 @@
 #include <texpress/api.hpp>
+#include <texpress/compression/async.hpp>
+#include <texpress/graphics/preview_cache.hpp>
 #include <texpress/helpers/vtkhelper.hpp>
+#include <texpress/utility/error_metrics.hpp>
+#include <texpress/utility/half.hpp>
 #include <texpress/utility/normalize.hpp>
+#include <texpress/utility/normalizer.hpp>
 #include <boost/accumulators/accumulators.hpp>
 #include <boost/accumulators/statistics.hpp>
-#include <fp16/fp16.h>
 #include <iostream>
 #include <filesystem>
 #include <spdlog/spdlog.h>
 #include <thread>
 #include <future>
-#include <fp16.h>
 #include <chrono>
 #include <glm/gtx/compatibility.hpp>
 #include <texpress/utility/stringtools.hpp>
+#include <texpress/utility/synthetic.hpp>
 #define IMGUI_COLOR_HDFGROUP ImGui::PushStyleColor(ImGuiCol_Text, ImVec4(148/255.f, 180/255.f, 159/255.f, 255/255.f))
 #define IMGUI_COLOR_HDFDATASET ImGui::PushStyleColor(ImGuiCol_Text, ImVec4(206/255.f, 229/255.f, 208/255.f, 255/255.f))
 #define IMGUI_COLOR_HDFOTHER ImGui::PushStyleColor(ImGuiCol_Text, ImVec4(252/255.f, 248/255.f, 232/255.f, 255/255.f))
@@ -66,81 +70,12 @@ int save_deinterleaved(const char* path, const texpress::Texture& tex, bool appe
 }
 
 
-void component_error(const texpress::Texture& tex_a, const texpress::Texture& tex_b, texpress::Texture& tex_error) {
-    tex_error.data.clear();
-    tex_error.dimensions = tex_a.dimensions;
-    tex_error.channels = tex_a.channels;
-    tex_error.gl_internal = texpress::gl_internal(tex_error.channels, 32, true);
-    tex_error.gl_format = texpress::gl_format(tex_error.channels);
-    tex_error.gl_type = gl::GLenum::GL_FLOAT;
-    tex_error.data.resize(tex_a.bytes());
-
-    glm::dvec4 avg_error(0.0);
-
-    const float* a_ptr = (const float*)tex_a.data.data();
-    const float* b_ptr = (const float*)tex_b.data.data();
-    float* err_ptr = (float*)tex_error.data.data();
-
-    uint64_t vectors_2d = (uint64_t)tex_a.dimensions.x * (uint64_t)tex_a.dimensions.y;
-    uint64_t scalars_2d = vectors_2d * (uint64_t)tex_a.channels;
-
-    uint64_t n = vectors_2d * (uint64_t)tex_a.dimensions.z * (uint64_t)tex_a.dimensions.w;
-
-    for (uint64_t d = 0; d < tex_a.dimensions.z * tex_a.dimensions.w; d++) {
-        for (uint64_t p = 0; p < tex_a.dimensions.x * tex_a.dimensions.y; p++) {
-            glm::vec4 vec_a(0.0f, 0.0f, 0.0f, 1.0f);
-            glm::vec4 vec_b(vec_a);
-
-            for (uint64_t c = 0; c < tex_a.channels; c++) {
-                vec_a[c] = a_ptr[d * scalars_2d + p * (uint64_t)tex_a.channels + c];
-                vec_b[c] = b_ptr[d * scalars_2d + p * (uint64_t)tex_b.channels + c];
-
-                err_ptr[d * scalars_2d + p * (uint64_t)tex_a.channels + c] = glm::abs(vec_a[c] - vec_b[c]);
-
-                avg_error[c] += glm::abs(vec_a[c] - vec_b[c]) / (double)n;
-            }
-        }
-    }
-
-    spdlog::info("Average Component Error: ({0:.4f}, {1:.4f}, {2:.4f}, {3:.4f})", avg_error.x, avg_error.y, avg_error.z, avg_error.w);
-}
-
-void distance_error(const texpress::Texture& tex_a, const texpress::Texture& tex_b, texpress::Texture& tex_error) {
-    tex_error.data.clear();
-    tex_error.dimensions = tex_a.dimensions;
-    tex_error.channels = 1;
-    tex_error.gl_internal = texpress::gl_internal(tex_error.channels, 32, true);
-    tex_error.gl_format = texpress::gl_format(tex_error.channels);
-    tex_error.gl_type = gl::GLenum::GL_FLOAT;
-    tex_error.data.resize(tex_a.bytes() / (uint64_t)tex_a.channels);
-
-    double avg_error(0.0);
-
-    const float* a_ptr = (const float*)tex_a.data.data();
-    const float* b_ptr = (const float*)tex_b.data.data();
-    float* err_ptr = (float*)tex_error.data.data();
-
-    uint64_t vectors_2d = (uint64_t)tex_a.dimensions.x * (uint64_t)tex_a.dimensions.y;
-    uint64_t scalars_2d = vectors_2d * (uint64_t)tex_a.channels;
-
-    uint64_t n = vectors_2d * (uint64_t)tex_a.dimensions.z * (uint64_t)tex_a.dimensions.w;
-
-    for (uint64_t d = 0; d < tex_a.dimensions.z * tex_a.dimensions.w; d++) {
-        for (uint64_t p = 0; p < tex_a.dimensions.x * tex_a.dimensions.y; p++) {
-            glm::vec4 vec_a(0.0f, 0.0f, 0.0f, 1.0f);
-            glm::vec4 vec_b(vec_a);
-
-            for (uint64_t c = 0; c < tex_a.channels; c++) {
-                vec_a[c] = a_ptr[d * scalars_2d + p * (uint64_t)tex_a.channels + c];
-                vec_b[c] = b_ptr[d * scalars_2d + p * (uint64_t)tex_b.channels + c];
-            }
-
-            err_ptr[d * vectors_2d + p] = glm::distance(vec_a, vec_b);
-            avg_error += glm::distance(vec_a, vec_b) / (double)n;
-        }
-    }
-
-    spdlog::info("Average Distance Error: {0:.4f}", avg_error);
+void log_error(const char* name, const texpress::ErrorStats& stats) {
+    spdlog::info("{0}: mean ({1:.4f}, {2:.4f}, {3:.4f}, {4:.4f}), rms ({5:.4f}, {6:.4f}, {7:.4f}, {8:.4f}), max ({9:.4f}, {10:.4f}, {11:.4f}, {12:.4f})", name,
+        stats.mean[0], stats.mean[1], stats.mean[2], stats.mean[3],
+        stats.rms[0], stats.rms[1], stats.rms[2], stats.rms[3],
+        stats.max[0], stats.max[1], stats.max[2], stats.max[3]);
+    spdlog::info("{0}: distance mean {1:.4f}, rms {2:.4f}, max {3:.4f}, PSNR {4:.2f} dB", name, stats.distance_mean, stats.distance_rms, stats.distance_max, stats.psnr_total);
 }
 
 void update(double dt) {
@@ -177,10 +112,11 @@ struct update_pass : texpress::render_pass
         , abc_y1(250)
         , abc_z1(100)
         , abc_t1(151)
-        , gl_tex_in(globjects::Texture::createDefault())
-        , gl_tex_out(globjects::Texture::createDefault())
+        , preview_cache()
         , hdf5_file(nullptr)
         , tex_source()
+        , source_mapping()
+        , source_view()
         , tex_normalized()
         , tex_encoded()
         , tex_decoded()
@@ -190,7 +126,9 @@ struct update_pass : texpress::render_pass
         , depth_src(0)
         , depth_enc(0)
         , sync_sliders(false)
+        , scrubbing_src(false)
         , peaks()
+        , half_precision(false)
         , MaxButtonWidth(0)
     {
         on_prepare = [&]()
@@ -244,52 +182,24 @@ struct update_pass : texpress::render_pass
                     }
                     ImGui::SameLine();
                     ImGui::InputText("##Filepath", buf_path, 128);
+                    // The encoder thread reads the inputs and writes tex_encoded until compress_task is finished, nothing may reallocate them before
+                    ImGui::BeginDisabled(compress_task.valid());
                     if (ImGui::Button("Generate ABC Field", { MaxButtonWidth, 0 })) {
-                        uint64_t abc_x, abc_y, abc_z, abc_t;
-                        abc_x = abc_x1 - abc_x0;
-                        abc_y = abc_y1 - abc_y0;
-                        abc_z = abc_z1 - abc_z0;
-                        abc_t = abc_t1 - abc_t0;
-                        tex_source.channels = 3;
-                        tex_source.dimensions = { abc_x, abc_y, abc_z, abc_t };
-                        auto buffersize = uint64_t(abc_x) * uint64_t(abc_y) * uint64_t(abc_z) * uint64_t(abc_t) * uint64_t(tex_source.channels) * sizeof(float);
-                        tex_source.data.resize(buffersize);
-                        tex_source.gl_internal = texpress::gl_internal(tex_source.channels, 32, true);
-                        tex_source.gl_format = texpress::gl_format(tex_source.channels);
-                        tex_source.gl_type = gl::GLenum::GL_FLOAT;
-                        tex_in = &tex_source;
-
-                        const float A_PARAM = glm::sqrt(3);
-                        const float B_PARAM = glm::sqrt(2);
-                        const float C_PARAM = 1.0;
-                        const float c_pos = 0.05;
-                        const float c_t1 = 0.05;
-                        const float c_t2 = 0.01;
-
-                        glm::vec3* ptr = (glm::vec3*)tex_source.data.data();
-                        uint64_t offset = 0;
-                        for (auto t = abc_t0; t < abc_t1; t++) {
-                            float time = t;
-                            float a_coeff = A_PARAM + c_t1 * time * glm::sin(PI * time * c_t2);
-
-                            for (auto z = abc_z0; z < abc_z1; z++) {
-                                for (auto y = abc_y0; y < abc_y1; y++) {
-                                    for (auto x = abc_x0; x < abc_x1; x++) {
-                                        glm::vec3 pos(x, y, z);
-                                        glm::vec3 velo(a_coeff * glm::sin(pos.z * c_pos) + B_PARAM * glm::cos(pos.y * c_pos),
-                                            B_PARAM * glm::sin(pos.x * c_pos) + C_PARAM * glm::cos(pos.z * c_pos),
-                                            C_PARAM * glm::sin(pos.y * c_pos) + a_coeff * glm::cos(pos.x * c_pos));
-
-                                        ptr[offset] = velo;
-
-                                        offset++;
-                                    }
-                                }
-                            }
+                        texpress::ABCSettings abc;
+                        abc.begin = { abc_x0, abc_y0, abc_z0, abc_t0 };
+                        abc.end = { abc_x1, abc_y1, abc_z1, abc_t1 };
+
+                        source_mapping.close();
+                        source_view = texpress::TextureView{};
+                        if (!texpress::generate_abc(abc, tex_source)) {
+                            tex_source.data.clear();
                         }
+                        tex_in = &tex_source;
 
+                        preview_cache.invalidate(&tex_source);
                         configuration_changed = false;
                     }
+                    ImGui::EndDisabled();
                     ImGui::SameLine();
                     ImGui::Text("[X x Y x Z x T]");
                     const float item_width = 50.0;
@@ -394,125 +304,91 @@ struct update_pass : texpress::render_pass
                     ImGui::PopItemWidth();
                     ImGui::EndGroup();
 
+                    // Time steps [offset_t, offset_t + steps_t * stride_t), 0 steps reads up to the last one
+                    static int offset_t = 0;
+                    static int steps_t = 0;
+                    static int stride_t = 1;
+                    ImGui::Text("Time Steps");
+                    ImGui::SameLine();
+                    ImGui::BeginGroup();
+                    ImGui::PushItemWidth(ImGui::GetContentRegionAvail().x * 0.5f);
+                    ImGui::Text("Offset");
+                    ImGui::SameLine();
+                    if (ImGui::InputInt("##T Offset", &offset_t, 1, 100))
+                        configuration_changed = true;
+                    ImGui::Text("Steps ");
+                    ImGui::SameLine();
+                    if (ImGui::InputInt("##T Steps", &steps_t, 1, 100))
+                        configuration_changed = true;
+                    ImGui::Text("Stride");
+                    ImGui::SameLine();
+                    if (ImGui::InputInt("##T Stride", &stride_t))
+                        configuration_changed = true;
+                    ImGui::PopItemWidth();
+                    ImGui::EndGroup();
+
+                    ImGui::BeginDisabled(compress_task.valid());
                     if (ImGui::Button("Upload HDF5", { MaxButtonWidth, 0 }) && std::filesystem::exists(buf_path)) {
+                        source_mapping.close();
+                        source_view = texpress::TextureView{};
+
+                        texpress::HDF5Region region;
+                        region.offset[0] = std::max(offset_x, 0);
+                        region.offset[1] = std::max(offset_y, 0);
+                        region.offset[2] = std::max(offset_z, 0);
+                        region.offset[3] = std::max(offset_t, 0);
+                        region.stride[0] = std::max(stride_x, 1);
+                        region.stride[1] = std::max(stride_y, 1);
+                        region.stride[2] = std::max(stride_z, 1);
+                        region.stride[3] = std::max(stride_t, 1);
+                        region.count[3] = std::max(steps_t, 0);
+
                         texpress::hdf5 file(buf_path);
-                        file.read_datasets<float>({ buf_x, buf_y, buf_z }
-                            , { uint64_t(offset_x), uint64_t(offset_y), uint64_t(offset_z) }
-                            , { uint64_t(stride_x), uint64_t(stride_y), uint64_t(stride_z) }
-                            , { 2, 1, 0 }
-                        , tex_source.data);
+                        if (!file.read_region<float>({ buf_x, buf_y, buf_z }, region, tex_source.data, 0, half_precision)) {
+                            tex_source.data.clear();
+                        }
                         tex_source.channels = file.get_vec_len(buf_x);
 
-                        auto dims = file.dataset_dimensions(buf_x);
+                        auto dims = file.region_dimensions(buf_x, region);
                         for (int i = 0; i < tex_source.dimensions.length(); i++) {
                             tex_source.dimensions[i] = (i < dims.size()) ? dims[i] : 1;
                         }
 
-                        tex_source.gl_internal = texpress::gl_internal(tex_source.channels, 32, true);
+                        tex_source.gl_internal = texpress::gl_internal(tex_source.channels, (half_precision) ? 16 : 32, true);
                         tex_source.gl_format = texpress::gl_format(tex_source.channels);
-                        tex_source.gl_type = gl::GLenum::GL_FLOAT;
+                        tex_source.gl_type = (half_precision) ? gl::GLenum::GL_HALF_FLOAT : gl::GLenum::GL_FLOAT;
 
                         tex_in = &tex_source;
 
+                        preview_cache.invalidate(&tex_source);
                         configuration_changed = false;
                     }
+                    ImGui::EndDisabled();
+                    ImGui::SameLine();
+                    ImGui::Checkbox("Half precision", &half_precision);
 
                     static int normalize_mode = 0;
-                    if (ImGui::Button("Normalize Source", { MaxButtonWidth, 0 })) {
-                        tex_normalized.channels = tex_source.channels;
-                        tex_normalized.dimensions = tex_source.dimensions;
-                        tex_normalized.gl_format = tex_source.gl_format;
-                        tex_normalized.gl_internal = tex_source.gl_internal;
-                        tex_normalized.gl_type = gl::GLenum::GL_FLOAT;
-                        tex_normalized.data.resize(tex_source.bytes());
-                        peaks = texpress::find_peaks_per_component<float>(tex_source);
-
-                        if (normalize_mode == 0) {
-                            /*
-                            for (auto& p : peaks) {
-                              uint16_t shifted = fp16_ieee_from_fp32_value(p) & 0b1111111111111110;
-                              p = fp16_ieee_to_fp32_value(shifted);
-                            }
-                            */
-                            float* src_ptr = (float*)tex_source.data.data();
-                            float* norm_ptr = (float*)tex_normalized.data.data();
-                            uint64_t id = 0;
-                            for (uint64_t d = 0; d < tex_normalized.dimensions.z * tex_normalized.dimensions.w; d++) {
-                                for (uint64_t p = 0; p < tex_normalized.dimensions.x * tex_normalized.dimensions.y; p++) {
-                                    for (int c = 0; c < tex_normalized.channels; c++) {
-                                        //uint16_t shifted = fp16_ieee_from_fp32_value(src_ptr[id]) & 0b1111111111111110;
-                                        //norm_ptr[id] = texpress::normalize_val_per_component(fp16_ieee_to_fp32_value(shifted), tex_source.channels, peaks, d, c);
-                                        norm_ptr[id] = texpress::normalize_val_per_component(src_ptr[id], tex_source.channels, peaks, d, c);
-                                        id++;
-                                    }
-                                }
-                            }
+                    // A memory-mapped source keeps its texels in source_view, tex_source only carries the metadata
+                    const texpress::TextureView source_texels = (source_mapping.is_open()) ? source_view : texpress::texture_view(tex_source);
+                    ImGui::BeginDisabled(compress_task.valid());
+                    if (ImGui::Button("Normalize Source", { MaxButtonWidth, 0 }) && !source_texels.empty()) {
+                        // peaks keeps the per slice layout, volume mode reduces it on demand
+                        if (texpress::normalize(source_texels, tex_normalized, peaks, (texpress::NormalizeMode)normalize_mode, (half_precision) ? 16 : 32)) {
+                            preview_cache.invalidate(&tex_normalized);
+                            tex_out = &tex_normalized;
                         }
-                        else {
-                            glm::vec3* peak_ptr = (glm::vec3*)peaks.data();
-                            min = glm::vec3(INFINITY);
-                            max = glm::vec3(-INFINITY);
-
-                            for (uint32_t i = 0; i < peaks.size() / (3 * 2); i += 2) {
-                                const auto& p_min = peak_ptr[i];
-                                const auto& p_max = peak_ptr[i + 1];
-                                min.x = (min.x <= p_min.x) ? min.x : p_min.x;
-                                min.y = (min.y <= p_min.y) ? min.y : p_min.y;
-                                min.z = (min.z <= p_min.z) ? min.z : p_min.z;
-
-                                max.x = (max.x >= p_max.x) ? max.x : p_max.x;
-                                max.y = (max.y >= p_max.y) ? max.y : p_max.y;
-                                max.z = (max.z >= p_max.z) ? max.z : p_max.z;
-                            }
-
-                            float* src_ptr = (float*)tex_source.data.data();
-                            float* norm_ptr = (float*)tex_normalized.data.data();
-                            uint64_t id = 0;
-                            for (uint64_t d = 0; d < tex_normalized.dimensions.z * tex_normalized.dimensions.w; d++) {
-                                for (uint64_t p = 0; p < tex_normalized.dimensions.x * tex_normalized.dimensions.y; p++) {
-                                    for (int c = 0; c < tex_normalized.channels; c++) {
-                                        //uint16_t shifted = fp16_ieee_from_fp32_value(src_ptr[id]) & 0b1111111111111110;
-                                        //norm_ptr[id] = texpress::normalize_val_per_component(fp16_ieee_to_fp32_value(shifted), tex_source.channels, peaks, d, c);
-                                        norm_ptr[id] = texpress::normalize_val_per_volume(src_ptr[id], tex_source.channels, min, max, c);
-                                        id++;
-                                    }
-                                }
-                            }
-
-                        }
-                        tex_out = &tex_normalized;
                     }
+                    ImGui::EndDisabled();
                     //ImGui::SameLine();
                     //ImGui::RadioButton("Slice based##norm", &normalize_mode, 0);
                     //ImGui::SameLine();
                     //ImGui::RadioButton("Volume based##norm", &normalize_mode, 1);
 
                     if (ImGui::Button("Denormalize Source", { MaxButtonWidth, 0 }) && !tex_normalized.data.empty()) {
-                        tex_decoded.channels = tex_normalized.channels;
-                        tex_decoded.dimensions = tex_normalized.dimensions;
-                        tex_decoded.gl_format = tex_normalized.gl_format;
-                        tex_decoded.gl_internal = tex_normalized.gl_internal;
-                        tex_decoded.gl_type = tex_normalized.gl_type;
-                        tex_decoded.data.resize(tex_normalized.bytes());
-
-                        float* norm_ptr = (float*)tex_normalized.data.data();
-                        float* dec_ptr = (float*)tex_decoded.data.data();
-                        uint64_t id = 0;
-                        for (uint64_t d = 0; d < tex_decoded.dimensions.z * tex_decoded.dimensions.w; d++) {
-                            for (uint64_t p = 0; p < tex_decoded.dimensions.x * tex_decoded.dimensions.y; p++) {
-                                for (int c = 0; c < tex_decoded.channels; c++) {
-                                    if (normalize_mode == 0) {
-                                        dec_ptr[id] = texpress::denormalize_per_component(norm_ptr[id], tex_normalized.channels, peaks, d, c);
-                                    }
-                                    else {
-                                        dec_ptr[id] = texpress::denormalize_per_volume(norm_ptr[id], tex_normalized.channels, min, max, c);
-                                    }
-                                    id++;
-                                }
-                            }
+                        if (texpress::denormalize(tex_normalized, tex_decoded, peaks, (texpress::NormalizeMode)normalize_mode)) {
+                            preview_cache.invalidate(&tex_decoded);
+                            tex_out = &tex_decoded;
                         }
-
-                        tex_out = &tex_decoded;
                     }
                     //ImGui::SameLine();
                     //ImGui::RadioButton("Slice based##denorm_src", &normalize_mode, 0);
@@ -522,13 +398,19 @@ struct update_pass : texpress::render_pass
 
                     static const std::vector<char*> compress_options = { "Fast", "Medium", "Production", "Highest" };
                     static int compress_selected = 0;
+                    static int compress_threads = 0;
+                    static const std::vector<char*> backend_options = { "NVTT", "Native" };
+                    static int backend_selected = 0;
 
                     static bool compress_normalized = false;
-                    if (ImGui::Button("Compress BC6H", { MaxButtonWidth, 0 }) && (!tex_source.data.empty() || !tex_normalized.data.empty())) {
+                    static bool compress_fused = false;
+                    if (ImGui::Button("Compress BC6H", { MaxButtonWidth, 0 }) && !compress_task.valid() && (!tex_source.data.empty() || !source_view.empty() || !tex_normalized.data.empty())) {
                         texpress::EncoderSettings settings{};
                         settings.use_weights = false;
 
-                        if (peaks.empty()) {
+                        // Fused: the source is normalized slice by slice while encoding instead of through tex_normalized
+                        const bool fuse_normalization = compress_normalized && compress_fused && (!tex_source.data.empty() || !source_view.empty());
+                        if (peaks.empty() && !fuse_normalization) {
                             compress_normalized = false;
                         }
 
@@ -556,30 +438,41 @@ struct update_pass : texpress::render_pass
                         }
 
                         settings.progress_ptr = nullptr;
+                        settings.threads = (uint32_t)std::max(compress_threads, 0);
+                        settings.backend = (backend_selected == 1) ? texpress::EncoderBackend::BACKEND_NATIVE : texpress::EncoderBackend::BACKEND_NVTT;
 
                         texpress::EncoderData input{};
-                        if (compress_normalized) {
+                        if (compress_normalized && !fuse_normalization) {
                             texpress::Encoder::populate_EncoderData(input, tex_normalized);
                         }
+                        else if (source_mapping.is_open()) {
+                            texpress::Encoder::populate_EncoderData(input, source_view);
+                        }
                         else {
                             texpress::Encoder::populate_EncoderData(input, tex_source);
                         }
 
+                        if (fuse_normalization) {
+                            const glm::ivec4 dims(input.dim_x, input.dim_y, input.dim_z, input.dim_t);
+                            if (!source_mapping.is_open() && texpress::float_bits(tex_source) == 16)
+                                texpress::find_peaks_parallel((const uint16_t*)input.data_ptr, dims, input.channels, peaks, settings.threads);
+                            else
+                                texpress::find_peaks_parallel((const float*)input.data_ptr, dims, input.channels, peaks, settings.threads);
+                            settings.normalize_peaks = peaks;
+                            settings.normalize_mode = (texpress::NormalizeMode)normalize_mode;
+                        }
+
+                        // The previews must not read tex_encoded while the encoder threads write it, it is shown again once finished
+                        if (tex_in == &tex_encoded) { tex_in = nullptr; }
+                        if (tex_out == &tex_encoded) { tex_out = nullptr; }
+                        preview_cache.invalidate(&tex_encoded);
+
                         texpress::EncoderData output{};
                         texpress::Encoder::initialize_buffer(tex_encoded.data, settings, input);
                         texpress::Encoder::populate_EncoderData(output, tex_encoded);
 
-                        auto t0 = std::chrono::high_resolution_clock::now();
-                        if (encoder->compress(settings, input, output)) {
-                            spdlog::info("Compressed!");
-                            texpress::Encoder::populate_Texture(tex_encoded, output);
-                        }
-                        auto t1 = std::chrono::high_resolution_clock::now();
-                        auto milliseconds = std::chrono::duration_cast<std::chrono::milliseconds>(t1 - t0).count();
-                        auto seconds = std::chrono::duration_cast<std::chrono::seconds>(t1 - t0).count();
-                        std::string time = std::to_string(milliseconds) + "\n" + std::to_string(seconds);
-                        texpress::file_save("times.txt", time.data(), time.size(), texpress::FILE_TEXT);
-                        tex_out = &tex_encoded;
+                        // Runs on its own thread and is finished below once ready, the GUI keeps rendering meanwhile
+                        compress_task = texpress::compress_async(settings, input, output);
                     }
 
                     ImGui::SameLine();
@@ -589,48 +482,84 @@ struct update_pass : texpress::render_pass
                     ImGui::SameLine();
                     ImGui::Checkbox("Use Normalized Data", &compress_normalized);
 
+                    if (compress_normalized) {
+                        ImGui::SameLine();
+                        ImGui::Checkbox("Normalize on the fly", &compress_fused);
+                    }
+
+                    ImGui::SameLine();
+                    ImGui::SetNextItemWidth(80);
+                    ImGui::InputInt("Threads (0 = all)", &compress_threads, 1, 4);
+
+                    ImGui::SameLine();
+                    ImGui::SetNextItemWidth(96);
+                    ImGui::Combo("Backend", &backend_selected, backend_options.data(), backend_options.size());
+
+                    if (compress_task.valid()) {
+                        texpress::CompressionProgress progress = compress_task.progress();
+
+                        if (compress_task.ready()) {
+                            texpress::EncoderData output = compress_task.output();
+                            if (compress_task.get()) {
+                                // Throughput is measured reproducibly by texpress_benchmark, this is only for the log
+                                spdlog::info("Compressed in {0:.3f} s", progress.seconds_elapsed);
+                                texpress::Encoder::populate_Texture(tex_encoded, output);
+                                preview_cache.invalidate(&tex_encoded);
+                                tex_out = &tex_encoded;
+                            }
+                            compress_task = texpress::CompressionTask();
+                        }
+                        else {
+                            std::string overlay = std::to_string(int(progress.fraction * 100.0f)) + "%";
+                            if (progress.seconds_remaining >= 0.0) {
+                                overlay += ", " + std::to_string(int(progress.seconds_remaining + 0.5)) + " s left";
+                            }
+
+                            ImGui::ProgressBar(progress.fraction, { MaxButtonWidth * 2, 0 }, overlay.c_str());
+                            ImGui::SameLine();
+                            if (ImGui::Button("Cancel##compress") || compress_task.cancelled()) {
+                                compress_task.cancel();
+                                ImGui::SameLine();
+                                ImGui::Text("Cancelling...");
+                            }
+                        }
+                    }
+
                     static bool decompress_and_denormalize = false;
-                    if (ImGui::Button("Decompress BC6H", { MaxButtonWidth, 0 }) && !tex_encoded.data.empty()) {
+                    if (ImGui::Button("Decompress BC6H", { MaxButtonWidth, 0 }) && !tex_encoded.data.empty() && !compress_task.valid()) {
                         texpress::EncoderData input{};
                         texpress::Encoder::populate_EncoderData(input, tex_encoded);
 
                         texpress::EncoderData output{};
-                        output.data_bytes = encoder->decoded_size(input);
-                        tex_decoded.data.resize(output.data_bytes);
-                        output.data_ptr = reinterpret_cast<uint8_t*>(tex_decoded.data.data());
-
-                        for (uint32_t d = 0; d < tex_encoded.dimensions.z * tex_encoded.dimensions.w; d++) {
-                            encoder->decompress(input, output, d);
-                        }
-
-                        texpress::Encoder::populate_Texture(tex_decoded, output);
+                        output.data_bytes = encoder->decoded_size(input, true, half_precision);
+                        output.gl_internal = (uint32_t)texpress::gl_internal(std::clamp<int>(input.channels, 1, 4), (half_precision) ? 16 : 32, true);
+                        // Decoded into a separate buffer, tex_decoded keeps its previous content if decompression fails
+                        std::vector<uint8_t> decoded(output.data_bytes);
+                        output.data_ptr = decoded.data();
 
                         if (peaks.empty()) {
                             decompress_and_denormalize = false;
                         }
 
+                        // Slices are denormalized by the thread that decoded them
+                        texpress::DecompressSettings decompress_settings;
                         if (decompress_and_denormalize) {
-                            float* dec_ptr = (float*)tex_decoded.data.data();
-                            uint64_t id = 0;
-                            for (uint64_t d = 0; d < tex_decoded.dimensions.z * tex_decoded.dimensions.w; d++) {
-                                for (uint64_t p = 0; p < tex_decoded.dimensions.x * tex_decoded.dimensions.y; p++) {
-                                    for (int c = 0; c < tex_decoded.channels; c++) {
-                                        if (normalize_mode == 0) {
-                                            dec_ptr[id] = texpress::denormalize_per_component(dec_ptr[id], tex_normalized.channels, peaks, d, c);
-                                        }
-                                        else {
-                                            dec_ptr[id] = texpress::denormalize_per_volume(dec_ptr[id], tex_normalized.channels, min, max, c);
-                                        }
-
-                                        id++;
-                                    }
-                                }
-                            }
+                            decompress_settings.denormalize_peaks = peaks;
+                            decompress_settings.denormalize_mode = (texpress::NormalizeMode)normalize_mode;
                         }
 
-                        tex_out = &tex_decoded;
+                        if (encoder->decompress_volume(decompress_settings, input, output)) {
+                            tex_decoded.data = std::move(decoded);
+                            texpress::Encoder::populate_Texture(tex_decoded, output);
+                            preview_cache.invalidate(&tex_decoded);
 
-                        configuration_changed = false;
+                            tex_out = &tex_decoded;
+
+                            configuration_changed = false;
+                        }
+                        else {
+                            spdlog::error("Decompressing BC6H failed");
+                        }
                     }
 
                     ImGui::SameLine();
@@ -826,10 +755,12 @@ struct update_pass : texpress::render_pass
                         ImGui::EndPopup();
                     }
 
+                    ImGui::BeginDisabled(compress_task.valid());
                     if (ImGui::Button("Load", { MaxButtonWidth, 0 })) {
                         ImGui::SetNextWindowSize(ImGui::GetContentRegionAvail());
                         ImGui::OpenPopup("Load Popup");
                     }
+                    ImGui::EndDisabled();
 
                     if (ImGui::BeginPopupModal("Load Popup", NULL, ImGuiWindowFlags_AlwaysAutoResize)) {
                         static const std::vector<char*> load_options{ "Source", "Normalized", "Peaks", "Compressed", "Decoded", "Error" };
@@ -843,6 +774,14 @@ struct update_pass : texpress::render_pass
 
                         ImGui::InputText("##Loadpath", load_path, 128);
 
+                        static bool load_mapped = false;
+                        if (load_selected == 0) {
+                            ImGui::Checkbox("Memory-map raw##load", &load_mapped);
+                            ImGui::SameLine();
+                            ImGui::Checkbox("Half precision##load", &half_precision);
+                        }
+
+                        ImGui::BeginDisabled(compress_task.valid());
                         if (ImGui::Button("Load##Action")) {
                             auto extension = texpress::str_lowercase(std::filesystem::path(load_path).extension().string());
                             bool raw = extension == ".raw";
@@ -853,21 +792,50 @@ struct update_pass : texpress::render_pass
                             bool seperate_dims = std::filesystem::exists(path_dims);
                             int sep_dim_size = !seperate_dims * sizeof(tex_source.dimensions);
 
+                            // Loads may reuse the buffers of the previous data
+                            preview_cache.invalidate();
+
                             switch (load_selected) {
 
                             case 0:
-                                if (raw) {
+                                if (raw || ktx) {
+                                    source_mapping.close();
+                                    source_view = texpress::TextureView{};
+                                }
+
+                                if (raw && load_mapped) {
+                                    // Texels stay in the page cache, tex_source only carries the metadata
+                                    if (texpress::load_raw_mapped(load_path, source_mapping, source_view)) {
+                                        tex_source.data.clear();
+                                        tex_source.data.shrink_to_fit();
+                                        tex_source.channels = source_view.channels;
+                                        tex_source.dimensions = source_view.dimensions;
+                                        tex_source.gl_internal = source_view.gl_internal;
+                                        tex_source.gl_format = source_view.gl_format;
+                                        tex_source.gl_type = source_view.gl_type;
+                                        tex_in = &tex_source;
+                                    }
+                                }
+                                else if (raw) {
                                     if (seperate_dims)
                                         texpress::file_read(path_dims.c_str(), (char*)&tex_source.dimensions.x, sizeof(tex_source.dimensions));
                                     else
                                         texpress::file_read(load_path, (char*)&tex_source.dimensions.x, sizeof(tex_source.dimensions));
 
                                     tex_source.channels = texpress::file_size(load_path) / ((uint64_t)tex_source.dimensions.x * (uint64_t)tex_source.dimensions.y * (uint64_t)tex_source.dimensions.z * (uint64_t)tex_source.dimensions.w * sizeof(float));
-                                    tex_source.gl_internal = texpress::gl_internal(tex_source.channels, 32, true);
+                                    tex_source.gl_internal = texpress::gl_internal(tex_source.channels, (half_precision) ? 16 : 32, true);
                                     tex_source.gl_format = texpress::gl_format(tex_source.channels);
-                                    tex_source.gl_type = gl::GLenum::GL_FLOAT;
-                                    tex_source.data.resize(texpress::file_size(load_path) - sep_dim_size);
-                                    texpress::file_read(load_path, (char*)tex_source.data.data(), tex_source.bytes(), sep_dim_size);
+                                    tex_source.gl_type = (half_precision) ? gl::GLenum::GL_HALF_FLOAT : gl::GLenum::GL_FLOAT;
+                                    if (half_precision) {
+                                        // Converted while reading, the floats are never resident
+                                        uint64_t values = (texpress::file_size(load_path) - sep_dim_size) / sizeof(float);
+                                        tex_source.data.resize(values * sizeof(uint16_t));
+                                        texpress::file_read_half(load_path, (uint16_t*)tex_source.data.data(), values, sep_dim_size);
+                                    }
+                                    else {
+                                        tex_source.data.resize(texpress::file_size(load_path) - sep_dim_size);
+                                        texpress::file_read(load_path, (char*)tex_source.data.data(), tex_source.bytes(), sep_dim_size);
+                                    }
                                     tex_in = &tex_source;
                                 }
                                 else if (ktx) {
@@ -966,7 +934,8 @@ struct update_pass : texpress::render_pass
 
                                 break;
                             }
-                        } ImGui::SameLine();
+                        }
+                        ImGui::EndDisabled(); ImGui::SameLine();
 
 
                         if (ImGui::Button("Close"))
@@ -975,16 +944,21 @@ struct update_pass : texpress::render_pass
                         ImGui::EndPopup();
                     }
 
+                    const texpress::TextureView reference = (source_mapping.is_open()) ? source_view : texpress::texture_view(tex_source);
                     if (ImGui::Button("Distance Error", { MaxButtonWidth, 0 })) {
-                        if (!tex_source.data.empty()) {
-                            distance_error(tex_source, tex_decoded, tex_error);
+                        texpress::ErrorStats stats;
+                        if (!reference.empty() && texpress::distance_error(reference, texpress::texture_view(tex_decoded), tex_error, &stats)) {
+                            log_error("Distance Error", stats);
+                            preview_cache.invalidate(&tex_error);
                             tex_out = &tex_error;
                         }
                     }
 
                     if (ImGui::Button("Component Error", { MaxButtonWidth, 0 })) {
-                        if (!tex_source.data.empty()) {
-                            component_error(tex_source, tex_decoded, tex_error);
+                        texpress::ErrorStats stats;
+                        if (!reference.empty() && texpress::component_error(reference, texpress::texture_view(tex_decoded), tex_error, &stats)) {
+                            log_error("Component Error", stats);
+                            preview_cache.invalidate(&tex_error);
                             tex_out = &tex_error;
                         }
                     }
@@ -1071,30 +1045,38 @@ struct update_pass : texpress::render_pass
                     ImGui::NewLine();
 
                     ImGui::Text("Data Buffers");
+                    ImGui::BeginDisabled(compress_task.valid());
                     if (ImGui::Button("Delete##source")) {
                         if (tex_in == &tex_source) { tex_in = nullptr; }
                         if (tex_out == &tex_source) { tex_out = nullptr; }
                         tex_source.data.clear();
                         tex_source.data.shrink_to_fit();
-                    } ImGui::SameLine();
-                    ImGui::Text("Source Field: "); ImGui::SameLine();
-                    ImGui::Text((std::to_string(tex_source.bytes() / (1024 * 1024)) + "MB").c_str());
+                        source_mapping.close();
+                        source_view = texpress::TextureView{};
+                    }
+                    ImGui::EndDisabled(); ImGui::SameLine();
+                    ImGui::Text((source_mapping.is_open()) ? "Source Field (mapped): " : "Source Field: "); ImGui::SameLine();
+                    ImGui::Text((std::to_string((tex_source.bytes() + source_view.bytes()) / (1024 * 1024)) + "MB").c_str());
 
+                    ImGui::BeginDisabled(compress_task.valid());
                     if (ImGui::Button("Delete##normalized")) {
                         if (tex_in == &tex_normalized) { tex_in = nullptr; }
                         if (tex_out == &tex_normalized) { tex_out = nullptr; }
                         tex_normalized.data.clear();
                         tex_normalized.data.shrink_to_fit();
-                    } ImGui::SameLine();
+                    }
+                    ImGui::EndDisabled(); ImGui::SameLine();
                     ImGui::Text("Normalized Field: "); ImGui::SameLine();
                     ImGui::Text((std::to_string(tex_normalized.bytes() / (1024 * 1024)) + "MB").c_str());
 
+                    ImGui::BeginDisabled(compress_task.valid());
                     if (ImGui::Button("Delete##encoded")) {
                         if (tex_in == &tex_encoded) { tex_in = nullptr; }
                         if (tex_out == &tex_encoded) { tex_out = nullptr; }
                         tex_encoded.data.clear();
                         tex_encoded.data.shrink_to_fit();
-                    } ImGui::SameLine();
+                    }
+                    ImGui::EndDisabled(); ImGui::SameLine();
                     ImGui::Text("Encoded Field: "); ImGui::SameLine();
                     ImGui::Text((std::to_string(tex_encoded.bytes() / (1024 * 1024)) + "MB").c_str());
 
@@ -1123,27 +1105,31 @@ struct update_pass : texpress::render_pass
                 {
                     ImGui::BeginChild("ChildBL", { ImGui::GetContentRegionAvail().x * 0.5f, ImGui::GetContentRegionAvail().y }, false, window_flags);
                     if (ImGui::CollapsingHeader("Source Data")) {
-                        if (gl_tex_in && tex_in) {
+                        if (tex_in) {
                             ImGui::Checkbox("Sync Sliders", &sync_sliders);
 
+                            // Mapped sources are uploaded straight from the mapping, only the shown slice is paged in
+                            texpress::TextureView view = (tex_in == &tex_source && source_mapping.is_open()) ? source_view : texpress::texture_view(*tex_in);
+
+                            ImGui::SameLine();
+                            if (ImGui::Button("Build Thumbnails##src")) {
+                                preview_cache.build_thumbnails(tex_in, view);
+                            }
+
                             uint64_t min = 0;
                             uint64_t max = (uint64_t)std::max(tex_in->dimensions.z * tex_in->dimensions.w - 1, 0);
                             ImGui::SliderScalar("Depth Slice##src", ImGuiDataType_U64, &depth_src, &min, &max);
+                            scrubbing_src = ImGui::IsItemActive();
 
-                            if (tex_in->compressed()) {
-                                uint64_t offset = depth_src * (uint64_t)tex_in->bytes() / ((uint64_t)tex_in->dimensions.z * (uint64_t)tex_in->dimensions.w * (uint64_t)tex_in->bytes_type());
-                                gl_tex_out->compressedImage2D(0, tex_in->gl_internal, glm::ivec2(tex_in->dimensions), 0, tex_in->bytes() / (tex_in->dimensions.z * tex_in->dimensions.w), tex_in->data.data() + offset);
-                            }
-                            else {
-                                uint64_t offset = depth_src * (uint64_t)tex_in->dimensions.x * (uint64_t)tex_in->dimensions.y * (uint64_t)tex_in->channels * (uint64_t)tex_in->bytes_type();
-                                gl_tex_in->image2D(0, tex_in->gl_internal, tex_in->dimensions, 0, tex_in->gl_format, tex_in->gl_type, tex_in->data.data() + offset);
-                            }
+                            // Thumbnails while the slider is dragged, the full slice is only uploaded once it rests
+                            const uint32_t preview_size = uint32_t(ImGui::GetContentRegionAvail().y * 0.5f);
+                            const texpress::PreviewSlice* preview = (scrubbing_src) ? preview_cache.thumbnail(tex_in, view, depth_src, preview_size) : preview_cache.get(tex_in, view, depth_src);
 
-                            ImTextureID texID = ImTextureID(gl_tex_in->id());
+                            ImTextureID texID = ImTextureID((preview) ? preview->id() : 0);
                             ImGui::Image(texID, ImVec2{ ImGui::GetContentRegionAvail().y * 0.5f, ImGui::GetContentRegionAvail().y * 0.5f }, ImVec2(0, 0), ImVec2(1, 1), ImVec4(1.0, 1.0, 1.0, 1.0), ImVec4(1.0, 1.0, 1.0, 1.0));
                             ImGui::SameLine();
                             ImGui::BeginGroup();
-                            ImGui::Text("Size: %i MB", (tex_in->bytes() / (1000 * 1000)));
+                            ImGui::Text("Size: %i MB", (view.bytes() / (1000 * 1000)));
                             ImGui::Text("Dimensions: %ix%ix%ix%i", tex_in->dimensions.x, tex_in->dimensions.y, tex_in->dimensions.z, tex_in->dimensions.w);
                             ImGui::Text("Channels: %i", tex_in->channels);
                             ImGui::EndGroup();
@@ -1157,34 +1143,37 @@ struct update_pass : texpress::render_pass
                 {
                     ImGui::BeginChild("ChildBR", { ImGui::GetContentRegionAvail().x, ImGui::GetContentRegionAvail().y }, false, window_flags);
                     if (ImGui::CollapsingHeader("Out Data")) {
-                        if (gl_tex_out && tex_out) {
+                        if (tex_out) {
                             ImGui::Checkbox("Sync Sliders", &sync_sliders);
 
+                            // Mapped sources are uploaded straight from the mapping, only the shown slice is paged in
+                            texpress::TextureView view = (tex_out == &tex_source && source_mapping.is_open()) ? source_view : texpress::texture_view(*tex_out);
+
+                            ImGui::SameLine();
+                            if (ImGui::Button("Build Thumbnails##enc")) {
+                                preview_cache.build_thumbnails(tex_out, view);
+                            }
+
                             uint64_t min = 0;
                             uint64_t max = (uint64_t)std::max(tex_out->dimensions.z * tex_out->dimensions.w - 1, 0);
                             ImGui::SliderScalar("Depth Slice##enc", ImGuiDataType_U64, (sync_sliders) ? &depth_src : &depth_enc, &min, &max);
+                            const bool scrubbing = ImGui::IsItemActive() || (sync_sliders && scrubbing_src);
 
                             if (sync_sliders) {
                                 depth_enc = depth_src;
                             }
 
-                            if (tex_out->compressed()) {
-                                uint64_t offset = depth_enc * (uint64_t)tex_out->bytes() / ((uint64_t)tex_out->dimensions.z * (uint64_t)tex_out->dimensions.w * (uint64_t)tex_out->bytes_type());
-                                gl_tex_out->compressedImage2D(0, tex_out->gl_internal, glm::ivec2(tex_out->dimensions), 0, tex_out->bytes() / (tex_out->dimensions.z * tex_out->dimensions.w), tex_out->data.data() + offset);
-                            }
-                            else {
-                                uint64_t offset = depth_enc * (uint64_t)tex_out->dimensions.x * (uint64_t)tex_out->dimensions.y * (uint64_t)tex_out->channels * (uint64_t)tex_out->bytes_type();
-                                gl_tex_out->image2D(0, tex_out->gl_internal, tex_out->dimensions, 0, tex_out->gl_format, tex_out->gl_type, tex_out->data.data() + offset);
-                            }
+                            const uint32_t preview_size = uint32_t(ImGui::GetContentRegionAvail().y * 0.5f);
+                            const texpress::PreviewSlice* preview = (scrubbing) ? preview_cache.thumbnail(tex_out, view, depth_enc, preview_size) : preview_cache.get(tex_out, view, depth_enc);
 
-                            ImTextureID texID = ImTextureID(gl_tex_out->id());
+                            ImTextureID texID = ImTextureID((preview) ? preview->id() : 0);
                             ImGui::Image(texID, ImVec2{ ImGui::GetContentRegionAvail().y * 0.5f, ImGui::GetContentRegionAvail().y * 0.5f }, ImVec2(0, 0), ImVec2(1, 1), ImVec4(1.0, 1.0, 1.0, 1.0), ImVec4(1.0, 1.0, 1.0, 1.0));
                             ImGui::SameLine();
                             ImGui::BeginGroup();
-                            ImGui::Text("Size: %i MB", (tex_out->bytes() / (1000 * 1000)));
+                            ImGui::Text("Size: %i MB", (view.bytes() / (1000 * 1000)));
                             ImGui::Text("Dimensions: %ix%ix%ix%i", tex_out->dimensions.x, tex_out->dimensions.y, tex_out->dimensions.z, tex_out->dimensions.w);
                             ImGui::Text("Channels: %i", tex_out->channels);
-                            ImGui::Text("Compression Ratio: %i%:1", tex_in->bytes() / std::max(tex_out->bytes(), 1ULL));
+                            ImGui::Text("Compression Ratio: %i%:1", ((tex_in == &tex_source) ? tex_source.bytes() + source_view.bytes() : tex_in->bytes()) / std::max(view.bytes(), 1ULL));
                             ImGui::EndGroup();
                         }
                     }
@@ -1204,6 +1193,8 @@ struct update_pass : texpress::render_pass
     HighFive::File* hdf5_file;
     texpress::HDF5Tree hdf5_structure;
     texpress::Texture tex_source;
+    texpress::MappedFile source_mapping;    // Backs tex_source instead of its data when a raw file is memory-mapped
+    texpress::TextureView source_view;
     texpress::Texture tex_normalized;
     texpress::Texture tex_encoded;
     texpress::Texture tex_decoded;
@@ -1211,8 +1202,7 @@ struct update_pass : texpress::render_pass
     texpress::Texture* tex_in;
     texpress::Texture* tex_out;
 
-    std::unique_ptr<globjects::Texture> gl_tex_in;
-    std::unique_ptr<globjects::Texture> gl_tex_out;
+    texpress::PreviewCache preview_cache;   // Resident slices of the Source and Out panels
 
     // UpdateLogic
     double MS_PER_UPDATE;
@@ -1246,17 +1236,18 @@ struct update_pass : texpress::render_pass
     uint64_t depth_enc;
     bool configuration_changed;
     bool sync_sliders;
+    bool scrubbing_src;                 // Source slider is dragged, previews show thumbnails meanwhile
 
     uint64_t image_level;
 
     std::vector<float> peaks;
-    glm::vec3 min;
-    glm::vec3 max;
+    bool half_precision;                // Load, normalize and decode to 16 bit halves instead of 32 bit floats
 
     float MaxButtonWidth;
 
     // Threads
     std::thread t_encoder;
+    texpress::CompressionTask compress_task;    // Running "Compress BC6H", inputs and tex_encoded must not change until it is finished
 };
 
 int main() {
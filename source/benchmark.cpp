@@ -0,0 +1,513 @@
+#include <texpress/compression/compressor.hpp>
+#include <texpress/helpers/ktxhelper.hpp>
+#include <texpress/helpers/vtkhelper.hpp>
+#include <texpress/io/hdf_io.hpp>
+#include <texpress/utility/error_metrics.hpp>
+#include <texpress/utility/normalize.hpp>
+#include <texpress/utility/normalizer.hpp>
+#include <texpress/utility/stringtools.hpp>
+#include <texpress/utility/synthetic.hpp>
+#include <spdlog/spdlog.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <ctime>
+#include <filesystem>
+#include <functional>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Throughput of the compression pipeline on synthetic ABC fields, written to JSON for tracking regressions.
+// Usage: texpress_benchmark [flags]
+// Every benchmark runs warmup + repetitions times on the same input, files are written to and read from a new directory
+// inside the scratch directory, so IO numbers are taken with a warm page cache.
+
+namespace {
+    typedef std::chrono::steady_clock Clock;
+
+    struct BenchmarkSettings {
+        glm::ivec4 size = glm::ivec4(128, 128, 32, 4);      // Extent of the ABC field
+        uint32_t repetitions = 5;
+        uint32_t warmup = 1;
+        uint32_t threads = 0;                               // Worker threads of all parallel stages, 0 uses all hardware threads
+        std::vector<texpress::EncoderBackend> backends = { texpress::EncoderBackend::BACKEND_NATIVE };
+        std::vector<nvtt::Quality> qualities = { nvtt::Quality_Fastest, nvtt::Quality_Normal };
+        std::string filter;                                 // Only benchmarks whose name contains it
+        std::string output = "benchmark.json";
+        std::string scratch;                                // Parent of the directory the IO benchmarks create and remove again
+    };
+
+    struct BenchmarkResult {
+        std::string name;
+        uint64_t bytes = 0;                                 // Bytes processed per run, see throughput
+        uint64_t voxels = 0;
+        std::vector<double> seconds;
+        bool success = true;
+
+        double min() const { return *std::min_element(seconds.begin(), seconds.end()); }
+        double mean() const {
+            double sum = 0.0;
+            for (double s : seconds) sum += s;
+            return sum / seconds.size();
+        }
+        double median() const {
+            std::vector<double> sorted = seconds;
+            std::sort(sorted.begin(), sorted.end());
+            const uint64_t n = sorted.size();
+            return (n % 2) ? sorted[n / 2] : 0.5 * (sorted[n / 2 - 1] + sorted[n / 2]);
+        }
+        double stddev() const {
+            const double m = mean();
+            double sum = 0.0;
+            for (double s : seconds) sum += (s - m) * (s - m);
+            return std::sqrt(sum / seconds.size());
+        }
+    };
+
+    const char* backend_name(texpress::EncoderBackend backend) {
+        return (backend == texpress::EncoderBackend::BACKEND_NVTT) ? "nvtt" : "native";
+    }
+
+    const char* quality_name(nvtt::Quality quality) {
+        switch (quality) {
+        case nvtt::Quality_Fastest: return "fastest";
+        case nvtt::Quality_Normal: return "normal";
+        case nvtt::Quality_Production: return "production";
+        case nvtt::Quality_Highest: return "highest";
+        }
+        return "unknown";
+    }
+
+    class Runner {
+    public:
+        explicit Runner(const BenchmarkSettings& settings) : settings(settings) {}
+
+        // Times body; bytes and voxels are what a single run processes. Failed runs are reported but not timed further.
+        void run(const std::string& name, uint64_t bytes, uint64_t voxels, const std::function<bool()>& body) {
+            if (!settings.filter.empty() && name.find(settings.filter) == std::string::npos)
+                return;
+
+            BenchmarkResult result;
+            result.name = name;
+            result.bytes = bytes;
+            result.voxels = voxels;
+
+            for (uint32_t i = 0; i < settings.warmup + settings.repetitions; i++) {
+                auto t0 = Clock::now();
+                bool success = body();
+                double seconds = std::chrono::duration<double>(Clock::now() - t0).count();
+
+                if (!success) {
+                    spdlog::error("Benchmark " + name + " failed");
+                    result.success = false;
+                    result.seconds.assign(1, seconds);
+                    break;
+                }
+
+                if (i >= settings.warmup) {
+                    result.seconds.push_back(seconds);
+                }
+            }
+
+            const double median = result.median();
+            printf("%-40s %10.4f %10.4f %12.1f %14.0f%s\n", name.c_str(), median, result.min(),
+                bytes / 1e6 / median, voxels / median, (result.success) ? "" : "  failed");
+            fflush(stdout);
+
+            results.push_back(result);
+        }
+
+        const std::vector<BenchmarkResult>& get() const { return results; }
+
+    private:
+        const BenchmarkSettings& settings;
+        std::vector<BenchmarkResult> results;
+    };
+
+    bool parse_ivec4(const std::string& list, glm::ivec4& value) {
+        std::stringstream stream(list);
+        std::string item;
+        int i = 0;
+        while (std::getline(stream, item, ',') && i < 4) {
+            value[i++] = std::stoi(item);
+        }
+        return i == 4;
+    }
+
+    bool parse_args(int argc, char** argv, BenchmarkSettings& settings) {
+        for (int i = 1; i < argc; i++) {
+            const std::string flag = argv[i];
+            const bool has_value = i + 1 < argc;
+
+            try {
+                if (flag == "--size" && has_value) {
+                    if (!parse_ivec4(argv[++i], settings.size) || settings.size.x < 1 || settings.size.y < 1 || settings.size.z < 1 || settings.size.w < 1) {
+                        spdlog::error("--size needs four positive extents x,y,z,t");
+                        return false;
+                    }
+                }
+                else if (flag == "--repetitions" && has_value) {
+                    settings.repetitions = std::max(std::stoul(argv[++i]), 1ul);
+                }
+                else if (flag == "--warmup" && has_value) {
+                    settings.warmup = std::stoul(argv[++i]);
+                }
+                else if (flag == "--threads" && has_value) {
+                    settings.threads = std::stoul(argv[++i]);
+                }
+                else if (flag == "--backend" && has_value) {
+                    settings.backends.clear();
+                    std::stringstream stream(argv[++i]);
+                    std::string item;
+                    while (std::getline(stream, item, ',')) {
+                        if (item == "nvtt")
+                            settings.backends.push_back(texpress::EncoderBackend::BACKEND_NVTT);
+                        else if (item == "native")
+                            settings.backends.push_back(texpress::EncoderBackend::BACKEND_NATIVE);
+                        else {
+                            spdlog::error("Unknown backend " + item);
+                            return false;
+                        }
+                    }
+                }
+                else if (flag == "--quality" && has_value) {
+                    settings.qualities.clear();
+                    std::stringstream stream(argv[++i]);
+                    std::string item;
+                    while (std::getline(stream, item, ',')) {
+                        if (item == "fastest")
+                            settings.qualities.push_back(nvtt::Quality_Fastest);
+                        else if (item == "normal")
+                            settings.qualities.push_back(nvtt::Quality_Normal);
+                        else if (item == "production")
+                            settings.qualities.push_back(nvtt::Quality_Production);
+                        else if (item == "highest")
+                            settings.qualities.push_back(nvtt::Quality_Highest);
+                        else {
+                            spdlog::error("Unknown quality " + item);
+                            return false;
+                        }
+                    }
+                }
+                else if (flag == "--filter" && has_value) {
+                    settings.filter = argv[++i];
+                }
+                else if ((flag == "-o" || flag == "--output") && has_value) {
+                    settings.output = argv[++i];
+                }
+                else if (flag == "--scratch" && has_value) {
+                    settings.scratch = argv[++i];
+                }
+                else {
+                    spdlog::error("Unknown flag " + flag);
+                    return false;
+                }
+            }
+            catch (const std::exception&) {
+                spdlog::error("Invalid value " + std::string(argv[i]) + " of " + flag);
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    void print_usage() {
+        printf("Usage: texpress_benchmark [flags]\n\n");
+        printf("  --size <x,y,z,t>           extent of the synthetic ABC field (default 128,128,32,4)\n");
+        printf("  --repetitions <n>          timed runs per benchmark (default 5)\n");
+        printf("  --warmup <n>               untimed runs before them (default 1)\n");
+        printf("  --threads <n>              threads of all parallel stages, 0 uses all hardware threads\n");
+        printf("  --backend <a,b>            encoder backends, nvtt and/or native (default native)\n");
+        printf("  --quality <a,b>            fastest, normal, production and/or highest (default fastest,normal)\n");
+        printf("  --filter <text>            only benchmarks whose name contains text\n");
+        printf("  -o, --output <path>        JSON results (default benchmark.json)\n");
+        printf("  --scratch <dir>            the IO benchmarks write into a new subdirectory of dir, removed afterwards\n");
+        printf("  -h, --help                 this message\n");
+    }
+
+    // Google Benchmark like layout: a context object and one entry per benchmark
+    bool save_json(const char* path, const BenchmarkSettings& settings, const texpress::Texture& field, const std::vector<BenchmarkResult>& results) {
+        FILE* file = fopen(path, "w");
+        if (!file) {
+            spdlog::error("Could not write " + std::string(path));
+            return false;
+        }
+
+        char date[64];
+        std::time_t now = std::time(nullptr);
+        std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", std::localtime(&now));
+
+#if defined(__AVX2__)
+        const bool avx2 = true;
+#else
+        const bool avx2 = false;
+#endif
+#if defined(NDEBUG)
+        const char* build = "release";
+#else
+        const char* build = "debug";
+#endif
+
+        fprintf(file, "{\n  \"context\": {\n");
+        fprintf(file, "    \"date\": \"%s\",\n", date);
+        fprintf(file, "    \"build\": \"%s\",\n", build);
+        fprintf(file, "    \"avx2\": %s,\n", (avx2) ? "true" : "false");
+        fprintf(file, "    \"hardware_threads\": %u,\n", std::thread::hardware_concurrency());
+        fprintf(file, "    \"threads\": %u,\n", settings.threads);
+        fprintf(file, "    \"repetitions\": %u,\n", settings.repetitions);
+        fprintf(file, "    \"warmup\": %u,\n", settings.warmup);
+        fprintf(file, "    \"input\": \"abc\",\n");
+        fprintf(file, "    \"dimensions\": [%d, %d, %d, %d],\n", field.dimensions.x, field.dimensions.y, field.dimensions.z, field.dimensions.w);
+        fprintf(file, "    \"channels\": %d,\n", field.channels);
+        fprintf(file, "    \"bytes\": %llu\n", (unsigned long long)field.bytes());
+        fprintf(file, "  },\n  \"benchmarks\": [\n");
+
+        for (uint64_t i = 0; i < results.size(); i++) {
+            const auto& result = results[i];
+            const double median = result.median();
+
+            fprintf(file, "    {\n");
+            fprintf(file, "      \"name\": \"%s\",\n", result.name.c_str());
+            fprintf(file, "      \"success\": %s,\n", (result.success) ? "true" : "false");
+            fprintf(file, "      \"runs\": %llu,\n", (unsigned long long)result.seconds.size());
+            fprintf(file, "      \"bytes\": %llu,\n", (unsigned long long)result.bytes);
+            fprintf(file, "      \"voxels\": %llu,\n", (unsigned long long)result.voxels);
+            fprintf(file, "      \"seconds_median\": %.9g,\n", median);
+            fprintf(file, "      \"seconds_min\": %.9g,\n", result.min());
+            fprintf(file, "      \"seconds_mean\": %.9g,\n", result.mean());
+            fprintf(file, "      \"seconds_stddev\": %.9g,\n", result.stddev());
+            fprintf(file, "      \"mb_per_second\": %.9g,\n", result.bytes / 1e6 / median);
+            fprintf(file, "      \"voxels_per_second\": %.9g\n", result.voxels / median);
+            fprintf(file, "    }%s\n", (i + 1 < results.size()) ? "," : "");
+        }
+
+        fprintf(file, "  ]\n}\n");
+        fclose(file);
+        return true;
+    }
+
+    // Components of an interleaved float field as (t, z, y, x) datasets /u, /v, /w, the layout read_datasets expects
+    bool save_hdf5(const std::string& path, const texpress::Texture& field) {
+        try {
+            HighFive::File file(path, HighFive::File::Overwrite);
+            const uint64_t voxels = field.bytes() / (field.channels * sizeof(float));
+            const float* values = (const float*)field.data.data();
+            const std::vector<size_t> shape = { (size_t)field.dimensions.w, (size_t)field.dimensions.z, (size_t)field.dimensions.y, (size_t)field.dimensions.x };
+            const char* names[3] = { "/u", "/v", "/w" };
+
+            std::vector<float> component(voxels);
+            for (uint8_t c = 0; c < field.channels; c++) {
+                for (uint64_t i = 0; i < voxels; i++) {
+                    component[i] = values[i * field.channels + c];
+                }
+
+                auto dataset = file.createDataSet<float>(names[c], HighFive::DataSpace(shape));
+                dataset.write_raw(component.data());
+            }
+        }
+        catch (const std::exception& e) {
+            spdlog::error("Could not write " + path + ": " + e.what());
+            return false;
+        }
+
+        return true;
+    }
+}
+
+int main(int argc, char** argv) {
+    for (int i = 1; i < argc; i++) {
+        if (std::string(argv[i]) == "-h" || std::string(argv[i]) == "--help") {
+            print_usage();
+            return 0;
+        }
+    }
+
+    BenchmarkSettings settings;
+    if (!parse_args(argc, argv, settings)) {
+        print_usage();
+        return 1;
+    }
+
+    if (settings.scratch.empty()) {
+        settings.scratch = std::filesystem::temp_directory_path().string();
+    }
+
+    // Only a directory created here is removed at the end, never the given one or anything that existed before
+    std::filesystem::path scratch;
+    try {
+        std::filesystem::create_directories(settings.scratch);
+        for (uint32_t i = 0; scratch.empty() && i < 1000; i++) {
+            std::filesystem::path candidate = std::filesystem::path(settings.scratch) / ("texpress_benchmark_" + std::to_string(i));
+            if (std::filesystem::create_directory(candidate))
+                scratch = candidate;
+        }
+    }
+    catch (const std::exception& e) {
+        spdlog::error("Could not create a scratch directory in " + settings.scratch + ": " + e.what());
+        return 1;
+    }
+
+    if (scratch.empty()) {
+        spdlog::error("Could not create a scratch directory in " + settings.scratch);
+        return 1;
+    }
+
+    // The generated field is centered in x and z like the GUI default
+    texpress::ABCSettings abc;
+    abc.begin = glm::ivec4(-settings.size.x / 2, 0, -settings.size.z / 2, 0);
+    abc.end = glm::ivec4(abc.begin.x + settings.size.x, settings.size.y, abc.begin.z + settings.size.z, settings.size.w);
+    abc.threads = settings.threads;
+
+    texpress::Texture field;
+    if (!texpress::generate_abc(abc, field)) {
+        return 1;
+    }
+
+    const uint64_t voxels = (uint64_t)field.dimensions.x * (uint64_t)field.dimensions.y * (uint64_t)field.dimensions.z * (uint64_t)field.dimensions.w;
+    const uint64_t slices = (uint64_t)field.dimensions.z * (uint64_t)field.dimensions.w;
+
+    printf("ABC field %dx%dx%dx%d, %.1f MB, %u repetitions\n\n", field.dimensions.x, field.dimensions.y, field.dimensions.z, field.dimensions.w,
+        field.bytes() / 1e6, settings.repetitions);
+    printf("%-40s %10s %10s %12s %14s\n", "benchmark", "median s", "min s", "MB/s", "voxels/s");
+
+    Runner runner(settings);
+
+    // Synthetic input
+    texpress::Texture generated;
+    runner.run("synthetic/abc", field.bytes(), voxels, [&]() {
+        return texpress::generate_abc(abc, generated);
+    });
+    generated = texpress::Texture();
+
+    // Peaks
+    std::vector<float> peaks;
+    runner.run("peaks/find_peaks_per_component", field.bytes(), voxels, [&]() {
+        peaks = texpress::find_peaks_per_component((const float*)field.data.data(), field.dimensions, field.channels);
+        return !peaks.empty();
+    });
+
+    runner.run("peaks/find_peaks_parallel", field.bytes(), voxels, [&]() {
+        return texpress::find_peaks_parallel((const float*)field.data.data(), field.dimensions, field.channels, peaks, settings.threads);
+    });
+
+    // Compression, the last encoded volume is kept for decompression
+    texpress::EncoderData input{};
+    texpress::Encoder::populate_EncoderData(input, field);
+    const texpress::Encoder encoder;
+
+    texpress::Texture encoded;
+    texpress::EncoderData output{};
+
+    int progress = 0;
+    for (auto backend : settings.backends) {
+        for (auto quality : settings.qualities) {
+            texpress::EncoderSettings encoder_settings;
+            encoder_settings.backend = backend;
+            encoder_settings.quality = quality;
+            encoder_settings.encoding = nvtt::Format_BC6S;
+            encoder_settings.threads = settings.threads;
+            encoder_settings.progress_ptr = &progress;
+
+            texpress::Encoder::initialize_buffer(encoded.data, encoder_settings, input);
+            texpress::Encoder::populate_EncoderData(output, encoded);
+
+            runner.run(std::string("compress/") + backend_name(backend) + "/" + quality_name(quality), field.bytes(), voxels, [&]() {
+                return encoder.compress(encoder_settings, input, output);
+            });
+
+            texpress::Encoder::populate_Texture(encoded, output);
+        }
+    }
+
+    // Decompression
+    texpress::Texture decoded;
+    if (!encoded.data.empty() && encoded.compressed()) {
+        texpress::EncoderData encoded_data{};
+        texpress::Encoder::populate_EncoderData(encoded_data, encoded);
+
+        texpress::EncoderData decoded_data{};
+        decoded_data.data_bytes = texpress::Encoder::decoded_size(encoded_data, true, false);
+        decoded_data.gl_internal = (uint32_t)texpress::gl_internal(field.channels, 32, true);
+        decoded.data.resize(decoded_data.data_bytes);
+        decoded_data.data_ptr = decoded.data.data();
+
+        // decompress appends every slice and advances the output, so each run starts from a fresh copy
+        runner.run("decompress/slice", decoded.bytes(), voxels, [&]() {
+            texpress::EncoderData slice_data = decoded_data;
+            for (uint64_t slice = 0; slice < slices; slice++) {
+                if (!encoder.decompress(encoded_data, slice_data, slice))
+                    return false;
+            }
+            return true;
+        });
+
+        texpress::DecompressSettings decompress_settings;
+        decompress_settings.threads = settings.threads;
+        runner.run("decompress/volume", decoded.bytes(), voxels, [&]() {
+            return encoder.decompress_volume(decompress_settings, encoded_data, decoded_data);
+        });
+
+        texpress::Encoder::populate_Texture(decoded, decoded_data);
+    }
+
+    // Error metrics of the last encoding
+    if (!decoded.data.empty()) {
+        texpress::Texture error;
+        texpress::ErrorStats stats;
+        runner.run("error/component", field.bytes(), voxels, [&]() {
+            return texpress::component_error(field, decoded, error, &stats, settings.threads);
+        });
+
+        runner.run("error/distance", field.bytes(), voxels, [&]() {
+            return texpress::distance_error(field, decoded, error, &stats, settings.threads);
+        });
+    }
+
+    // IO with a warm page cache
+    if (!encoded.data.empty()) {
+        // save_ktx lowercases the path
+        const std::string path_ktx = texpress::str_lowercase((scratch / "abc_encoded.ktx").string());
+        runner.run("io/save_ktx", encoded.bytes(), voxels, [&]() {
+            return texpress::save_ktx(encoded, path_ktx.c_str(), false, true);
+        });
+
+        texpress::Texture loaded;
+        runner.run("io/load_ktx", encoded.bytes(), voxels, [&]() {
+            texpress::load_ktx(path_ktx.c_str(), loaded);
+            return loaded.bytes() == encoded.bytes();
+        });
+    }
+
+    const std::string path_vtk = (scratch / "abc.vtk").string();
+    runner.run("io/save_vtk", field.bytes(), voxels, [&]() {
+        return texpress::save_vtk(path_vtk.c_str(), "ABC", field);
+    });
+
+    const std::string path_hdf5 = (scratch / "abc.h5").string();
+    if (save_hdf5(path_hdf5, field)) {
+        std::vector<uint8_t> buffer;
+        runner.run("io/read_datasets", field.bytes(), voxels, [&]() {
+            texpress::hdf5 file(path_hdf5.c_str());
+            return file.read_datasets<float>({ "/u", "/v", "/w" }, {}, {}, {}, buffer) && buffer.size() == field.bytes();
+        });
+    }
+
+    std::error_code ec;
+    std::filesystem::remove_all(scratch, ec);
+
+    printf("\n");
+    if (!save_json(settings.output.c_str(), settings, field, runner.get()))
+        return 1;
+
+    printf("Results written to %s\n", settings.output.c_str());
+
+    for (const auto& result : runner.get()) {
+        if (!result.success)
+            return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,251 @@
+#include <texpress/compression/batch.hpp>
+#include <texpress/compression/pipeline.hpp>
+#include <texpress/core/trace.hpp>
+#include <spdlog/spdlog.h>
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+
+// Headless front end of the compression pipeline, shares everything but the GUI with the texpress executable.
+// Usage: texpress_cli [flags]
+//        texpress_cli --job <file> [flags]    runs every line of file, flags given here apply to all jobs
+//        texpress_cli --batch <pattern> [flags]   runs the same flags on many files concurrently
+
+namespace {
+    void print_usage() {
+        printf("Usage: texpress_cli [flags]\n");
+        printf("       texpress_cli --job <file> [flags]\n");
+        printf("       texpress_cli --batch <pattern> [--batch <pattern> ...] [batch flags] [flags]\n\n");
+        printf("  --job <file>               one job per line, given as flags; command line flags apply to all jobs\n");
+        printf("  --trace <path>             write a Chrome trace (JSON) of all stages and print time and throughput per stage\n");
+        printf("  -h, --help                 this message\n\n");
+        printf("Batch:\n");
+        printf("  --batch <pattern>          input file or pattern with * and ?, may be repeated\n");
+        printf("  --batch-list <file>        input files or patterns, one per line\n");
+        printf("  --output-dir <dir>         compressed files are written as <dir>/<stem>.ktx\n");
+        printf("  --output-format <format>   ktx or raw\n");
+        printf("  --save-decoded             also write <dir>/<stem>_decoded.<format>\n");
+        printf("  --save-error               also write <dir>/<stem>_error.raw\n");
+        printf("  --jobs <n>                 files processed concurrently, 0 uses all hardware threads\n");
+        printf("  --memory-budget <MB>       estimated memory of all running files, 0 is unlimited\n\n");
+        printf("Pipeline:\n");
+        printf("%s", texpress::pipeline_usage());
+    }
+
+    void print_stats(const std::string& input, const texpress::PipelineSettings& settings, const texpress::PipelineStats& stats) {
+        printf("%s: %s\n", input.c_str(), (stats.success) ? "done" : "failed");
+        if (!stats.success)
+            return;
+
+        if (stats.bytes_compressed) {
+            printf("  size       %llu -> %llu bytes", (unsigned long long)stats.bytes_source, (unsigned long long)stats.bytes_compressed);
+            if (stats.bytes_source)
+                printf(" (%.2f : 1)", (double)stats.bytes_source / (double)stats.bytes_compressed);
+            printf("\n");
+        }
+
+        printf("  seconds    load %.3f, normalize %.3f, compress %.3f, decompress %.3f, error %.3f, save %.3f\n",
+            stats.seconds_load, stats.seconds_normalize, stats.seconds_compress, stats.seconds_decompress, stats.seconds_error, stats.seconds_save);
+
+        if (settings.error && stats.error.texels) {
+            printf("  error      rms %g, psnr %.2f dB, max distance %g\n", stats.error.rms_total, stats.error.psnr_total, stats.error.distance_max);
+            for (int c = 0; c < stats.error.channels; c++) {
+                printf("  channel %d  mean %g, rms %g, max %g, psnr %.2f dB\n", c, stats.error.mean[c], stats.error.rms[c], stats.error.max[c], stats.error.psnr[c]);
+            }
+        }
+    }
+
+    // Consumes the batch flags, everything else is left for parse_pipeline_args
+    bool parse_batch_args(std::vector<std::string>& args, texpress::BatchSettings& settings) {
+        std::vector<std::string> rest;
+
+        for (uint64_t i = 0; i < args.size(); i++) {
+            const std::string& flag = args[i];
+            const bool has_value = i + 1 < args.size();
+
+            try {
+                if (flag == "--batch" && has_value) {
+                    settings.inputs.push_back(args[++i]);
+                }
+                else if (flag == "--batch-list" && has_value) {
+                    std::ifstream file(args[++i]);
+                    if (!file.is_open()) {
+                        spdlog::error("Input list " + args[i] + " could not be opened");
+                        return false;
+                    }
+
+                    std::string line;
+                    while (std::getline(file, line)) {
+                        auto args_line = texpress::split_args(line);
+                        if (!args_line.empty() && args_line[0][0] != '#')
+                            settings.inputs.push_back(args_line[0]);
+                    }
+                }
+                else if (flag == "--output-dir" && has_value) {
+                    settings.output_dir = args[++i];
+                }
+                else if (flag == "--output-format" && has_value) {
+                    settings.output_extension = "." + args[++i];
+                }
+                else if (flag == "--save-decoded") {
+                    settings.save_decoded = true;
+                }
+                else if (flag == "--save-error") {
+                    settings.save_error = true;
+                }
+                else if (flag == "--jobs" && has_value) {
+                    settings.jobs = std::stoul(args[++i]);
+                }
+                else if (flag == "--memory-budget" && has_value) {
+                    settings.memory_budget = std::stoull(args[++i]) << 20;
+                }
+                else {
+                    rest.push_back(flag);
+                }
+            }
+            catch (const std::exception&) {
+                spdlog::error("Invalid value " + args[i] + " of " + flag);
+                return false;
+            }
+        }
+
+        args = rest;
+        return true;
+    }
+
+    int run_batch(std::vector<std::string>& args) {
+        texpress::BatchSettings settings;
+        if (!parse_batch_args(args, settings) || !texpress::parse_pipeline_args(args, settings.pipeline)) {
+            print_usage();
+            return 1;
+        }
+
+        std::vector<texpress::BatchResult> results;
+        texpress::batch_compress(settings, results);
+
+        // Per file summary
+        uint64_t failed = 0;
+        printf("%-40s %8s %12s %12s %10s %10s\n", "input", "status", "source MB", "encoded MB", "seconds", "psnr dB");
+        for (const auto& result : results) {
+            const auto& stats = result.stats;
+            double seconds = stats.seconds_load + stats.seconds_normalize + stats.seconds_compress + stats.seconds_decompress + stats.seconds_error + stats.seconds_save;
+
+            printf("%-40s %8s %12.2f %12.2f %10.3f", result.input.c_str(), (stats.success) ? "done" : "failed",
+                stats.bytes_source / 1048576.0, stats.bytes_compressed / 1048576.0, seconds);
+            if (stats.success && settings.pipeline.error && stats.error.texels)
+                printf(" %10.2f", stats.error.psnr_total);
+            printf("\n");
+
+            if (!stats.success)
+                failed++;
+        }
+        printf("%llu of %llu files succeeded\n", (unsigned long long)(results.size() - failed), (unsigned long long)results.size());
+
+        return (failed || results.empty()) ? 1 : 0;
+    }
+
+    int finish_trace(const std::string& path, int exit_code) {
+        if (path.empty())
+            return exit_code;
+
+        texpress::trace_enable(false);
+        printf("\n%s", texpress::trace_summary_table(texpress::trace_summary()).c_str());
+
+        if (!texpress::save_trace(path.c_str()))
+            return 1;
+
+        printf("Trace written to %s\n", path.c_str());
+        return exit_code;
+    }
+}
+
+int main(int argc, char** argv) {
+    std::vector<std::string> args;
+    std::string job_path;
+    std::string trace_path;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "-h" || arg == "--help") {
+            print_usage();
+            return 0;
+        }
+
+        if (arg == "--job") {
+            if (i + 1 >= argc) {
+                spdlog::error("Missing value of --job");
+                return 1;
+            }
+            job_path = argv[++i];
+            continue;
+        }
+
+        if (arg == "--trace") {
+            if (i + 1 >= argc) {
+                spdlog::error("Missing value of --trace");
+                return 1;
+            }
+            trace_path = argv[++i];
+            continue;
+        }
+
+        args.push_back(arg);
+    }
+
+    if (args.empty() && job_path.empty()) {
+        print_usage();
+        return 1;
+    }
+
+    if (!trace_path.empty()) {
+        texpress::trace_enable();
+    }
+
+    if (std::find(args.begin(), args.end(), "--batch") != args.end() || std::find(args.begin(), args.end(), "--batch-list") != args.end()) {
+        return finish_trace(trace_path, run_batch(args));
+    }
+
+    // Every job line is appended to the common flags, so a line can override them
+    std::vector<std::vector<std::string>> jobs;
+    if (!job_path.empty()) {
+        if (!texpress::read_job_file(job_path.c_str(), jobs))
+            return 1;
+    }
+    else {
+        jobs.push_back({});
+    }
+
+    int failed = 0;
+    for (const auto& job : jobs) {
+        std::vector<std::string> job_args = args;
+        job_args.insert(job_args.end(), job.begin(), job.end());
+
+        texpress::PipelineSettings settings;
+        if (!texpress::parse_pipeline_args(job_args, settings)) {
+            print_usage();
+            failed++;
+            continue;
+        }
+
+        if (settings.input_path.empty()) {
+            spdlog::error("No input given");
+            failed++;
+            continue;
+        }
+
+        texpress::PipelineStats stats;
+        texpress::run_pipeline(settings, &stats);
+        print_stats(settings.input_path, settings, stats);
+
+        if (!stats.success)
+            failed++;
+    }
+
+    if (jobs.size() > 1) {
+        printf("%llu of %llu jobs succeeded\n", (unsigned long long)(jobs.size() - failed), (unsigned long long)jobs.size());
+    }
+
+    return finish_trace(trace_path, (failed) ? 1 : 0);
+}
@@ -0,0 +1,90 @@
+#include <texpress/compression/async.hpp>
+
+namespace texpress {
+    bool CompressionTask::ready() const {
+        return valid() && result.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+    }
+
+    void CompressionTask::wait() const {
+        if (valid())
+            result.wait();
+    }
+
+    bool CompressionTask::get() const {
+        return valid() && result.get();
+    }
+
+    void CompressionTask::cancel() {
+        if (valid())
+            state->cancel = true;
+    }
+
+    bool CompressionTask::cancelled() const {
+        return valid() && state->cancel;
+    }
+
+    CompressionProgress CompressionTask::progress() const {
+        if (!valid())
+            return CompressionProgress{};
+
+        std::lock_guard<std::mutex> lock(state->mutex);
+        CompressionProgress progress = state->latest;
+        if (!ready()) {
+            progress.seconds_elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - state->start).count();
+        }
+        return progress;
+    }
+
+    CompressionTask compress_async(const EncoderSettings& settings, const EncoderData& input, const EncoderData& output, CompressionCallback callback) {
+        CompressionTask task;
+        task.state = std::make_shared<CompressionTask::State>();
+        task.state->output = output;
+        task.state->start = std::chrono::steady_clock::now();
+
+        // The thread shares the state with the handles, the last handle still waits for it through the future
+        auto state = task.state;
+        EncoderSettings task_settings = settings;
+        task_settings.cancel_ptr = &state->cancel;
+        task_settings.progress_callback = [state, callback](uint64_t done, uint64_t total) {
+            CompressionProgress progress;
+            progress.bytes_done = done;
+            progress.bytes_total = total;
+            progress.fraction = (total) ? float((double)done / (double)total) : 0.0f;
+            progress.seconds_elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - state->start).count();
+            if (done) {
+                progress.seconds_remaining = progress.seconds_elapsed * (double)(total - done) / (double)done;
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(state->mutex);
+                state->latest = progress;
+            }
+
+            if (callback) {
+                callback(progress);
+            }
+        };
+
+        task.result = std::async(std::launch::async, [state, task_settings, input]() mutable {
+            // Console progress of the encoder is replaced by the callback
+            int encoder_progress = 0;
+            task_settings.progress_ptr = &encoder_progress;
+
+            const Encoder encoder;
+            bool success = encoder.compress(task_settings, input, state->output);
+
+            // Final timing, also if nothing was reported
+            std::lock_guard<std::mutex> lock(state->mutex);
+            state->latest.seconds_elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - state->start).count();
+            if (success) {
+                state->latest.bytes_done = state->latest.bytes_total;
+                state->latest.fraction = 1.0f;
+                state->latest.seconds_remaining = 0.0;
+            }
+
+            return success;
+        }).share();
+
+        return task;
+    }
+}
@@ -0,0 +1,370 @@
+#include <texpress/compression/batch.hpp>
+#include <texpress/core/trace.hpp>
+#include <spdlog/spdlog.h>
+#include <texpress/helpers/threadhelper.hpp>
+#include <texpress/io/file_io.hpp>
+#include <texpress/utility/stringtools.hpp>
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <filesystem>
+#include <map>
+#include <mutex>
+
+namespace texpress {
+    namespace {
+        // Wildcard match of a file name, * matches any sequence and ? a single character
+        bool wildcard_match(const char* pattern, const char* name) {
+            const char* star = nullptr;
+            const char* resume = nullptr;
+
+            while (*name) {
+                if (*pattern == '?' || *pattern == *name) {
+                    pattern++;
+                    name++;
+                }
+                else if (*pattern == '*') {
+                    star = pattern++;
+                    resume = name;
+                }
+                else if (star) {
+                    pattern = star + 1;
+                    name = ++resume;
+                }
+                else {
+                    return false;
+                }
+            }
+
+            while (*pattern == '*') {
+                pattern++;
+            }
+
+            return !*pattern;
+        }
+
+        // Texels and channels of an input without reading its data, false if unknown
+        bool input_extent(const PipelineSettings& settings, uint64_t& texels, uint64_t& channels, bool& compressed) {
+            const std::string& path = settings.input_path;
+            auto ext = str_lowercase(std::filesystem::path(path).extension().string());
+            compressed = false;
+
+            if (ext == ".h5" || ext == ".hdf5" || ext == ".hdf") {
+                if (settings.datasets.empty())
+                    return false;
+
+                hdf5 file(path.c_str());
+                auto dims = file.region_dimensions(settings.datasets[0].c_str(), settings.region);
+                if (dims.empty())
+                    return false;
+
+                texels = 1;
+                for (auto d : dims) {
+                    texels *= d;
+                }
+                channels = settings.datasets.size();
+                return true;
+            }
+
+            if (ext == ".raw") {
+                glm::ivec4 dims(0);
+                auto path_dims = std::filesystem::path(path).replace_extension("").string() + "_dims" + std::filesystem::path(path).extension().string();
+                uint64_t header_bytes = 0;
+
+                if (std::filesystem::exists(path_dims)) {
+                    file_read(path_dims.c_str(), (char*)&dims.x, sizeof(dims));
+                }
+                else {
+                    file_read(path.c_str(), (char*)&dims.x, sizeof(dims));
+                    header_bytes = sizeof(dims);
+                }
+
+                texels = (uint64_t)std::max(dims.x, 0) * (uint64_t)std::max(dims.y, 0) * (uint64_t)std::max(dims.z, 0) * (uint64_t)std::max(dims.w, 0);
+                if (!texels)
+                    return false;
+
+                channels = std::max<uint64_t>((file_size(path.c_str()) - header_bytes) / sizeof(float) / texels, 1);
+                return true;
+            }
+
+            if (ext == ".ktx") {
+                // BC6H stores one byte per texel, the header is negligible
+                texels = file_size(path.c_str());
+                channels = 3;
+                compressed = true;
+                return true;
+            }
+
+            return false;
+        }
+    }
+
+    std::vector<std::string> expand_inputs(const std::vector<std::string>& patterns) {
+        std::vector<std::string> inputs;
+
+        for (const auto& pattern : patterns) {
+            std::filesystem::path path(pattern);
+            std::string name = path.filename().string();
+
+            if (name.find_first_of("*?") == std::string::npos) {
+                inputs.push_back(pattern);
+                continue;
+            }
+
+            std::filesystem::path dir = path.parent_path();
+            if (dir.empty()) {
+                dir = ".";
+            }
+
+            std::error_code error;
+            std::vector<std::string> matches;
+            for (const auto& entry : std::filesystem::directory_iterator(dir, error)) {
+                if (entry.is_regular_file() && wildcard_match(name.c_str(), entry.path().filename().string().c_str())) {
+                    matches.push_back((path.parent_path() / entry.path().filename()).string());
+                }
+            }
+
+            if (error) {
+                spdlog::error("Cannot list " + dir.string());
+            }
+            else if (matches.empty()) {
+                spdlog::warn("No files match " + pattern);
+            }
+
+            std::sort(matches.begin(), matches.end());
+            inputs.insert(inputs.end(), matches.begin(), matches.end());
+        }
+
+        return inputs;
+    }
+
+    uint64_t estimate_memory(const PipelineSettings& settings) {
+        uint64_t texels = 0;
+        uint64_t channels = 0;
+        bool compressed = false;
+
+        if (!input_extent(settings, texels, channels, compressed)) {
+            // Unknown layout, assume the file is read as it is
+            return (std::filesystem::exists(settings.input_path)) ? file_size(settings.input_path.c_str()) : 0;
+        }
+
+        const uint64_t value_bytes = (settings.half) ? sizeof(uint16_t) : sizeof(float);
+        const uint64_t uncompressed = texels * channels * value_bytes;
+        const bool normalizing = settings.normalize != PipelineNormalize::PIPELINE_NORMALIZE_NONE;
+        const bool decoding = settings.decompress || settings.error || !settings.decoded_path.empty();
+
+        uint64_t bytes = texels;                                    // Compressed
+        if (!compressed) {
+            bytes += uncompressed;                                  // Source
+            if (!settings.bricked_path.empty())
+                bytes += texels;                                    // Bricked copy
+            if (normalizing && !settings.fused)
+                bytes += uncompressed;                              // Normalized copy
+        }
+        if (decoding)
+            bytes += uncompressed;                                  // Decoded
+        if (!settings.error_path.empty())
+            bytes += texels * channels * sizeof(float);             // Component error
+
+        return bytes;
+    }
+
+    bool batch_compress(const BatchSettings& settings, std::vector<BatchResult>& results) {
+        const auto inputs = expand_inputs(settings.inputs);
+        results.clear();
+        results.resize(inputs.size());
+
+        if (inputs.empty()) {
+            spdlog::error("No inputs to compress");
+            return false;
+        }
+
+        if (!settings.output_dir.empty()) {
+            std::error_code error;
+            std::filesystem::create_directories(settings.output_dir, error);
+            if (error) {
+                spdlog::error("Cannot create " + settings.output_dir);
+                return false;
+            }
+        }
+
+        const uint32_t workers = worker_count(settings.jobs, inputs.size());
+
+        // Split the hardware threads among the concurrent jobs instead of oversubscribing every one of them
+        uint32_t encoder_threads = settings.pipeline.encoder.threads;
+        if (!encoder_threads) {
+            encoder_threads = std::max(thread_count(0) / workers, 1u);
+        }
+
+        // Per job settings
+        std::vector<PipelineSettings> jobs(inputs.size(), settings.pipeline);
+        for (uint64_t i = 0; i < inputs.size(); i++) {
+            PipelineSettings& job = jobs[i];
+            job.input_path = inputs[i];
+            job.encoder.threads = encoder_threads;
+            job.output_path.clear();
+            job.decoded_path.clear();
+            job.error_path.clear();
+            job.bricked_path.clear();
+
+            if (!settings.output_dir.empty()) {
+                const auto dir = std::filesystem::path(settings.output_dir);
+                const auto stem = std::filesystem::path(inputs[i]).stem().string();
+                job.output_path = (dir / (stem + settings.output_extension)).string();
+
+                if (settings.save_decoded) {
+                    job.decoded_path = (dir / (stem + "_decoded" + settings.output_extension)).string();
+                }
+
+                if (!settings.pipeline.bricked_path.empty()) {
+                    job.bricked_path = (dir / (stem + ".bricks")).string();
+                }
+
+                if (settings.save_error) {
+                    job.error_path = (dir / (stem + "_error.raw")).string();
+                    job.error = true;
+                }
+            }
+
+            results[i].input = inputs[i];
+            results[i].memory_estimate = estimate_memory(job);
+
+            if (settings.memory_budget && results[i].memory_estimate > settings.memory_budget) {
+                spdlog::warn("{0} needs about {1} MB, more than the memory budget, it will run alone", inputs[i], results[i].memory_estimate >> 20);
+            }
+        }
+
+        // Inputs with the same stem map onto the same outputs, concurrent jobs would overwrite each other's files
+        std::map<std::string, uint64_t> writers;
+        for (uint64_t i = 0; i < inputs.size(); i++) {
+            for (const std::string* path : { &jobs[i].output_path, &jobs[i].decoded_path, &jobs[i].error_path, &jobs[i].bricked_path }) {
+                if (path->empty())
+                    continue;
+
+                std::error_code error;
+                std::string key = std::filesystem::weakly_canonical(*path, error).string();
+                if (error) {
+                    key = std::filesystem::path(*path).lexically_normal().string();
+                }
+
+                auto [it, inserted] = writers.emplace(key, i);
+                if (!inserted) {
+                    spdlog::error("{0} and {1} both write {2}, rename one of them", inputs[it->second], inputs[i], *path);
+                    return false;
+                }
+            }
+        }
+
+        // Largest jobs first, dealt round robin so every queue starts with a share of the big ones
+        std::vector<uint64_t> order(inputs.size());
+        for (uint64_t i = 0; i < order.size(); i++) {
+            order[i] = i;
+        }
+        std::stable_sort(order.begin(), order.end(), [&](uint64_t a, uint64_t b) { return results[a].memory_estimate > results[b].memory_estimate; });
+
+        std::vector<std::deque<uint64_t>> queues(workers);
+        for (uint64_t i = 0; i < order.size(); i++) {
+            queues[i % workers].push_back(order[i]);
+        }
+
+        // One scheduler guarded by schedule_mutex: the queues, the budget and the counters are only touched under it.
+        // Jobs run for seconds, so a single lock costs nothing next to them and keeps the budget check atomic with taking a job.
+        std::mutex schedule_mutex;
+        std::condition_variable released;
+        uint64_t queued = inputs.size();
+        uint64_t memory_in_use = 0;
+        uint64_t running = 0;
+        uint64_t finished = 0;
+        int percentage = -1;
+
+        auto fits = [&](uint64_t bytes) {
+            return !settings.memory_budget || !running || memory_in_use + bytes <= settings.memory_budget;
+        };
+
+        // Own queue from the front, other queues from the back; skips jobs that do not fit into the budget right now.
+        // Called with schedule_mutex held.
+        auto take = [&](uint32_t w, uint64_t& job) {
+            for (uint32_t k = 0; k < workers; k++) {
+                std::deque<uint64_t>& queue = queues[(w + k) % workers];
+
+                for (uint64_t n = 0; n < queue.size(); n++) {
+                    auto it = (k == 0) ? queue.begin() + n : queue.end() - 1 - n;
+                    if (!fits(results[*it].memory_estimate))
+                        continue;
+
+                    job = *it;
+                    queue.erase(it);
+                    return true;
+                }
+            }
+
+            return false;
+        };
+
+        auto worker = [&](uint32_t w) {
+            while (true) {
+                uint64_t job = 0;
+                bool taken = false;
+                {
+                    std::unique_lock<std::mutex> lock(schedule_mutex);
+                    released.wait(lock, [&]() {
+                        taken = take(w, job);
+                        return taken || !queued;
+                    });
+
+                    if (!taken)
+                        return;
+
+                    queued--;
+                    running++;
+                    memory_in_use += results[job].memory_estimate;
+                    trace_counter("batch/running", (double)running);
+                    trace_counter("batch/memory MB", memory_in_use / 1048576.0);
+                }
+
+                // Own Encoder inside run_pipeline, nothing is shared between jobs
+                int encoder_progress = 0;
+                jobs[job].encoder.progress_ptr = &encoder_progress;
+                try {
+                    run_pipeline(jobs[job], &results[job].stats);
+                }
+                catch (const std::exception& e) {
+                    // Only this file fails, an exception leaving the worker thread would terminate the whole batch
+                    spdlog::error(inputs[job] + " failed: " + e.what());
+                    results[job].stats.success = false;
+                }
+
+                {
+                    std::lock_guard<std::mutex> lock(schedule_mutex);
+                    running--;
+                    memory_in_use -= results[job].memory_estimate;
+                    finished++;
+                    trace_counter("batch/running", (double)running);
+                    trace_counter("batch/memory MB", memory_in_use / 1048576.0);
+
+                    int p = int((100 * finished) / inputs.size());
+                    if (p != percentage) {
+                        percentage = p;
+                        if (settings.progress_ptr) {
+                            *settings.progress_ptr = p;
+                        }
+                        else {
+                            printf("\r%d%%", p);
+                            fflush(stdout);
+                        }
+                    }
+                }
+                released.notify_all();
+            }
+        };
+
+        run_workers(workers, worker);
+
+        if (!settings.progress_ptr) {
+            printf("\n");
+        }
+
+        return std::all_of(results.begin(), results.end(), [](const BatchResult& result) { return result.stats.success; });
+    }
+}
@@ -0,0 +1,1250 @@
+#include <texpress/defines.hpp>
+#include <texpress/compression/bc6h.hpp>
+#include <texpress/helpers/threadhelper.hpp>
+#include <fp16.h>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define TEXPRESS_BC6H_AVX2
+#elif defined(__SSE4_1__)
+#include <smmintrin.h>
+#define TEXPRESS_BC6H_SSE4
+#endif
+
+#if defined(TEXPRESS_F16C) && !defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+namespace texpress {
+    namespace {
+        // Format tables
+        // Header fields: endpoint (w, x, y, z) * 3 + channel (r, g, b), or the partition index.
+        constexpr uint8_t FIELD_PARTITION = 12;
+
+        struct ModeInfo {
+            uint8_t mode_bits;          // Value of the mode bits
+            uint8_t mode_size;          // Number of mode bits (2 or 5)
+            uint8_t regions;            // 1 or 2 subsets
+            bool transformed;           // Endpoints x, y, z are stored as deltas to w
+            uint8_t precision;          // Bits of endpoint w
+            uint8_t delta[3];           // Bits of the deltas per channel
+            const char* layout;         // Header bits following the mode bits, "rw9:0" = rw bits 0 to 9 ascending
+        };
+
+        // BC6H modes 1 to 14 as listed in the D3D11 specification.
+        const ModeInfo MODES[14] = {
+            { 0x00, 2, 2, true, 10, { 5, 5, 5 }, "gy4 by4 bz4 rw9:0 gw9:0 bw9:0 rx4:0 gz4 gy3:0 gx4:0 bz0 gz3:0 bx4:0 bz1 by3:0 ry4:0 bz2 rz4:0 bz3 d4:0" },
+            { 0x01, 2, 2, true, 7, { 6, 6, 6 }, "gy5 gz4 gz5 rw6:0 bz0 bz1 by4 gw6:0 by5 bz2 gy4 bw6:0 bz3 bz5 bz4 rx5:0 gy3:0 gx5:0 gz3:0 bx5:0 by3:0 ry5:0 rz5:0 d4:0" },
+            { 0x02, 5, 2, true, 11, { 5, 4, 4 }, "rw9:0 gw9:0 bw9:0 rx4:0 rw10 gy3:0 gx3:0 gw10 bz0 gz3:0 bx3:0 bw10 bz1 by3:0 ry4:0 bz2 rz4:0 bz3 d4:0" },
+            { 0x06, 5, 2, true, 11, { 4, 5, 4 }, "rw9:0 gw9:0 bw9:0 rx3:0 rw10 gz4 gy3:0 gx4:0 gw10 gz3:0 bx3:0 bw10 bz1 by3:0 ry3:0 bz0 bz2 rz3:0 gy4 bz3 d4:0" },
+            { 0x0A, 5, 2, true, 11, { 4, 4, 5 }, "rw9:0 gw9:0 bw9:0 rx3:0 rw10 by4 gy3:0 gx3:0 gw10 bz0 gz3:0 bx4:0 bw10 by3:0 ry3:0 bz1 bz2 rz3:0 bz4 bz3 d4:0" },
+            { 0x0E, 5, 2, true, 9, { 5, 5, 5 }, "rw8:0 by4 gw8:0 gy4 bw8:0 bz4 rx4:0 gz4 gy3:0 gx4:0 bz0 gz3:0 bx4:0 bz1 by3:0 ry4:0 bz2 rz4:0 bz3 d4:0" },
+            { 0x12, 5, 2, true, 8, { 6, 5, 5 }, "rw7:0 gz4 by4 gw7:0 bz2 gy4 bw7:0 bz3 bz4 rx5:0 gy3:0 gx4:0 bz0 gz3:0 bx4:0 bz1 by3:0 ry5:0 rz5:0 d4:0" },
+            { 0x16, 5, 2, true, 8, { 5, 6, 5 }, "rw7:0 bz0 by4 gw7:0 gy5 gy4 bw7:0 gz5 bz4 rx4:0 gz4 gy3:0 gx5:0 gz3:0 bx4:0 bz1 by3:0 ry4:0 bz2 rz4:0 bz3 d4:0" },
+            { 0x1A, 5, 2, true, 8, { 5, 5, 6 }, "rw7:0 bz1 by4 gw7:0 by5 gy4 bw7:0 bz5 bz4 rx4:0 gz4 gy3:0 gx4:0 bz0 gz3:0 bx5:0 by3:0 ry4:0 bz2 rz4:0 bz3 d4:0" },
+            { 0x1E, 5, 2, false, 6, { 6, 6, 6 }, "rw5:0 gz4 bz0 bz1 by4 gw5:0 gy5 by5 bz2 gy4 bw5:0 gz5 bz3 bz5 bz4 rx5:0 gy3:0 gx5:0 gz3:0 bx5:0 by3:0 ry5:0 rz5:0 d4:0" },
+            { 0x03, 5, 1, false, 10, { 10, 10, 10 }, "rw9:0 gw9:0 bw9:0 rx9:0 gx9:0 bx9:0" },
+            { 0x07, 5, 1, true, 11, { 9, 9, 9 }, "rw9:0 gw9:0 bw9:0 rx8:0 rw10 gx8:0 gw10 bx8:0 bw10" },
+            { 0x0B, 5, 1, true, 12, { 8, 8, 8 }, "rw9:0 gw9:0 bw9:0 rx7:0 rw11 rw10 gx7:0 gw11 gw10 bx7:0 bw11 bw10" },
+            { 0x0F, 5, 1, true, 16, { 4, 4, 4 }, "rw9:0 gw9:0 bw9:0 rx3:0 rw15 rw14 rw13 rw12 rw11 rw10 gx3:0 gw15 gw14 gw13 gw12 gw11 gw10 bx3:0 bw15 bw14 bw13 bw12 bw11 bw10" }
+        };
+
+        constexpr int MODE_SINGLE_10 = 10;  // Mode 11: one region, 10 bit endpoints
+        constexpr int MODE_SINGLE_16 = 13;  // Mode 14: one region, 16 bit endpoint with 4 bit deltas
+
+        // Two region partitions (first 32 of BC7), bit i is set if texel i belongs to the second subset.
+        const uint16_t PARTITIONS[32] = {
+            0xCCCC, 0x8888, 0xEEEE, 0xECC8, 0xC880, 0xFEEC, 0xFEC8, 0xEC80,
+            0xC800, 0xFFEC, 0xFE80, 0xE800, 0xFFE8, 0xFF00, 0xFFF0, 0xF000,
+            0xF710, 0x008E, 0x7100, 0x08CE, 0x008C, 0x7310, 0x3100, 0x8CCE,
+            0x088C, 0x3110, 0x6666, 0x366C, 0x17E8, 0x0FF0, 0x718E, 0x399C
+        };
+
+        // Anchor texel of the second subset, its index is stored with one bit less.
+        const uint8_t ANCHORS[32] = {
+            15, 15, 15, 15, 15, 15, 15, 15,
+            15, 15, 15, 15, 15, 15, 15, 15,
+            15,  2,  8,  2,  2,  8,  8, 15,
+             2,  8,  2,  2,  8,  8,  2,  2
+        };
+
+        const int WEIGHTS_3[8] = { 0, 9, 18, 27, 37, 46, 55, 64 };
+        const int WEIGHTS_4[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+        struct HeaderBit {
+            uint8_t field;
+            uint8_t bit;
+        };
+
+        // Consecutive header bits of one field, ascending from bit lo.
+        struct HeaderRun {
+            uint8_t field;
+            uint8_t lo;
+            uint8_t count;
+        };
+
+        struct ModeLayout {
+            HeaderBit bits[80];
+            uint8_t count = 0;
+            HeaderRun runs[32];
+            uint8_t run_count = 0;
+        };
+
+        // Lane masks used by the SIMD kernels, all bits set for texels of the second subset / anchors.
+        struct LaneMasks {
+            alignas(32) uint32_t subset[32][16];
+            alignas(32) uint32_t anchor[33][16];  // [32] is the single region case
+        };
+
+        ModeLayout parse_layout(const char* layout) {
+            ModeLayout out{};
+            std::istringstream stream(layout);
+            std::string token;
+
+            while (stream >> token) {
+                uint8_t field = FIELD_PARTITION;
+                std::size_t pos = 1;
+
+                if (token[0] != 'd') {
+                    uint8_t channel = (uint8_t)std::string("rgb").find(token[0]);
+                    uint8_t endpoint = (uint8_t)std::string("wxyz").find(token[1]);
+                    field = endpoint * 3 + channel;
+                    pos = 2;
+                }
+
+                std::size_t colon = token.find(':', pos);
+                int hi = std::stoi(token.substr(pos, colon - pos));
+                int lo = (colon == std::string::npos) ? hi : std::stoi(token.substr(colon + 1));
+                out.runs[out.run_count++] = { field, (uint8_t)lo, (uint8_t)(hi - lo + 1) };
+                for (int b = lo; b <= hi; b++) {
+                    out.bits[out.count++] = { field, (uint8_t)b };
+                }
+            }
+
+            return out;
+        }
+
+        const std::array<ModeLayout, 14>& layouts() {
+            static const std::array<ModeLayout, 14> table = []() {
+                std::array<ModeLayout, 14> out;
+                for (int m = 0; m < 14; m++) {
+                    out[m] = parse_layout(MODES[m].layout);
+                }
+                return out;
+            }();
+
+            return table;
+        }
+
+        const LaneMasks& lane_masks() {
+            static const LaneMasks masks = []() {
+                LaneMasks out{};
+                for (int p = 0; p < 33; p++) {
+                    for (int i = 0; i < 16; i++) {
+                        bool second = (p < 32) && ((PARTITIONS[p] >> i) & 1);
+                        bool anchor = (i == 0) || (p < 32 && i == ANCHORS[p]);
+                        if (p < 32) {
+                            out.subset[p][i] = second ? 0xFFFFFFFFu : 0u;
+                        }
+                        out.anchor[p][i] = anchor ? 0xFFFFFFFFu : 0u;
+                    }
+                }
+                return out;
+            }();
+
+            return masks;
+        }
+
+        // Value domain
+        // Endpoints are interpolated in a 16 bit integer domain which maps linearly onto half float bits.
+        int unquantize(int q, int bits, bool is_signed) {
+            if (!is_signed) {
+                if (bits >= 15)
+                    return q;
+                if (q == 0)
+                    return 0;
+                if (q == (1 << bits) - 1)
+                    return 0xFFFF;
+                return ((q << 16) + 0x8000) >> bits;
+            }
+
+            if (bits >= 16)
+                return q;
+
+            bool negative = q < 0;
+            int magnitude = negative ? -q : q;
+            int unq = 0;
+            if (magnitude == 0)
+                unq = 0;
+            else if (magnitude >= (1 << (bits - 1)) - 1)
+                unq = 0x7FFF;
+            else
+                unq = ((magnitude << 15) + 0x4000) >> (bits - 1);
+
+            return negative ? -unq : unq;
+        }
+
+        inline int interpolate(int a, int b, int weight) {
+            return ((64 - weight) * a + weight * b + 32) >> 6;
+        }
+
+        // Maps a float onto the interpolation domain, the decoder reproduces its half float exactly.
+        float to_target(float value, bool is_signed) {
+            if (value != value)
+                value = 0.0f;
+            if (!is_signed && value < 0.0f)
+                value = 0.0f;
+
+            uint16_t h = fp16_ieee_from_fp32_value(value);
+            int magnitude = std::min(h & 0x7FFF, 0x7BFF);
+
+            if (!is_signed)
+                return float((magnitude * 64 + 30) / 31);
+
+            int t = (magnitude * 32 + 30) / 31;
+            return float((h & 0x8000) ? -t : t);
+        }
+
+        int quantize(float target, int bits, bool is_signed) {
+            int lo = 0;
+            int hi = (1 << bits) - 1;
+            float range = 65535.0f;
+
+            if (is_signed) {
+                hi = (1 << (bits - 1)) - 1;
+                lo = -hi;
+                range = 32767.0f;
+            }
+
+            int guess = std::clamp((int)std::lround(target * float(hi) / range), lo, hi);
+            int best = guess;
+            float best_error = std::numeric_limits<float>::max();
+            for (int q = std::max(guess - 1, lo); q <= std::min(guess + 1, hi); q++) {
+                float error = std::abs(float(unquantize(q, bits, is_signed)) - target);
+                if (error < best_error) {
+                    best_error = error;
+                    best = q;
+                }
+            }
+
+            return best;
+        }
+
+        // Block state
+        struct BlockInput {
+            alignas(32) float c[3][16];         // Targets in the interpolation domain
+            alignas(32) float centered[3][16];  // Targets minus the block mean, used for partition estimates
+            float weights[3];
+            bool is_signed;
+        };
+
+        struct Candidate {
+            int mode = MODE_SINGLE_10;
+            int partition = 0;
+            int q[2][2][3] = {};                // Quantized endpoints [subset][endpoint][channel]
+            uint8_t idx[16] = {};
+            float error = std::numeric_limits<float>::max();
+        };
+
+        // SIMD kernels
+#if defined(TEXPRESS_BC6H_AVX2)
+        inline float hsum(__m256 v) {
+            __m128 lo = _mm_add_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1));
+            __m128 sh = _mm_movehdup_ps(lo);
+            lo = _mm_add_ps(lo, sh);
+            sh = _mm_movehl_ps(sh, lo);
+            return _mm_cvtss_f32(_mm_add_ss(lo, sh));
+        }
+#elif defined(TEXPRESS_BC6H_SSE4)
+        inline float hsum(__m128 v) {
+            __m128 sh = _mm_movehdup_ps(v);
+            v = _mm_add_ps(v, sh);
+            sh = _mm_movehl_ps(sh, v);
+            return _mm_cvtss_f32(_mm_add_ss(v, sh));
+        }
+#endif
+
+        // Index quantization: picks the closest palette entry for every texel and returns the summed weighted error.
+        // palette[subset][channel][entry], anchor texels may only use the lower half of the palette.
+        float select_indices(const BlockInput& in, const float (*palette)[3][16], int entries, const uint32_t* subset_mask, const uint32_t* anchor_mask, uint8_t* idx) {
+            const int half = entries / 2;
+
+#if defined(TEXPRESS_BC6H_AVX2)
+            const __m256 wr = _mm256_set1_ps(in.weights[0]);
+            const __m256 wg = _mm256_set1_ps(in.weights[1]);
+            const __m256 wb = _mm256_set1_ps(in.weights[2]);
+            const __m256 inf = _mm256_set1_ps(std::numeric_limits<float>::max());
+            __m256 total = _mm256_setzero_ps();
+
+            for (int h = 0; h < 16; h += 8) {
+                const __m256 r = _mm256_load_ps(in.c[0] + h);
+                const __m256 g = _mm256_load_ps(in.c[1] + h);
+                const __m256 b = _mm256_load_ps(in.c[2] + h);
+                const __m256 second = _mm256_castsi256_ps(_mm256_load_si256((const __m256i*)(subset_mask + h)));
+                const __m256 anchor = _mm256_castsi256_ps(_mm256_load_si256((const __m256i*)(anchor_mask + h)));
+
+                __m256 best = inf;
+                __m256i best_idx = _mm256_setzero_si256();
+                for (int k = 0; k < entries; k++) {
+                    __m256 pr = _mm256_blendv_ps(_mm256_set1_ps(palette[0][0][k]), _mm256_set1_ps(palette[1][0][k]), second);
+                    __m256 pg = _mm256_blendv_ps(_mm256_set1_ps(palette[0][1][k]), _mm256_set1_ps(palette[1][1][k]), second);
+                    __m256 pb = _mm256_blendv_ps(_mm256_set1_ps(palette[0][2][k]), _mm256_set1_ps(palette[1][2][k]), second);
+
+                    __m256 dr = _mm256_sub_ps(r, pr);
+                    __m256 dg = _mm256_sub_ps(g, pg);
+                    __m256 db = _mm256_sub_ps(b, pb);
+                    __m256 d = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(wr, _mm256_mul_ps(dr, dr)), _mm256_mul_ps(wg, _mm256_mul_ps(dg, dg))), _mm256_mul_ps(wb, _mm256_mul_ps(db, db)));
+                    if (k >= half) {
+                        d = _mm256_blendv_ps(d, inf, anchor);
+                    }
+
+                    __m256 closer = _mm256_cmp_ps(d, best, _CMP_LT_OQ);
+                    best = _mm256_min_ps(d, best);
+                    best_idx = _mm256_blendv_epi8(best_idx, _mm256_set1_epi32(k), _mm256_castps_si256(closer));
+                }
+
+                alignas(32) int32_t lanes[8];
+                _mm256_store_si256((__m256i*)lanes, best_idx);
+                for (int i = 0; i < 8; i++) {
+                    idx[h + i] = (uint8_t)lanes[i];
+                }
+                total = _mm256_add_ps(total, best);
+            }
+
+            return hsum(total);
+#elif defined(TEXPRESS_BC6H_SSE4)
+            const __m128 wr = _mm_set1_ps(in.weights[0]);
+            const __m128 wg = _mm_set1_ps(in.weights[1]);
+            const __m128 wb = _mm_set1_ps(in.weights[2]);
+            const __m128 inf = _mm_set1_ps(std::numeric_limits<float>::max());
+            __m128 total = _mm_setzero_ps();
+
+            for (int h = 0; h < 16; h += 4) {
+                const __m128 r = _mm_load_ps(in.c[0] + h);
+                const __m128 g = _mm_load_ps(in.c[1] + h);
+                const __m128 b = _mm_load_ps(in.c[2] + h);
+                const __m128 second = _mm_castsi128_ps(_mm_loadu_si128((const __m128i*)(subset_mask + h)));
+                const __m128 anchor = _mm_castsi128_ps(_mm_loadu_si128((const __m128i*)(anchor_mask + h)));
+
+                __m128 best = inf;
+                __m128i best_idx = _mm_setzero_si128();
+                for (int k = 0; k < entries; k++) {
+                    __m128 pr = _mm_blendv_ps(_mm_set1_ps(palette[0][0][k]), _mm_set1_ps(palette[1][0][k]), second);
+                    __m128 pg = _mm_blendv_ps(_mm_set1_ps(palette[0][1][k]), _mm_set1_ps(palette[1][1][k]), second);
+                    __m128 pb = _mm_blendv_ps(_mm_set1_ps(palette[0][2][k]), _mm_set1_ps(palette[1][2][k]), second);
+
+                    __m128 dr = _mm_sub_ps(r, pr);
+                    __m128 dg = _mm_sub_ps(g, pg);
+                    __m128 db = _mm_sub_ps(b, pb);
+                    __m128 d = _mm_add_ps(_mm_add_ps(_mm_mul_ps(wr, _mm_mul_ps(dr, dr)), _mm_mul_ps(wg, _mm_mul_ps(dg, dg))), _mm_mul_ps(wb, _mm_mul_ps(db, db)));
+                    if (k >= half) {
+                        d = _mm_blendv_ps(d, inf, anchor);
+                    }
+
+                    __m128 closer = _mm_cmplt_ps(d, best);
+                    best = _mm_min_ps(d, best);
+                    best_idx = _mm_blendv_epi8(best_idx, _mm_set1_epi32(k), _mm_castps_si128(closer));
+                }
+
+                alignas(16) int32_t lanes[4];
+                _mm_store_si128((__m128i*)lanes, best_idx);
+                for (int i = 0; i < 4; i++) {
+                    idx[h + i] = (uint8_t)lanes[i];
+                }
+                total = _mm_add_ps(total, best);
+            }
+
+            return hsum(total);
+#else
+            float total = 0.0f;
+            for (int i = 0; i < 16; i++) {
+                const int s = subset_mask[i] ? 1 : 0;
+                const int last = anchor_mask[i] ? half : entries;
+
+                float best = std::numeric_limits<float>::max();
+                for (int k = 0; k < last; k++) {
+                    float dr = in.c[0][i] - palette[s][0][k];
+                    float dg = in.c[1][i] - palette[s][1][k];
+                    float db = in.c[2][i] - palette[s][2][k];
+                    float d = in.weights[0] * (dr * dr) + in.weights[1] * (dg * dg) + in.weights[2] * (db * db);
+                    if (d < best) {
+                        best = d;
+                        idx[i] = (uint8_t)k;
+                    }
+                }
+                total += best;
+            }
+
+            return total;
+#endif
+        }
+
+        // Endpoint search: first and second order moments of the texels selected by mask.
+        // Returns { n, sum r, sum g, sum b, sum rr, sum gg, sum bb, sum rg, sum rb, sum gb } of the centered targets.
+        std::array<float, 10> masked_moments(const BlockInput& in, const uint32_t* mask, bool invert) {
+#if defined(TEXPRESS_BC6H_AVX2)
+            __m256 acc[10];
+            for (auto& a : acc) {
+                a = _mm256_setzero_ps();
+            }
+
+            const __m256 ones = _mm256_set1_ps(1.0f);
+            for (int h = 0; h < 16; h += 8) {
+                __m256 m = _mm256_castsi256_ps(_mm256_load_si256((const __m256i*)(mask + h)));
+                if (invert) {
+                    m = _mm256_xor_ps(m, _mm256_castsi256_ps(_mm256_set1_epi32(-1)));
+                }
+
+                const __m256 r = _mm256_and_ps(_mm256_load_ps(in.centered[0] + h), m);
+                const __m256 g = _mm256_and_ps(_mm256_load_ps(in.centered[1] + h), m);
+                const __m256 b = _mm256_and_ps(_mm256_load_ps(in.centered[2] + h), m);
+
+                acc[0] = _mm256_add_ps(acc[0], _mm256_and_ps(ones, m));
+                acc[1] = _mm256_add_ps(acc[1], r);
+                acc[2] = _mm256_add_ps(acc[2], g);
+                acc[3] = _mm256_add_ps(acc[3], b);
+                acc[4] = _mm256_add_ps(acc[4], _mm256_mul_ps(r, r));
+                acc[5] = _mm256_add_ps(acc[5], _mm256_mul_ps(g, g));
+                acc[6] = _mm256_add_ps(acc[6], _mm256_mul_ps(b, b));
+                acc[7] = _mm256_add_ps(acc[7], _mm256_mul_ps(r, g));
+                acc[8] = _mm256_add_ps(acc[8], _mm256_mul_ps(r, b));
+                acc[9] = _mm256_add_ps(acc[9], _mm256_mul_ps(g, b));
+            }
+
+            std::array<float, 10> out;
+            for (int i = 0; i < 10; i++) {
+                out[i] = hsum(acc[i]);
+            }
+            return out;
+#elif defined(TEXPRESS_BC6H_SSE4)
+            __m128 acc[10];
+            for (auto& a : acc) {
+                a = _mm_setzero_ps();
+            }
+
+            const __m128 ones = _mm_set1_ps(1.0f);
+            for (int h = 0; h < 16; h += 4) {
+                __m128 m = _mm_castsi128_ps(_mm_loadu_si128((const __m128i*)(mask + h)));
+                if (invert) {
+                    m = _mm_xor_ps(m, _mm_castsi128_ps(_mm_set1_epi32(-1)));
+                }
+
+                const __m128 r = _mm_and_ps(_mm_load_ps(in.centered[0] + h), m);
+                const __m128 g = _mm_and_ps(_mm_load_ps(in.centered[1] + h), m);
+                const __m128 b = _mm_and_ps(_mm_load_ps(in.centered[2] + h), m);
+
+                acc[0] = _mm_add_ps(acc[0], _mm_and_ps(ones, m));
+                acc[1] = _mm_add_ps(acc[1], r);
+                acc[2] = _mm_add_ps(acc[2], g);
+                acc[3] = _mm_add_ps(acc[3], b);
+                acc[4] = _mm_add_ps(acc[4], _mm_mul_ps(r, r));
+                acc[5] = _mm_add_ps(acc[5], _mm_mul_ps(g, g));
+                acc[6] = _mm_add_ps(acc[6], _mm_mul_ps(b, b));
+                acc[7] = _mm_add_ps(acc[7], _mm_mul_ps(r, g));
+                acc[8] = _mm_add_ps(acc[8], _mm_mul_ps(r, b));
+                acc[9] = _mm_add_ps(acc[9], _mm_mul_ps(g, b));
+            }
+
+            std::array<float, 10> out;
+            for (int i = 0; i < 10; i++) {
+                out[i] = hsum(acc[i]);
+            }
+            return out;
+#else
+            std::array<float, 10> out{};
+            for (int i = 0; i < 16; i++) {
+                if ((mask[i] != 0) == invert)
+                    continue;
+
+                const float r = in.centered[0][i];
+                const float g = in.centered[1][i];
+                const float b = in.centered[2][i];
+                out[0] += 1.0f;
+                out[1] += r;
+                out[2] += g;
+                out[3] += b;
+                out[4] += r * r;
+                out[5] += g * g;
+                out[6] += b * b;
+                out[7] += r * g;
+                out[8] += r * b;
+                out[9] += g * b;
+            }
+            return out;
+#endif
+        }
+
+        // Dominant eigenvector of a symmetric 3x3 matrix { xx, yy, zz, xy, xz, yz } by power iteration.
+        void principal_axis(const double cov[6], double axis[3]) {
+            // Start with the column of the largest diagonal element
+            int col = (cov[0] >= cov[1] && cov[0] >= cov[2]) ? 0 : (cov[1] >= cov[2]) ? 1 : 2;
+            const double m[3][3] = {
+                { cov[0], cov[3], cov[4] },
+                { cov[3], cov[1], cov[5] },
+                { cov[4], cov[5], cov[2] }
+            };
+
+            axis[0] = m[0][col];
+            axis[1] = m[1][col];
+            axis[2] = m[2][col];
+
+            for (int it = 0; it < 8; it++) {
+                double v[3];
+                for (int i = 0; i < 3; i++) {
+                    v[i] = m[i][0] * axis[0] + m[i][1] * axis[1] + m[i][2] * axis[2];
+                }
+
+                double len = std::sqrt(v[0] * v[0] + v[1] * v[1] + v[2] * v[2]);
+                if (len <= 0.0) {
+                    break;
+                }
+
+                for (int i = 0; i < 3; i++) {
+                    axis[i] = v[i] / len;
+                }
+            }
+
+            double len = std::sqrt(axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2]);
+            if (len <= 0.0) {
+                axis[0] = axis[1] = axis[2] = 0.57735026919;
+                return;
+            }
+
+            for (int i = 0; i < 3; i++) {
+                axis[i] /= len;
+            }
+        }
+
+        // Residual of fitting a line through the texels selected by mask, a cheap estimate of the encoding error.
+        double line_residual(const std::array<float, 10>& mo) {
+            const double n = mo[0];
+            if (n < 2.0)
+                return 0.0;
+
+            double cov[6] = {
+                mo[4] - mo[1] * mo[1] / n,
+                mo[5] - mo[2] * mo[2] / n,
+                mo[6] - mo[3] * mo[3] / n,
+                mo[7] - mo[1] * mo[2] / n,
+                mo[8] - mo[1] * mo[3] / n,
+                mo[9] - mo[2] * mo[3] / n
+            };
+
+            double axis[3];
+            principal_axis(cov, axis);
+
+            // Variance along the axis: a^T C a
+            double along = axis[0] * (cov[0] * axis[0] + cov[3] * axis[1] + cov[4] * axis[2])
+                + axis[1] * (cov[3] * axis[0] + cov[1] * axis[1] + cov[5] * axis[2])
+                + axis[2] * (cov[4] * axis[0] + cov[5] * axis[1] + cov[2] * axis[2]);
+
+            return std::max(cov[0] + cov[1] + cov[2] - along, 0.0);
+        }
+
+        // Encoder
+        bool is_second(int regions, int partition, int texel) {
+            return regions == 2 && ((PARTITIONS[partition] >> texel) & 1);
+        }
+
+        int anchor_of(int subset, int partition) {
+            return (subset == 0) ? 0 : ANCHORS[partition];
+        }
+
+        // Per channel extent of the texels of one subset, endpoints outside of it only add error.
+        void subset_bounds(const BlockInput& in, int regions, int partition, int subset, float lo[3], float hi[3]) {
+            for (int c = 0; c < 3; c++) {
+                lo[c] = std::numeric_limits<float>::max();
+                hi[c] = std::numeric_limits<float>::lowest();
+            }
+
+            for (int i = 0; i < 16; i++) {
+                if (is_second(regions, partition, i) != (subset == 1))
+                    continue;
+                for (int c = 0; c < 3; c++) {
+                    lo[c] = std::min(lo[c], in.c[c][i]);
+                    hi[c] = std::max(hi[c], in.c[c][i]);
+                }
+            }
+        }
+
+        // Initial endpoints of one subset: extent of the texels along their principal axis.
+        void fit_subset(const BlockInput& in, int regions, int partition, int subset, float endpoints[2][3]) {
+            double mean[3] = { 0.0, 0.0, 0.0 };
+            double n = 0.0;
+            for (int i = 0; i < 16; i++) {
+                if (is_second(regions, partition, i) != (subset == 1))
+                    continue;
+                for (int c = 0; c < 3; c++) {
+                    mean[c] += in.c[c][i];
+                }
+                n += 1.0;
+            }
+
+            for (int c = 0; c < 3; c++) {
+                mean[c] /= std::max(n, 1.0);
+            }
+
+            double cov[6] = { 0.0, 0.0, 0.0, 0.0, 0.0, 0.0 };
+            for (int i = 0; i < 16; i++) {
+                if (is_second(regions, partition, i) != (subset == 1))
+                    continue;
+                double d[3] = { in.c[0][i] - mean[0], in.c[1][i] - mean[1], in.c[2][i] - mean[2] };
+                cov[0] += d[0] * d[0];
+                cov[1] += d[1] * d[1];
+                cov[2] += d[2] * d[2];
+                cov[3] += d[0] * d[1];
+                cov[4] += d[0] * d[2];
+                cov[5] += d[1] * d[2];
+            }
+
+            double axis[3];
+            principal_axis(cov, axis);
+
+            double t_min = 0.0;
+            double t_max = 0.0;
+            for (int i = 0; i < 16; i++) {
+                if (is_second(regions, partition, i) != (subset == 1))
+                    continue;
+                double t = (in.c[0][i] - mean[0]) * axis[0] + (in.c[1][i] - mean[1]) * axis[1] + (in.c[2][i] - mean[2]) * axis[2];
+                t_min = std::min(t, t_min);
+                t_max = std::max(t, t_max);
+            }
+
+            float lo[3], hi[3];
+            subset_bounds(in, regions, partition, subset, lo, hi);
+            for (int c = 0; c < 3; c++) {
+                endpoints[0][c] = std::clamp(float(mean[c] + axis[c] * t_min), lo[c], hi[c]);
+                endpoints[1][c] = std::clamp(float(mean[c] + axis[c] * t_max), lo[c], hi[c]);
+            }
+        }
+
+        // Least squares endpoints of one subset for the given indices.
+        bool refit_subset(const BlockInput& in, const Candidate& cand, int subset, float endpoints[2][3]) {
+            const ModeInfo& m = MODES[cand.mode];
+            const int* weights = (m.regions == 2) ? WEIGHTS_3 : WEIGHTS_4;
+
+            double aa = 0.0, ab = 0.0, bb = 0.0;
+            double at[3] = { 0.0, 0.0, 0.0 };
+            double bt[3] = { 0.0, 0.0, 0.0 };
+            for (int i = 0; i < 16; i++) {
+                if (is_second(m.regions, cand.partition, i) != (subset == 1))
+                    continue;
+
+                double w = weights[cand.idx[i]] / 64.0;
+                double a = 1.0 - w;
+                aa += a * a;
+                ab += a * w;
+                bb += w * w;
+                for (int c = 0; c < 3; c++) {
+                    at[c] += a * in.c[c][i];
+                    bt[c] += w * in.c[c][i];
+                }
+            }
+
+            double det = aa * bb - ab * ab;
+            if (std::abs(det) < 1e-8)
+                return false;
+
+            float lo[3], hi[3];
+            subset_bounds(in, m.regions, cand.partition, subset, lo, hi);
+            for (int c = 0; c < 3; c++) {
+                endpoints[0][c] = std::clamp(float((bb * at[c] - ab * bt[c]) / det), lo[c], hi[c]);
+                endpoints[1][c] = std::clamp(float((aa * bt[c] - ab * at[c]) / det), lo[c], hi[c]);
+            }
+
+            return true;
+        }
+
+        // Restricts the quantized endpoints to what the mode can store, deltas are relative to endpoint w.
+        void constrain(const ModeInfo& m, bool is_signed, int q[2][2][3]) {
+            if (!m.transformed)
+                return;
+
+            const int lo = is_signed ? -(1 << (m.precision - 1)) : 0;
+            const int hi = is_signed ? (1 << (m.precision - 1)) - 1 : (1 << m.precision) - 1;
+
+            // Endpoint w is stored with precision bits as well, perturbation may have moved it out of range
+            for (int c = 0; c < 3; c++) {
+                q[0][0][c] = std::clamp(q[0][0][c], lo, hi);
+            }
+
+            for (int s = 0; s < m.regions; s++) {
+                for (int e = 0; e < 2; e++) {
+                    if (s == 0 && e == 0)
+                        continue;
+
+                    for (int c = 0; c < 3; c++) {
+                        const int d_lo = -(1 << (m.delta[c] - 1));
+                        const int d_hi = (1 << (m.delta[c] - 1)) - 1;
+                        int delta = std::clamp(q[s][e][c] - q[0][0][c], d_lo, d_hi);
+                        q[s][e][c] = std::clamp(q[0][0][c] + delta, lo, hi);
+                    }
+                }
+            }
+        }
+
+        // Computes the palettes of the quantized endpoints and the best indices.
+        void evaluate(const BlockInput& in, Candidate& cand) {
+            const ModeInfo& m = MODES[cand.mode];
+            const int entries = (m.regions == 2) ? 8 : 16;
+            const int* weights = (m.regions == 2) ? WEIGHTS_3 : WEIGHTS_4;
+            const LaneMasks& masks = lane_masks();
+            static const uint32_t no_subset[16] = {};
+
+            alignas(32) float palette[2][3][16] = {};
+            for (int s = 0; s < m.regions; s++) {
+                for (int c = 0; c < 3; c++) {
+                    int a = unquantize(cand.q[s][0][c], m.precision, in.is_signed);
+                    int b = unquantize(cand.q[s][1][c], m.precision, in.is_signed);
+                    for (int k = 0; k < entries; k++) {
+                        palette[s][c][k] = float(interpolate(a, b, weights[k]));
+                    }
+                }
+            }
+
+            const uint32_t* subset_mask = (m.regions == 2) ? masks.subset[cand.partition] : no_subset;
+            const uint32_t* anchor_mask = (m.regions == 2) ? masks.anchor[cand.partition] : masks.anchor[32];
+            cand.error = select_indices(in, palette, entries, subset_mask, anchor_mask, cand.idx);
+        }
+
+        // Orients, quantizes and evaluates continuous endpoints for a mode and partition.
+        void encode_endpoints(const BlockInput& in, float endpoints[2][2][3], Candidate& cand) {
+            const ModeInfo& m = MODES[cand.mode];
+
+            for (int s = 0; s < m.regions; s++) {
+                // The anchor texel has to use the lower half of the palette, so it should lie closer to endpoint 0.
+                const int anchor = anchor_of(s, cand.partition);
+                double along = 0.0;
+                double len = 0.0;
+                for (int c = 0; c < 3; c++) {
+                    double d = endpoints[s][1][c] - endpoints[s][0][c];
+                    along += (in.c[c][anchor] - endpoints[s][0][c]) * d;
+                    len += d * d;
+                }
+
+                if (len > 0.0 && along / len > 0.5) {
+                    for (int c = 0; c < 3; c++) {
+                        std::swap(endpoints[s][0][c], endpoints[s][1][c]);
+                    }
+                }
+
+                for (int e = 0; e < 2; e++) {
+                    for (int c = 0; c < 3; c++) {
+                        cand.q[s][e][c] = quantize(endpoints[s][e][c], m.precision, in.is_signed);
+                    }
+                }
+            }
+
+            constrain(m, in.is_signed, cand.q);
+            evaluate(in, cand);
+        }
+
+        Candidate encode_mode(const BlockInput& in, int mode, int partition, int refinements) {
+            const ModeInfo& m = MODES[mode];
+
+            Candidate cand;
+            cand.mode = mode;
+            cand.partition = partition;
+
+            float endpoints[2][2][3] = {};
+            for (int s = 0; s < m.regions; s++) {
+                fit_subset(in, m.regions, partition, s, endpoints[s]);
+            }
+            encode_endpoints(in, endpoints, cand);
+
+            for (int it = 0; it < refinements; it++) {
+                Candidate refined = cand;
+                bool changed = false;
+                for (int s = 0; s < m.regions; s++) {
+                    changed |= refit_subset(in, cand, s, endpoints[s]);
+                }
+
+                if (!changed)
+                    break;
+
+                encode_endpoints(in, endpoints, refined);
+                if (refined.error >= cand.error)
+                    break;
+
+                cand = refined;
+            }
+
+            return cand;
+        }
+
+        // Tries to lower the error by moving single quantized endpoint components by one step.
+        void perturb(const BlockInput& in, Candidate& cand) {
+            const ModeInfo& m = MODES[cand.mode];
+
+            for (int s = 0; s < m.regions; s++) {
+                for (int e = 0; e < 2; e++) {
+                    for (int c = 0; c < 3; c++) {
+                        for (int step = -1; step <= 1; step += 2) {
+                            Candidate trial = cand;
+                            trial.q[s][e][c] += step;
+
+                            if (!m.transformed) {
+                                const int lo = in.is_signed ? -((1 << (m.precision - 1)) - 1) : 0;
+                                const int hi = in.is_signed ? (1 << (m.precision - 1)) - 1 : (1 << m.precision) - 1;
+                                if (trial.q[s][e][c] < lo || trial.q[s][e][c] > hi)
+                                    continue;
+                            }
+
+                            constrain(m, in.is_signed, trial.q);
+                            evaluate(in, trial);
+                            if (trial.error < cand.error) {
+                                cand = trial;
+                            }
+                        }
+                    }
+                }
+            }
+        }
+
+        // Ranks all partitions by the line fit residual of both subsets.
+        void rank_partitions(const BlockInput& in, int count, int* best) {
+            const LaneMasks& masks = lane_masks();
+            std::array<std::pair<double, int>, 32> ranking;
+
+            for (int p = 0; p < 32; p++) {
+                double residual = line_residual(masked_moments(in, masks.subset[p], true))
+                    + line_residual(masked_moments(in, masks.subset[p], false));
+                ranking[p] = { residual, p };
+            }
+
+            std::partial_sort(ranking.begin(), ranking.begin() + count, ranking.end());
+            for (int i = 0; i < count; i++) {
+                best[i] = ranking[i].second;
+            }
+        }
+
+        // Signed endpoints need no special case, masking stores them in two's complement as decode_block sign extends them
+        void pack_block(const Candidate& cand, uint8_t* block) {
+            const ModeInfo& m = MODES[cand.mode];
+            const ModeLayout& layout = layouts()[cand.mode];
+            std::memset(block, 0, BC6H_BLOCK_BYTES);
+
+            uint32_t pos = 0;
+            auto put = [&](uint32_t value, uint32_t bits) {
+                for (uint32_t b = 0; b < bits; b++, pos++) {
+                    block[pos >> 3] |= uint8_t(((value >> b) & 1u) << (pos & 7));
+                }
+            };
+
+            // Header field values, deltas are stored relative to endpoint w
+            uint32_t fields[13] = {};
+            for (int c = 0; c < 3; c++) {
+                const int w = cand.q[0][0][c];
+                const int values[4] = { w, cand.q[0][1][c], cand.q[1][0][c], cand.q[1][1][c] };
+                fields[c] = uint32_t(w) & ((1u << m.precision) - 1u);
+
+                for (int e = 1; e < 4; e++) {
+                    const int bits = m.transformed ? m.delta[c] : m.precision;
+                    const int value = m.transformed ? values[e] - w : values[e];
+                    fields[e * 3 + c] = uint32_t(value) & ((1u << bits) - 1u);
+                }
+            }
+            fields[FIELD_PARTITION] = uint32_t(cand.partition);
+
+            put(m.mode_bits, m.mode_size);
+            for (uint8_t i = 0; i < layout.count; i++) {
+                put((fields[layout.bits[i].field] >> layout.bits[i].bit) & 1u, 1);
+            }
+
+            const uint32_t index_bits = (m.regions == 2) ? 3 : 4;
+            const int anchor = (m.regions == 2) ? ANCHORS[cand.partition] : 0;
+            for (int i = 0; i < 16; i++) {
+                const bool is_anchor = (i == 0) || (m.regions == 2 && i == anchor);
+                put(cand.idx[i], is_anchor ? index_bits - 1 : index_bits);
+            }
+        }
+
+        struct QualityParams {
+            bool two_regions;       // Try modes 1 to 10
+            int partitions;         // Best partitions to encode
+            int refinements;        // Least squares passes
+            bool all_single;        // Try modes 11 to 14, otherwise only 11 and 14
+            bool perturb;           // Endpoint perturbation of the winner
+        };
+
+        QualityParams quality_params(BC6HQuality quality) {
+            switch (quality) {
+            case BC6HQuality::BC6H_FASTEST:
+                return { false, 0, 0, false, false };
+            case BC6HQuality::BC6H_NORMAL:
+                return { true, 1, 1, true, false };
+            case BC6HQuality::BC6H_PRODUCTION:
+                return { true, 4, 2, true, false };
+            case BC6HQuality::BC6H_HIGHEST:
+                return { true, 8, 4, true, true };
+            }
+
+            return { false, 0, 0, false, false };
+        }
+
+        // Maps planar RGB floats onto the interpolation domain of the encoder.
+        BlockInput make_input(const float* rgb, const BC6HOptions& options) {
+            BlockInput in;
+            in.is_signed = options.is_signed;
+            for (int c = 0; c < 3; c++) {
+                in.weights[c] = options.weights[c];
+            }
+
+            float mean[3] = { 0.0f, 0.0f, 0.0f };
+            for (int c = 0; c < 3; c++) {
+                for (int i = 0; i < 16; i++) {
+                    in.c[c][i] = to_target(rgb[c * 16 + i], options.is_signed);
+                    mean[c] += in.c[c][i];
+                }
+                mean[c] /= 16.0f;
+
+                for (int i = 0; i < 16; i++) {
+                    in.centered[c][i] = in.c[c][i] - mean[c];
+                }
+            }
+
+            return in;
+        }
+
+        // Searches the modes and partitions of a quality level for the candidate of least error.
+        Candidate encode_block(const BlockInput& in, BC6HQuality quality) {
+            const QualityParams params = quality_params(quality);
+
+            // Single region
+            Candidate best = encode_mode(in, MODE_SINGLE_10, 0, params.refinements);
+            for (int mode = MODE_SINGLE_10 + 1; mode <= MODE_SINGLE_16 && best.error > 0.0f; mode++) {
+                if (!params.all_single && mode != MODE_SINGLE_16)
+                    continue;
+
+                Candidate cand = encode_mode(in, mode, 0, params.refinements);
+                if (cand.error < best.error) {
+                    best = cand;
+                }
+            }
+
+            // Two regions
+            if (params.two_regions && best.error > 0.0f) {
+                int partitions[32];
+                rank_partitions(in, params.partitions, partitions);
+
+                for (int p = 0; p < params.partitions; p++) {
+                    for (int mode = 0; mode < MODE_SINGLE_10; mode++) {
+                        Candidate cand = encode_mode(in, mode, partitions[p], params.refinements);
+                        if (cand.error < best.error) {
+                            best = cand;
+                        }
+                    }
+                }
+            }
+
+            if (params.perturb && best.error > 0.0f) {
+                perturb(in, best);
+            }
+
+            return best;
+        }
+
+        // Decoder
+        int sign_extend(int value, int bits) {
+            const int sign = 1 << (bits - 1);
+            value &= (1 << bits) - 1;
+            return (value ^ sign) - sign;
+        }
+
+        // Mode index of the lowest 5 block bits, -1 for reserved modes.
+        const std::array<int8_t, 32>& mode_lookup() {
+            static const std::array<int8_t, 32> table = []() {
+                std::array<int8_t, 32> out;
+                out.fill(-1);
+                for (int bits = 0; bits < 32; bits++) {
+                    for (int m = 0; m < 14; m++) {
+                        const uint32_t mask = (1u << MODES[m].mode_size) - 1u;
+                        if ((bits & 3) < 2 && MODES[m].mode_size != 2)
+                            continue;
+                        if ((bits & mask) == MODES[m].mode_bits) {
+                            out[bits] = (int8_t)m;
+                            break;
+                        }
+                    }
+                }
+                return out;
+            }();
+
+            return table;
+        }
+
+        struct BlockBits {
+            uint64_t lo;
+            uint64_t hi;
+
+            uint32_t get(uint32_t pos, uint32_t count) const {
+                uint64_t value = 0;
+                if (pos >= 64) {
+                    value = hi >> (pos - 64);
+                }
+                else {
+                    value = lo >> pos;
+                    if (pos + count > 64) {
+                        value |= hi << (64 - pos);
+                    }
+                }
+                return uint32_t(value & ((1ull << count) - 1ull));
+            }
+        };
+
+        // Decodes one block into planar half floats h[channel][texel].
+        void decode_block(const uint8_t* block, bool is_signed, uint16_t h[3][16]) {
+            BlockBits bits;
+            std::memcpy(&bits.lo, block, sizeof(uint64_t));
+            std::memcpy(&bits.hi, block + sizeof(uint64_t), sizeof(uint64_t));
+
+            const int mode = mode_lookup()[bits.get(0, 5)];
+            if (mode < 0) {
+                std::memset(h, 0, sizeof(uint16_t) * 3 * 16);
+                return;
+            }
+
+            const ModeInfo& m = MODES[mode];
+            const ModeLayout& layout = layouts()[mode];
+
+            uint32_t pos = m.mode_size;
+            uint32_t fields[13] = {};
+            for (uint8_t r = 0; r < layout.run_count; r++) {
+                const HeaderRun& run = layout.runs[r];
+                fields[run.field] |= bits.get(pos, run.count) << run.lo;
+                pos += run.count;
+            }
+
+            // Endpoints [w, x, y, z][channel], unquantized to the interpolation domain
+            const int endpoints = m.regions * 2;
+            alignas(32) int32_t e[4][3] = {};
+            for (int c = 0; c < 3; c++) {
+                const int w = is_signed ? sign_extend(fields[c], m.precision) : int(fields[c]);
+                e[0][c] = unquantize(w, m.precision, is_signed);
+
+                for (int k = 1; k < endpoints; k++) {
+                    int value = int(fields[k * 3 + c]);
+                    if (m.transformed) {
+                        value = (int(fields[c]) + sign_extend(value, m.delta[c])) & ((1 << m.precision) - 1);
+                    }
+                    if (is_signed) {
+                        value = sign_extend(value, m.precision);
+                    }
+                    e[k][c] = unquantize(value, m.precision, is_signed);
+                }
+            }
+
+            // Indices, anchor texels are stored with one bit less
+            const uint32_t partition = fields[FIELD_PARTITION];
+            const uint32_t index_bits = (m.regions == 2) ? 3 : 4;
+            const int* weights = (m.regions == 2) ? WEIGHTS_3 : WEIGHTS_4;
+            const uint32_t anchor = (m.regions == 2) ? ANCHORS[partition] : 0;
+            const uint32_t second = (m.regions == 2) ? PARTITIONS[partition] : 0;
+
+            pos = (m.regions == 2) ? 82 : 65;
+            alignas(32) int32_t w[16];
+            for (uint32_t i = 0; i < 16; i++) {
+                const uint32_t count = (i == 0 || (m.regions == 2 && i == anchor)) ? index_bits - 1 : index_bits;
+                w[i] = weights[bits.get(pos, count)];
+                pos += count;
+            }
+
+#if defined(TEXPRESS_BC6H_AVX2)
+            const __m256i lane = _mm256_setr_epi32(1 << 0, 1 << 1, 1 << 2, 1 << 3, 1 << 4, 1 << 5, 1 << 6, 1 << 7);
+            for (int half = 0; half < 16; half += 8) {
+                const __m256i subset = _mm256_cmpeq_epi32(_mm256_and_si256(_mm256_set1_epi32(int(second >> half)), lane), lane);
+                const __m256i weight = _mm256_load_si256((const __m256i*)(w + half));
+                const __m256i inverse = _mm256_sub_epi32(_mm256_set1_epi32(64), weight);
+
+                for (int c = 0; c < 3; c++) {
+                    const __m256i a = _mm256_blendv_epi8(_mm256_set1_epi32(e[0][c]), _mm256_set1_epi32(e[2][c]), subset);
+                    const __m256i b = _mm256_blendv_epi8(_mm256_set1_epi32(e[1][c]), _mm256_set1_epi32(e[3][c]), subset);
+
+                    // ((64 - w) * a + w * b + 32) >> 6
+                    __m256i v = _mm256_add_epi32(_mm256_mullo_epi32(inverse, a), _mm256_mullo_epi32(weight, b));
+                    v = _mm256_srai_epi32(_mm256_add_epi32(v, _mm256_set1_epi32(32)), 6);
+
+                    // Scale the magnitude to the half float range, magnitudes scaled to 0 stay +0 as in the reference decoder
+                    if (is_signed) {
+                        const __m256i magnitude = _mm256_srli_epi32(_mm256_mullo_epi32(_mm256_abs_epi32(v), _mm256_set1_epi32(31)), 5);
+                        const __m256i zero = _mm256_cmpeq_epi32(magnitude, _mm256_setzero_si256());
+                        const __m256i sign = _mm256_andnot_si256(zero, _mm256_and_si256(_mm256_srai_epi32(v, 31), _mm256_set1_epi32(0x8000)));
+                        v = _mm256_or_si256(magnitude, sign);
+                    }
+                    else {
+                        v = _mm256_srli_epi32(_mm256_mullo_epi32(v, _mm256_set1_epi32(31)), 6);
+                    }
+
+                    const __m128i packed = _mm_packus_epi32(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1));
+                    _mm_storeu_si128((__m128i*)(h[c] + half), packed);
+                }
+            }
+#else
+            for (uint32_t i = 0; i < 16; i++) {
+                const int s = ((second >> i) & 1) ? 2 : 0;
+                for (int c = 0; c < 3; c++) {
+                    const int v = interpolate(e[s][c], e[s + 1][c], w[i]);
+                    if (is_signed) {
+                        const int magnitude = ((v < 0 ? -v : v) * 31) >> 5;
+                        h[c][i] = uint16_t((v < 0 && magnitude) ? (magnitude | 0x8000) : magnitude);
+                    }
+                    else {
+                        h[c][i] = uint16_t((v * 31) >> 6);
+                    }
+                }
+            }
+#endif
+        }
+
+        // Converts 16 planar half floats per channel to float.
+        void halves_to_floats(const uint16_t h[3][16], float f[3][16]) {
+            for (int c = 0; c < 3; c++) {
+#if defined(TEXPRESS_F16C)
+                _mm256_storeu_ps(f[c], _mm256_cvtph_ps(_mm_loadu_si128((const __m128i*)h[c])));
+                _mm256_storeu_ps(f[c] + 8, _mm256_cvtph_ps(_mm_loadu_si128((const __m128i*)(h[c] + 8))));
+#else
+                for (int i = 0; i < 16; i++) {
+                    f[c][i] = fp16_ieee_to_fp32_value(h[c][i]);
+                }
+#endif
+            }
+        }
+
+        // Decodes the block rows [row_begin, row_end) of a slice into interleaved texels.
+        void decode_rows(const uint8_t* blocks, uint32_t dim_x, uint32_t dim_y, uint32_t row_begin, uint32_t row_end, bool is_signed, uint8_t channels, uint8_t bits, uint8_t* output) {
+            const uint32_t blocks_x = (dim_x + 3) / 4;
+            const uint8_t rgb_channels = std::min<uint8_t>(channels, 3);
+
+            alignas(32) uint16_t h[3][16];
+            alignas(32) float f[3][16];
+            for (uint32_t by = row_begin; by < row_end; by++) {
+                for (uint32_t bx = 0; bx < blocks_x; bx++) {
+                    decode_block(blocks + ((uint64_t)by * blocks_x + bx) * BC6H_BLOCK_BYTES, is_signed, h);
+                    if (bits == 32) {
+                        halves_to_floats(h, f);
+                    }
+
+                    const uint32_t width = std::min(4u, dim_x - bx * 4);
+                    const uint32_t height = std::min(4u, dim_y - by * 4);
+                    for (uint32_t y = 0; y < height; y++) {
+                        uint64_t dst = (((uint64_t)by * 4 + y) * dim_x + (uint64_t)bx * 4) * channels;
+                        for (uint32_t x = 0; x < width; x++) {
+                            const uint32_t i = y * 4 + x;
+                            if (bits == 32) {
+                                float* out = reinterpret_cast<float*>(output) + dst;
+                                for (uint8_t c = 0; c < rgb_channels; c++) {
+                                    out[c] = f[c][i];
+                                }
+                                if (channels == 4) {
+                                    out[3] = 1.0f;
+                                }
+                            }
+                            else {
+                                uint16_t* out = reinterpret_cast<uint16_t*>(output) + dst;
+                                for (uint8_t c = 0; c < rgb_channels; c++) {
+                                    out[c] = h[c][i];
+                                }
+                                if (channels == 4) {
+                                    out[3] = 0x3C00;
+                                }
+                            }
+                            dst += channels;
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    uint64_t bc6h_encoded_size(uint32_t dim_x, uint32_t dim_y) {
+        uint64_t blocks_x = (dim_x + 3) / 4;
+        uint64_t blocks_y = (dim_y + 3) / 4;
+        return blocks_x * blocks_y * BC6H_BLOCK_BYTES;
+    }
+
+    void bc6h_encode_block(const float* rgb, const BC6HOptions& options, uint8_t* block) {
+        pack_block(encode_block(make_input(rgb, options), options.quality), block);
+    }
+
+    bool bc6h_encode_slice(const uint8_t* data_ptr, uint32_t dim_x, uint32_t dim_y, uint8_t channels, uint8_t bits, const BC6HOptions& options, uint8_t* output) {
+        if (!data_ptr || !output || channels < 1 || channels > 4 || (bits != 16 && bits != 32))
+            return false;
+
+        const uint32_t blocks_x = (dim_x + 3) / 4;
+        const uint32_t blocks_y = (dim_y + 3) / 4;
+        const uint8_t used_channels = std::min<uint8_t>(channels, 3);
+
+        const float* f_ptr = reinterpret_cast<const float*>(data_ptr);
+        const uint16_t* h_ptr = reinterpret_cast<const uint16_t*>(data_ptr);
+
+        float rgb[3 * 16];
+        for (uint32_t by = 0; by < blocks_y; by++) {
+            for (uint32_t bx = 0; bx < blocks_x; bx++) {
+                for (uint32_t i = 0; i < 16; i++) {
+                    // Repeat the border texels in partial blocks
+                    uint64_t x = std::min(bx * 4 + (i & 3), dim_x - 1);
+                    uint64_t y = std::min(by * 4 + (i >> 2), dim_y - 1);
+                    uint64_t src = (y * dim_x + x) * channels;
+
+                    for (uint8_t c = 0; c < 3; c++) {
+                        float value = 0.0f;
+                        if (c < used_channels) {
+                            value = (bits == 32) ? f_ptr[src + c] : fp16_ieee_to_fp32_value(h_ptr[src + c]);
+                        }
+                        rgb[c * 16 + i] = value;
+                    }
+                }
+
+                bc6h_encode_block(rgb, options, output + ((uint64_t)by * blocks_x + bx) * BC6H_BLOCK_BYTES);
+            }
+        }
+
+        return true;
+    }
+
+    void bc6h_decode_block(const uint8_t* block, bool is_signed, uint16_t* rgb) {
+        alignas(32) uint16_t h[3][16];
+        decode_block(block, is_signed, h);
+
+        for (int i = 0; i < 16; i++) {
+            for (int c = 0; c < 3; c++) {
+                rgb[i * 3 + c] = h[c][i];
+            }
+        }
+    }
+
+    bool bc6h_decode_slice(const uint8_t* blocks, uint32_t dim_x, uint32_t dim_y, bool is_signed, uint8_t channels, uint8_t bits, uint8_t* output) {
+        return bc6h_decode_volume(blocks, dim_x, dim_y, 1, is_signed, channels, bits, output, 1);
+    }
+
+    bool bc6h_decode_volume(const uint8_t* blocks, uint32_t dim_x, uint32_t dim_y, uint64_t slices, bool is_signed, uint8_t channels, uint8_t bits, uint8_t* output, uint32_t threads) {
+        if (!blocks || !output || channels < 1 || channels > 4 || (bits != 16 && bits != 32))
+            return false;
+
+        const uint32_t blocks_y = (dim_y + 3) / 4;
+        const uint64_t slice_bytes_in = bc6h_encoded_size(dim_x, dim_y);
+        const uint64_t slice_bytes_out = (uint64_t)dim_x * dim_y * channels * (bits / 8);
+
+        // Jobs are runs of block rows, small enough to balance the workers, large enough to keep them streaming.
+        const uint32_t rows_per_job = std::max<uint32_t>(1, 16384 / std::max<uint32_t>(1, (dim_x + 3) / 4));
+        const uint64_t jobs_per_slice = (blocks_y + rows_per_job - 1) / rows_per_job;
+        const uint64_t jobs = jobs_per_slice * slices;
+
+        parallel_for(jobs, threads, [&](uint64_t job) {
+            const uint64_t slice = job / jobs_per_slice;
+            const uint32_t row_begin = uint32_t(job % jobs_per_slice) * rows_per_job;
+            const uint32_t row_end = std::min(row_begin + rows_per_job, blocks_y);
+            decode_rows(blocks + slice * slice_bytes_in, dim_x, dim_y, row_begin, row_end, is_signed, channels, bits, output + slice * slice_bytes_out);
+        });
+
+        return true;
+    }
+}
@@ -0,0 +1,300 @@
+#include <texpress/compression/bricks.hpp>
+#include <texpress/compression/bc6h.hpp>
+#include <texpress/helpers/threadhelper.hpp>
+#include <texpress/io/file_io.hpp>
+#include <texpress/utility/normalizer.hpp>
+#include <spdlog/spdlog.h>
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+
+namespace texpress {
+    namespace {
+        const uint32_t BRICKED_MAGIC = 0x42505854;      // "TXPB"
+        const uint32_t BRICKED_VERSION = 1;
+
+        // magic, version, dimensions, brick_size, bricks, channels, gl_internal, brick count
+        const uint64_t BRICKED_HEADER_BYTES = 2 * sizeof(uint32_t) + sizeof(glm::ivec4) + sizeof(glm::ivec3) + sizeof(glm::ivec4) + 2 * sizeof(uint32_t) + sizeof(uint64_t);
+
+        uint64_t bricked_data_offset(uint64_t bricks) {
+            return BRICKED_HEADER_BYTES + (bricks + 1) * sizeof(uint64_t);
+        }
+    }
+
+    uint64_t BrickedVolume::brick_count() const {
+        return (uint64_t)bricks.x * (uint64_t)bricks.y * (uint64_t)bricks.z * (uint64_t)bricks.w;
+    }
+
+    uint64_t BrickedVolume::brick_bytes(uint64_t id) const {
+        return directory[id + 1] - directory[id];
+    }
+
+    uint64_t BrickedVolume::brick_id(const glm::ivec4& voxel) const {
+        uint64_t bx = voxel.x / brick_size.x;
+        uint64_t by = voxel.y / brick_size.y;
+        uint64_t bz = voxel.z / brick_size.z;
+        return ((voxel.w * (uint64_t)bricks.z + bz) * (uint64_t)bricks.y + by) * (uint64_t)bricks.x + bx;
+    }
+
+    glm::ivec4 BrickedVolume::brick_origin(uint64_t id) const {
+        glm::ivec4 origin;
+        origin.x = (id % bricks.x) * brick_size.x;
+        id /= bricks.x;
+        origin.y = (id % bricks.y) * brick_size.y;
+        id /= bricks.y;
+        origin.z = (id % bricks.z) * brick_size.z;
+        origin.w = id / bricks.z;
+        return origin;
+    }
+
+    glm::ivec3 BrickedVolume::brick_extent(uint64_t id) const {
+        glm::ivec4 origin = brick_origin(id);
+        return {
+            std::min(brick_size.x, dimensions.x - origin.x),
+            std::min(brick_size.y, dimensions.y - origin.y),
+            std::min(brick_size.z, dimensions.z - origin.z)
+        };
+    }
+
+    bool compress_bricked(const EncoderSettings& settings, const EncoderData& input, BrickedVolume& output, const glm::ivec3& brick_size) {
+        if (settings.encoding != nvtt::Format_BC6S && settings.encoding != nvtt::Format_BC6U) {
+            spdlog::error("Bricked compression supports BC6H only");
+            return false;
+        }
+
+        if (!input.data_ptr || brick_size.x < 1 || brick_size.y < 1 || brick_size.z < 1) {
+            spdlog::error("Invalid input for bricked compression");
+            return false;
+        }
+
+        output.dimensions = { input.dim_x, input.dim_y, std::max(input.dim_z, 1u), std::max(input.dim_t, 1u) };
+        output.brick_size = brick_size;
+        output.bricks = {
+            (output.dimensions.x + brick_size.x - 1) / brick_size.x,
+            (output.dimensions.y + brick_size.y - 1) / brick_size.y,
+            (output.dimensions.z + brick_size.z - 1) / brick_size.z,
+            output.dimensions.w
+        };
+        output.channels = input.channels;
+        output.gl_internal = (settings.encoding == nvtt::Format_BC6S) ? gl::GLenum::GL_COMPRESSED_RGB_BPTC_SIGNED_FLOAT : gl::GLenum::GL_COMPRESSED_RGB_BPTC_UNSIGNED_FLOAT;
+
+        // BC6H sizes only depend on the extents, so the directory is known before compressing
+        const uint64_t bricks = output.brick_count();
+        output.directory.resize(bricks + 1);
+        output.directory[0] = 0;
+        for (uint64_t id = 0; id < bricks; id++) {
+            glm::ivec3 extent = output.brick_extent(id);
+            output.directory[id + 1] = output.directory[id] + bc6h_encoded_size(extent.x, extent.y) * extent.z;
+        }
+        output.data.resize(output.directory.back());
+
+        // Fused normalization: the encoder indexes peaks by the slices of its input, so every brick gets the peaks of
+        // its own (t, z) slices, volume peaks are reduced once for all bricks
+        const bool normalizing = !settings.normalize_peaks.empty();
+        const bool slice_peaks = normalizing && settings.normalize_mode == NormalizeMode::NORMALIZE_SLICE;
+        const uint64_t peaks_required = (slice_peaks) ? 2 * (uint64_t)output.dimensions.z * output.dimensions.w * input.channels : 2 * (uint64_t)input.channels;
+        if (normalizing && settings.normalize_peaks.size() < peaks_required) {
+            spdlog::error("Normalizing while compressing requires {0} peaks", peaks_required);
+            return false;
+        }
+
+        const uint64_t voxels = (uint64_t)output.dimensions.x * (uint64_t)output.dimensions.y * (uint64_t)output.dimensions.z * (uint64_t)output.dimensions.w;
+        const uint64_t texel_bytes = input.data_bytes / voxels;
+        const uint64_t row_bytes = texel_bytes * output.dimensions.x;
+
+        std::atomic<uint64_t> next_brick = 0;
+        std::atomic<uint64_t> bricks_done = 0;
+        std::atomic<int> percentage = 0;
+        std::atomic<bool> failed = false;
+
+        // Shared by all workers, every call only touches its own brick
+        const Encoder encoder;
+
+        run_workers(worker_count(settings.threads, bricks), [&](uint32_t) {
+            int brick_progress = 0;
+            EncoderSettings brick_settings = settings;
+            brick_settings.threads = 1;
+            brick_settings.progress_ptr = &brick_progress;
+            if (normalizing && !slice_peaks) {
+                brick_settings.normalize_peaks = volume_peaks(settings.normalize_peaks, input.channels);
+            }
+
+            std::vector<uint8_t> scratch((uint64_t)brick_size.x * brick_size.y * brick_size.z * texel_bytes);
+
+            for (uint64_t id = next_brick++; id < bricks && !failed; id = next_brick++) {
+                const glm::ivec4 origin = output.brick_origin(id);
+                const glm::ivec3 extent = output.brick_extent(id);
+                const uint64_t brick_row_bytes = extent.x * texel_bytes;
+
+                // Gather the brick into a contiguous slice stack
+                for (uint64_t z = 0; z < extent.z; z++) {
+                    for (uint64_t y = 0; y < extent.y; y++) {
+                        uint64_t src = (((uint64_t)origin.w * output.dimensions.z + origin.z + z) * output.dimensions.y + origin.y + y) * row_bytes + origin.x * texel_bytes;
+                        std::memcpy(scratch.data() + (z * extent.y + y) * brick_row_bytes, input.data_ptr + src, brick_row_bytes);
+                    }
+                }
+
+                if (slice_peaks) {
+                    const uint64_t first_slice = (uint64_t)origin.w * output.dimensions.z + origin.z;
+                    const auto first_peak = settings.normalize_peaks.begin() + 2 * first_slice * input.channels;
+                    brick_settings.normalize_peaks.assign(first_peak, first_peak + 2 * (uint64_t)extent.z * input.channels);
+                }
+
+                EncoderData brick_in = input;
+                brick_in.dim_x = extent.x;
+                brick_in.dim_y = extent.y;
+                brick_in.dim_z = extent.z;
+                brick_in.dim_t = 1;
+                brick_in.data_bytes = brick_row_bytes * extent.y * extent.z;
+                brick_in.data_ptr = scratch.data();
+
+                EncoderData brick_out{};
+                brick_out.data_bytes = output.brick_bytes(id);
+                brick_out.data_ptr = output.data.data() + output.directory[id];
+
+                if (!encoder.compress(brick_settings, brick_in, brick_out)) {
+                    spdlog::error("Compressing brick {0} failed", id);
+                    failed = true;
+                    return;
+                }
+
+                int p = int((100 * ++bricks_done) / bricks);
+                int current = percentage.load();
+                if (p > current && percentage.compare_exchange_strong(current, p)) {
+                    if (settings.progress_ptr) {
+                        *settings.progress_ptr = p;
+                    }
+                    else {
+                        printf("\r%d%%", p);
+                        fflush(stdout);
+                    }
+                }
+            }
+        });
+
+        return !failed;
+    }
+
+    bool decompress_brick(const BrickedVolume& volume, uint64_t id, Texture& output, uint8_t channels, const uint8_t* blocks) {
+        if (id >= volume.brick_count()) {
+            spdlog::error("Brick {0} out of range", id);
+            return false;
+        }
+
+        if (!blocks) {
+            if (volume.data.size() < volume.directory.back()) {
+                spdlog::error("Brick data not loaded");
+                return false;
+            }
+            blocks = volume.data.data() + volume.directory[id];
+        }
+
+        const glm::ivec3 extent = volume.brick_extent(id);
+        output.channels = std::clamp<uint8_t>(channels, 1, 4);
+        output.dimensions = { extent.x, extent.y, extent.z, 1 };
+        output.gl_internal = gl_internal(output.channels, 32, true);
+        output.gl_format = gl_format(output.channels);
+        output.gl_type = gl::GLenum::GL_FLOAT;
+        output.data.resize((uint64_t)extent.x * extent.y * extent.z * output.channels * sizeof(float));
+
+        const bool is_signed = volume.gl_internal == gl::GLenum::GL_COMPRESSED_RGB_BPTC_SIGNED_FLOAT;
+        return bc6h_decode_volume(blocks, extent.x, extent.y, extent.z, is_signed, output.channels, 32, output.data.data(), 1);
+    }
+
+    bool save_bricked(const char* path, const BrickedVolume& volume) {
+        const uint64_t bricks = volume.brick_count();
+        if (volume.directory.size() != bricks + 1 || volume.data.size() != volume.directory.back()) {
+            spdlog::error("Bricked volume is incomplete");
+            return false;
+        }
+
+        std::vector<uint8_t> header;
+        auto append = [&header](const void* ptr, uint64_t bytes) {
+            header.insert(header.end(), (const uint8_t*)ptr, (const uint8_t*)ptr + bytes);
+        };
+
+        uint32_t channels = volume.channels;
+        uint32_t gl_internal = (uint32_t)volume.gl_internal;
+        append(&BRICKED_MAGIC, sizeof(BRICKED_MAGIC));
+        append(&BRICKED_VERSION, sizeof(BRICKED_VERSION));
+        append(&volume.dimensions.x, sizeof(volume.dimensions));
+        append(&volume.brick_size.x, sizeof(volume.brick_size));
+        append(&volume.bricks.x, sizeof(volume.bricks));
+        append(&channels, sizeof(channels));
+        append(&gl_internal, sizeof(gl_internal));
+        append(&bricks, sizeof(bricks));
+        append(volume.directory.data(), volume.directory.size() * sizeof(uint64_t));
+
+        return file_save(path, (char*)header.data(), header.size())
+            && file_save(path, (char*)volume.data.data(), volume.data.size(), true);
+    }
+
+    bool load_bricked(const char* path, BrickedVolume& volume, bool load_data) {
+        std::vector<uint8_t> header(BRICKED_HEADER_BYTES);
+        if (!file_exists(path) || file_size(path) < header.size() || !file_read(path, (char*)header.data(), header.size())) {
+            spdlog::error("Bricked volume " + std::string(path) + " could not be read");
+            return false;
+        }
+
+        uint64_t pos = 0;
+        auto take = [&](void* ptr, uint64_t bytes) {
+            std::memcpy(ptr, header.data() + pos, bytes);
+            pos += bytes;
+        };
+
+        uint32_t magic, version, channels, gl_internal;
+        uint64_t bricks;
+        take(&magic, sizeof(magic));
+        take(&version, sizeof(version));
+        if (magic != BRICKED_MAGIC || version != BRICKED_VERSION) {
+            spdlog::error(std::string(path) + " is not a texpress bricked volume");
+            return false;
+        }
+
+        take(&volume.dimensions.x, sizeof(volume.dimensions));
+        take(&volume.brick_size.x, sizeof(volume.brick_size));
+        take(&volume.bricks.x, sizeof(volume.bricks));
+        take(&channels, sizeof(channels));
+        take(&gl_internal, sizeof(gl_internal));
+        take(&bricks, sizeof(bricks));
+        volume.channels = channels;
+        volume.gl_internal = gl::GLenum(gl_internal);
+
+        if (bricks != volume.brick_count() || file_size(path) < bricked_data_offset(bricks)) {
+            spdlog::error(std::string(path) + " is truncated");
+            return false;
+        }
+
+        volume.directory.resize(bricks + 1);
+        if (!file_read(path, (char*)volume.directory.data(), volume.directory.size() * sizeof(uint64_t), BRICKED_HEADER_BYTES)) {
+            spdlog::error("Brick directory of " + std::string(path) + " could not be read");
+            return false;
+        }
+
+        // Offsets must start at 0, never decrease and stay inside the file, else brick_bytes and the reads below go wrong
+        const bool monotonic = volume.directory.front() == 0 && std::is_sorted(volume.directory.begin(), volume.directory.end());
+        if (!monotonic || volume.directory.back() > file_size(path) - bricked_data_offset(bricks)) {
+            spdlog::error("Brick directory of " + std::string(path) + " is corrupt");
+            volume.directory.clear();
+            return false;
+        }
+
+        volume.data.clear();
+        if (load_data) {
+            volume.data.resize(volume.directory.back());
+            return file_read(path, (char*)volume.data.data(), volume.data.size(), bricked_data_offset(bricks));
+        }
+
+        return true;
+    }
+
+    bool read_brick(const char* path, const BrickedVolume& volume, uint64_t id, std::vector<uint8_t>& blocks) {
+        if (id >= volume.brick_count() || volume.directory.size() != volume.brick_count() + 1) {
+            spdlog::error("Brick {0} out of range", id);
+            return false;
+        }
+
+        blocks.resize(volume.brick_bytes(id));
+        return file_read(path, (char*)blocks.data(), blocks.size(), bricked_data_offset(volume.brick_count()) + volume.directory[id]);
+    }
+}
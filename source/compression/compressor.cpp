@@ -1,11 +1,24 @@
 #include <texpress/compression/compressor.hpp>
+#include <texpress/compression/bc6h.hpp>
+#include <texpress/core/trace.hpp>
+#include <texpress/helpers/threadhelper.hpp>
 #include <memory>
+#include <mutex>
+#include <vector>
+#include <algorithm>
+#include <cstring>
+#if !defined(TEXPRESS_HEADLESS)
 #include <globjects/globjects.h>
 #include <globjects/base/StaticStringSource.h>
 #include <glbinding/glbinding.h>
+#endif
 #include <glbinding/gl45/enum.h>
 #include <spdlog/spdlog.h>
 
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
 namespace texpress {
     void Encoder::listener(const Event& e) {
         switch (e.mType) {
@@ -26,38 +39,72 @@ namespace texpress {
         }
     }
 
+    // Progress shared by all workers of one compression call.
+    struct EncoderProgress {
+        std::atomic<uint64_t> bytes = 0;
+        std::mutex mutex;               // Serializes writes to output, a plain int of the caller
+        int percentage = 0;
+        uint64_t total = 0;
+        int* output = nullptr;
+        const std::function<void(uint64_t, uint64_t)>* callback = nullptr;
+
+        void add(uint64_t size);
+    };
+
+    // Only the worker advancing the percentage reports it
+    void EncoderProgress::add(uint64_t size) {
+        if (!total)
+            return;
+
+        uint64_t done = bytes.fetch_add(size) + size;
+        int p = int((100 * done) / total);
+
+        std::lock_guard<std::mutex> lock(mutex);
+        if (callback && *callback) {
+            (*callback)(done, total);
+        }
+
+        if (p > percentage) {
+            percentage = p;
+            if (output) {
+                *output = p;
+            }
+            else {
+                printf("\r%d%%", p);
+                fflush(stdout);
+            }
+        }
+    }
+
+    // Forwards the blocks NVTT emits for a slice straight to their final location in the sink.
     struct nvttOutputHandler : public nvtt::OutputHandler {
     public:
-        nvttOutputHandler(uint8_t* buffer_out);
+        nvttOutputHandler(OutputSink& sink_out);
         virtual ~nvttOutputHandler();
         void beginImage(int size, int width, int height, int depth, int face, int miplevel);
         bool writeData(const void* data, int size);
         void endImage();
-        void setTotal(uint64_t t);
-        void setProgressOutput(int* ptr);
+        void setDestination(uint64_t offset_out, uint64_t bytes_out);
 
     private:
-        uint8_t* buffer;
-        uint64_t total;
-        uint64_t progress;
-        int lastwritten;
-        int percentage;
-        int* progress_output;
+        OutputSink& sink;
+        uint8_t* direct;        // Memory of the current slice if the sink exposes it
+        uint64_t offset;
+        uint64_t bytes;
+        uint64_t written;
     };
 
 
-    nvttOutputHandler::nvttOutputHandler(uint8_t* buffer_out) :
-        buffer(buffer_out)
-        , total(0)
-        , progress(0)
-        , percentage(0)
-        , progress_output(nullptr)
-        , lastwritten(0)
+    nvttOutputHandler::nvttOutputHandler(OutputSink& sink_out) :
+        sink(sink_out)
+        , direct(nullptr)
+        , offset(0)
+        , bytes(0)
+        , written(0)
     {}
 
     nvttOutputHandler::~nvttOutputHandler() {
-        buffer = nullptr;
-        progress_output = nullptr;
+        direct = nullptr;
     }
 
     void nvttOutputHandler::beginImage(int size, int width, int height, int depth, int face, int miplevel) {
@@ -69,51 +116,135 @@ namespace texpress {
     }
 
     bool nvttOutputHandler::writeData(const void* data, int size) {
-        if (!data)
+        if (!data || size < 0 || written + size > bytes)
             return false;
 
-        //memcpy((void*)(buffer + offset), data, size);
+        if (direct) {
+            std::memcpy(direct + written, data, size);
+        }
+        else if (!sink.write(offset + written, data, size)) {
+            return false;
+        }
 
-        uint8_t* ptr = (uint8_t*)data;
-        for (uint32_t i = 0; i < size; i++) {
-            buffer[progress + i] = ptr[i];
+        written += size;
+        return true;
+    }
+
+    // Redirects subsequent writes to a new destination, e.g. the offset of the next slice.
+    void nvttOutputHandler::setDestination(uint64_t offset_out, uint64_t bytes_out) {
+        offset = offset_out;
+        bytes = bytes_out;
+        written = 0;
+        direct = sink.data(offset, bytes);
+    }
+
+    static void setup_compression_options(nvtt::CompressionOptions& compressionOptions, const EncoderSettings& settings) {
+        compressionOptions.setFormat(settings.encoding);
+        compressionOptions.setQuality(settings.quality);
+        //compressionOptions.setPixelType(nvtt::PixelType_Float);
+        if (settings.use_weights) {
+            compressionOptions.setColorWeights(settings.red_weight, settings.green_weight, settings.blue_weight, settings.alpha_weight);
         }
+    }
 
-        // Progress
-        progress += size;
-        int p = int((100 * progress) / total);
-        if (p != percentage) {
-            percentage = p;
+    static BC6HOptions setup_native_options(const EncoderSettings& settings) {
+        BC6HOptions options;
+        options.is_signed = (settings.encoding == nvtt::Format_BC6S);
+
+        switch (settings.quality) {
+        case nvtt::Quality_Fastest:
+            options.quality = BC6HQuality::BC6H_FASTEST;
+            break;
+        case nvtt::Quality_Normal:
+            options.quality = BC6HQuality::BC6H_NORMAL;
+            break;
+        case nvtt::Quality_Production:
+            options.quality = BC6HQuality::BC6H_PRODUCTION;
+            break;
+        case nvtt::Quality_Highest:
+            options.quality = BC6HQuality::BC6H_HIGHEST;
+            break;
+        }
+
+        if (settings.use_weights) {
+            options.weights[0] = settings.red_weight;
+            options.weights[1] = settings.green_weight;
+            options.weights[2] = settings.blue_weight;
+        }
+
+        return options;
+    }
 
-            if (progress_output) {
-                *progress_output = percentage;
+    // Pads texels of 1 to 3 channels to RGBA as NVTT expects them, missing color channels are 0 and alpha is 1.
+    // Every texel is moved as a whole: a single (overlapping) load, a blend with the padding and a store.
+    static void pad_to_rgba(const uint8_t* src, uint64_t texels, uint8_t channels, uint8_t bits, uint8_t* dest) {
+        if (bits == 16) {
+            // 0x3C00 is 1.0, a texel fits into one 64 bit word
+            const uint64_t mask = (channels >= 3) ? 0xFFFFFFFFFFFFull : (channels == 2) ? 0xFFFFFFFFull : 0xFFFFull;
+            const uint64_t alpha = 0x3C00ull << 48;
+            const uint64_t texel_bytes = channels * sizeof(uint16_t);
+            uint64_t* dest_words = reinterpret_cast<uint64_t*>(dest);
+
+            const uint64_t src_bytes = texels * texel_bytes;
+            uint64_t i = 0;
+            for (; i * texel_bytes + sizeof(uint64_t) <= src_bytes; i++) {
+                uint64_t word;
+                std::memcpy(&word, src + i * texel_bytes, sizeof(word));    // reads into the next texels, masked below
+                dest_words[i] = (word & mask) | alpha;
             }
-            else {
-                printf("\r%d%%", percentage);
-                fflush(stdout);
+            for (; i < texels; i++) {
+                uint64_t word = 0;
+                std::memcpy(&word, src + i * texel_bytes, texel_bytes);
+                dest_words[i] = (word & mask) | alpha;
             }
+            return;
         }
-        return true;
-    }
 
-    void nvttOutputHandler::setTotal(uint64_t t) {
-        total = t;
+        const float* f_src = reinterpret_cast<const float*>(src);
+        float* f_dest = reinterpret_cast<float*>(dest);
+        uint64_t i = 0;
+#if defined(__AVX2__)
+        // Blend masks select the padding lanes, i.e. every lane from channels on
+        const __m128 padding = _mm_setr_ps(0.0f, 0.0f, 0.0f, 1.0f);
+        if (channels == 3) {
+            for (; i + 1 < texels; i++) {
+                _mm_storeu_ps(f_dest + i * 4, _mm_blend_ps(_mm_loadu_ps(f_src + i * 3), padding, 0b1000));
+            }
+        }
+        else if (channels == 2) {
+            for (; i < texels; i++) {
+                __m128 rg = _mm_castsi128_ps(_mm_loadl_epi64((const __m128i*)(f_src + i * 2)));
+                _mm_storeu_ps(f_dest + i * 4, _mm_blend_ps(rg, padding, 0b1100));
+            }
+        }
+        else if (channels == 1) {
+            for (; i < texels; i++) {
+                _mm_storeu_ps(f_dest + i * 4, _mm_blend_ps(_mm_load_ss(f_src + i), padding, 0b1110));
+            }
+        }
+#endif
+        for (; i < texels; i++) {
+            for (int c = 0; c < 4; c++) {
+                f_dest[i * 4 + c] = (c < channels) ? f_src[i * channels + c] : (c == 3) ? 1.0f : 0.0f;
+            }
+        }
     }
 
-    void nvttOutputHandler::setProgressOutput(int* ptr) {
-        progress_output = ptr;
+    // Decoding writes halves if the output asks for a 16 bit float format, floats otherwise
+    uint8_t Encoder::decoded_bits(const EncoderData& output) {
+        return (gl_type((gl::GLenum)output.gl_internal) == gl::GLenum::GL_HALF_FLOAT) ? 16 : 32;
     }
 
     uint64_t Encoder::encoded_size(const EncoderSettings& settings, const EncoderData& input) {
+        if (settings.backend == EncoderBackend::BACKEND_NATIVE) {
+            return bc6h_encoded_size(input.dim_x, input.dim_y) * input.dim_z * input.dim_t;
+        }
+
         nvtt::Context context(false);
 
         // Specify what compression settings to use
         nvtt::CompressionOptions compressionOptions;
-        compressionOptions.setFormat(settings.encoding);
-        compressionOptions.setQuality(settings.quality);
-        if (settings.use_weights) {
-            compressionOptions.setColorWeights(settings.red_weight, settings.green_weight, settings.blue_weight, settings.alpha_weight);
-        }
+        setup_compression_options(compressionOptions, settings);
 
         // Setup empty floating-point RGBA image to deduce needed buffersize.
         nvtt::Surface surface;
@@ -123,27 +254,27 @@ namespace texpress {
         return buffer_size;
     }
 
-    uint64_t Encoder::decoded_size(const EncoderData& input, bool hdr) {
-        uint64_t element_bytes = (hdr) ? sizeof(float) : sizeof(uint8_t);
+    uint64_t Encoder::decoded_size(const EncoderData& input, bool hdr, bool half) {
+        uint64_t element_bytes = (hdr) ? ((half) ? sizeof(uint16_t) : sizeof(float)) : sizeof(uint8_t);
         uint64_t decoded_channels = input.channels;
         return input.dim_x * input.dim_y * input.dim_z * input.dim_t * decoded_channels * element_bytes;
     }
 
-    bool Encoder::compress(const EncoderSettings& settings, const EncoderData& input, EncoderData& output) {
-        int add_channel = 0;
-        // Multithread safety
-        if (busy.exchange(true)) {
-            return false;
-        }
-
-        int bits = (input.data_bytes / uint64_t(input.dim_x * input.dim_y * input.dim_z * input.dim_t * uint64_t(input.channels))) * 8ULL;
-
+    bool Encoder::compress(const EncoderSettings& settings, const EncoderData& input, EncoderData& output) const {
         if (!output.data_ptr) {
             spdlog::error("Output Buffer not initialized");
-            busy.store(false);
             return false;
         }
 
+        MemorySink sink(output.data_ptr, output.data_bytes);
+        return compress(settings, input, output, sink);
+    }
+
+    bool Encoder::compress(const EncoderSettings& settings, const EncoderData& input, EncoderData& output, OutputSink& sink) const {
+        TraceScope trace("compress", input.data_bytes);
+        int add_channel = 0;
+        int bits = (input.data_bytes / uint64_t(input.dim_x * input.dim_y * input.dim_z * input.dim_t * uint64_t(input.channels))) * 8ULL;
+
         switch ((gl::GLenum)input.gl_format) {
         case gl::GLenum::GL_RGB:
             add_channel = 1;
@@ -156,40 +287,56 @@ namespace texpress {
             break;
         }
 
-        // Create context which enables CUDA compression for capable GPUs.
-        // Incapable GPUs will fall back to CPU compression.
-        nvtt::Context context(true);
+        const nvtt::InputFormat input_format = (bits == 32) ? nvtt::InputFormat_RGBA_32F : nvtt::InputFormat_RGBA_16F;
 
-        // Specify what compression settings to use
-        nvtt::CompressionOptions compressionOptions;
-        compressionOptions.setFormat(settings.encoding);
-        compressionOptions.setQuality(settings.quality);
-        //compressionOptions.setPixelType(nvtt::PixelType_Float);
-        if (settings.use_weights) {
-            compressionOptions.setColorWeights(settings.red_weight, settings.green_weight, settings.blue_weight, settings.alpha_weight);
+        // Every (t, z) slice compresses to the same size, so each one has a fixed offset in the output.
+        uint64_t slice_size = 0;
+        if (settings.backend == EncoderBackend::BACKEND_NATIVE) {
+            slice_size = bc6h_encoded_size(input.dim_x, input.dim_y);
         }
+        else {
+            nvtt::Context context(false);
+            nvtt::CompressionOptions compressionOptions;
+            setup_compression_options(compressionOptions, settings);
 
-        // Setup empty floating-point RGBA image to deduce needed buffersize.
-        nvtt::Surface surface;
-        surface.setImage(bits == 32 ? nvtt::InputFormat_RGBA_32F : nvtt::InputFormat_RGBA_16F, input.dim_x, input.dim_y, 1, input.data_ptr);
-        uint64_t buffer_size = context.estimateSize(surface, 1, compressionOptions) * input.dim_z * input.dim_t;
-
-        if (buffer_size > output.data_bytes) {
-            spdlog::error("Output Buffer {0} bytes too small", buffer_size - output.data_bytes);
-            busy.store(false);
-            return false;
+            nvtt::Surface surface;
+            surface.setImage(input_format, input.dim_x, input.dim_y, 1, input.data_ptr);
+            slice_size = context.estimateSize(surface, 1, compressionOptions);
         }
 
-        // Custom output handler to show progress.
-        nvttOutputHandler outputHandler(output.data_ptr);
-        outputHandler.setTotal(buffer_size);
-        if (settings.progress_ptr) {
-            outputHandler.setProgressOutput(settings.progress_ptr);
+        const uint64_t slices = (uint64_t)input.dim_z * (uint64_t)input.dim_t;
+        const uint64_t slice_bytes_in = input.data_bytes / slices;
+        const uint64_t slice_texels = (uint64_t)input.dim_x * (uint64_t)input.dim_y;
+        uint64_t buffer_size = slice_size * slices;
+
+        // Fused normalization: slices are normalized into a per worker scratch buffer, the normalized volume never exists as a whole
+        const bool normalizing = !settings.normalize_peaks.empty();
+        std::vector<float> volume_peaks_norm;
+        if (normalizing) {
+            const uint64_t peaks_required = (settings.normalize_mode == NormalizeMode::NORMALIZE_SLICE) ? 2 * slices * input.channels : 2 * (uint64_t)input.channels;
+            if ((bits != 16 && bits != 32) || settings.normalize_peaks.size() < peaks_required) {
+                spdlog::error("Normalizing while compressing requires half or float input and {0} peaks", peaks_required);
+                return false;
+            }
+
+            if (settings.normalize_mode == NormalizeMode::NORMALIZE_VOLUME) {
+                volume_peaks_norm = volume_peaks(settings.normalize_peaks, input.channels);
+            }
         }
 
-        // Official output handler which registers the custom handler.
-        nvtt::OutputOptions outputOptions;
-        outputOptions.setOutputHandler((nvtt::OutputHandler*)&outputHandler);
+        // Normalizes a slice into scratch, keeping the precision of the input
+        auto normalize_input = [&](uint64_t slice, const uint8_t* data_ptr, uint8_t* scratch) {
+            const float* peaks = (settings.normalize_mode == NormalizeMode::NORMALIZE_SLICE) ? settings.normalize_peaks.data() + 2 * slice * input.channels : volume_peaks_norm.data();
+            if (bits == 16)
+                normalize_slice(reinterpret_cast<const uint16_t*>(data_ptr), slice_texels, input.channels, peaks, 16, scratch);
+            else
+                normalize_slice(reinterpret_cast<const float*>(data_ptr), slice_texels, input.channels, peaks, 32, scratch);
+        };
+
+        if (buffer_size > sink.size()) {
+            spdlog::error("Output Buffer {0} bytes too small", buffer_size - sink.size());
+            return false;
+        }
 
         // Prepare output
         output.dim_x = input.dim_x;
@@ -207,60 +354,118 @@ namespace texpress {
             break;
         default:
             //spdlog::error("Encoding {0} is unsupported, use BC6H.", settings.encoding);
-
-            busy.store(false);
             return false;
         }
 
-        // Compress whole (time) volume
-        uint64_t offset = 0;
-        uint8_t* data_ptr = nullptr;
+        // Custom progress shared by the output handlers of all workers.
+        EncoderProgress progress;
+        progress.total = buffer_size;
+        progress.output = settings.progress_ptr;
+        progress.callback = &settings.progress_callback;
 
-        if (add_channel) {
-            uint64_t new_size = input.data_bytes * 4 / (input.dim_t * input.dim_z * input.channels);
-            data_ptr = new uint8_t[new_size];
-        }
+        std::atomic<uint64_t> next_slice = 0;
+        std::atomic<bool> failed = false;
+        auto cancelled = [&]() {
+            return settings.cancel_ptr && settings.cancel_ptr->load();
+        };
 
-        for (int t = 0; t < input.dim_t; t++) {
-            for (int z = 0; z < input.dim_z; z++) {
-                if (add_channel) {
-                    uint64_t src_id = offset / sizeof(float);
-                    uint64_t dest_id = 0;
-                    float* f_src = reinterpret_cast<float*>(input.data_ptr);
-                    float* f_dest = reinterpret_cast<float*>(data_ptr);
-                    for (int y = 0; y < input.dim_y; y++) {
-                        for (int x = 0; x < input.dim_x; x++) {
-                            for (int c = 0; c < input.channels; c++) {
-                                f_dest[dest_id] = f_src[src_id];
-                                src_id++;
-                                dest_id++;
-                            }
-
-                            for (int c = 0; c < add_channel; c++) {
-                                f_dest[dest_id] = (input.channels + c == 3) ? 1.0f : 0.0f;
-                                dest_id++;
-                            }
-                        }
-                    }
+        // Each worker owns a context, an output handler and a scratch buffer and pulls (t, z) slices until none are left.
+        // Slices are compressed independently, so the result does not depend on the number of workers.
+        auto worker = [&]() {
+            // Create context which enables CUDA compression for capable GPUs.
+            // Incapable GPUs will fall back to CPU compression.
+            nvtt::Context context(true);
+
+            // Specify what compression settings to use
+            nvtt::CompressionOptions compressionOptions;
+            setup_compression_options(compressionOptions, settings);
+
+            // Custom output handler to write each slice to its offset in the sink.
+            nvttOutputHandler outputHandler(sink);
+
+            // Official output handler which registers the custom handler.
+            nvtt::OutputOptions outputOptions;
+            outputOptions.setOutputHandler((nvtt::OutputHandler*)&outputHandler);
+
+            std::vector<float> padded;
+            if (add_channel) {
+                padded.resize((uint64_t)input.dim_x * (uint64_t)input.dim_y * 4);
+            }
+
+            std::vector<uint8_t> scratch;
+            if (normalizing) {
+                scratch.resize(slice_bytes_in);
+            }
+
+            nvtt::Surface surface;
+            for (uint64_t slice = next_slice++; slice < slices && !failed && !cancelled(); slice = next_slice++) {
+                TraceScope trace_slice("compress/slice", slice_bytes_in);
+                uint8_t* data_ptr = input.data_ptr + slice * slice_bytes_in;
+
+                if (normalizing) {
+                    normalize_input(slice, data_ptr, scratch.data());
+                    data_ptr = scratch.data();
                 }
-                else {
-                    data_ptr = input.data_ptr + offset;
+
+                if (add_channel) {
+                    pad_to_rgba(data_ptr, slice_texels, input.channels, bits, reinterpret_cast<uint8_t*>(padded.data()));
+                    data_ptr = reinterpret_cast<uint8_t*>(padded.data());
                 }
 
-                surface.setImage(bits == 32 ? nvtt::InputFormat_RGBA_32F : nvtt::InputFormat_RGBA_16F, input.dim_x, input.dim_y, 1, data_ptr);
+                surface.setImage(input_format, input.dim_x, input.dim_y, 1, data_ptr);
+                outputHandler.setDestination(slice * slice_size, slice_size);
                 if (!context.compress(surface, 0, 0, compressionOptions, outputOptions)) {
-                    spdlog::error("Compression failed");
-                    busy.store(false);
-                    return false;
+                    spdlog::error("Compression of slice {0} failed", slice);
+                    failed = true;
+                    continue;
+                }
+                progress.add(slice_size);
+            }
+        };
+
+        // The native encoder reads 1 to 4 channels of half or float directly, no padding to RGBA needed.
+        const BC6HOptions native_options = setup_native_options(settings);
+        auto native_worker = [&]() {
+            std::vector<uint8_t> scratch;
+            if (normalizing) {
+                scratch.resize(slice_bytes_in);
+            }
+
+            // Blocks are encoded in place if the sink exposes its memory, else staged per slice
+            std::vector<uint8_t> staging;
+
+            for (uint64_t slice = next_slice++; slice < slices && !failed && !cancelled(); slice = next_slice++) {
+                TraceScope trace_slice("compress/slice", slice_bytes_in);
+                const uint8_t* data_ptr = input.data_ptr + slice * slice_bytes_in;
+
+                if (normalizing) {
+                    normalize_input(slice, data_ptr, scratch.data());
+                    data_ptr = scratch.data();
+                }
+
+                uint8_t* dest = sink.data(slice * slice_size, slice_size);
+                if (!dest) {
+                    staging.resize(slice_size);
+                    dest = staging.data();
                 }
 
-                offset += input.data_bytes / (input.dim_t * input.dim_z);
+                if (!bc6h_encode_slice(data_ptr, input.dim_x, input.dim_y, input.channels, bits, native_options, dest)
+                    || (dest == staging.data() && !sink.write(slice * slice_size, dest, slice_size))) {
+                    spdlog::error("Compression of slice {0} failed", slice);
+                    failed = true;
+                    continue;
+                }
+                progress.add(slice_size);
             }
-        }
+        };
 
-        if (add_channel) {
-            delete[] data_ptr;
-        }
+        const bool native = (settings.backend == EncoderBackend::BACKEND_NATIVE);
+        run_workers(worker_count(settings.threads, slices), [&](uint32_t) {
+            if (native)
+                native_worker();
+            else
+                worker();
+        });
 
         /*
         surface.setImage(nvtt::InputFormat_RGBA_32F, input.dim_x, input.dim_y, input.dim_z, input.data_ptr);
@@ -270,97 +475,72 @@ namespace texpress {
           return false;
         }
         */
-        busy.store(false);
-        return true;
-    }
-
-    bool Encoder::decompress(const EncoderData& input, EncoderData& output) {
-        // Multithread safety
-        if (busy.exchange(true)) {
+        if (cancelled()) {
+            spdlog::info("Compression cancelled");
             return false;
         }
 
+        return !failed;
+    }
+
+    bool Encoder::decompress(const EncoderData& input, EncoderData& output) const {
         if (input.gl_internal == (uint32_t)gl::GLenum::GL_COMPRESSED_RGB_BPTC_SIGNED_FLOAT) {
-            busy.store(false);
             //return decompress_gpu(nvtt::Format::Format_BC6S, input, output);
 
             return decompress(nvtt::Format::Format_BC6S, input, output);
         }
 
         if (input.gl_internal == (uint32_t)gl::GLenum::GL_COMPRESSED_RGB_BPTC_UNSIGNED_FLOAT) {
-            busy.store(false);
             return decompress(nvtt::Format::Format_BC6U, input, output);
         }
 
         spdlog::error("Could not deduce nvtt encoding of gl_internal with value {0}.", input.gl_internal);
-        busy.store(false);
         return false;
     }
 
-    bool Encoder::decompress(const EncoderData& input, EncoderData& output, uint64_t slice) {
-        // Multithread safety
-        if (busy.exchange(true)) {
-            return false;
-        }
-
+    bool Encoder::decompress(const EncoderData& input, EncoderData& output, uint64_t slice) const {
         if (input.gl_internal == (uint32_t)gl::GLenum::GL_COMPRESSED_RGB_BPTC_SIGNED_FLOAT) {
-            busy.store(false);
             return decompress(nvtt::Format::Format_BC6S, input, output, slice);
         }
 
         if (input.gl_internal == (uint32_t)gl::GLenum::GL_COMPRESSED_RGB_BPTC_UNSIGNED_FLOAT) {
-            busy.store(false);
             return decompress(nvtt::Format::Format_BC6U, input, output, slice);
         }
 
         spdlog::error("Could not deduce nvtt encoding of gl_internal with value {0}.", input.gl_internal);
-        busy.store(false);
         return false;
     }
 
-    bool Encoder::decompress(const nvtt::Format encoding, const EncoderData& input, EncoderData& output) {
-        // Multithread safety
-        if (busy.exchange(true)) {
+    bool Encoder::decompress(const nvtt::Format encoding, const EncoderData& input, EncoderData& output) const {
+        if (!output.data_ptr) {
+            spdlog::error("Output Buffer not initialized");
             return false;
         }
 
-        if (!output.data_ptr) {
-            spdlog::error("Output Buffer not initialized");
-            busy.store(false);
+        if (encoding != nvtt::Format_BC6S && encoding != nvtt::Format_BC6U) {
+            spdlog::error("Decompression supports BC6H only");
             return false;
         }
 
-        int output_channels = 3;
-        uint64_t buffer_size = input.dim_x * input.dim_y * input.dim_z * input.dim_t * output_channels * sizeof(float);
+        uint8_t output_channels = std::clamp<uint8_t>(input.channels, 1, 4);
+        uint8_t output_bits = decoded_bits(output);
+        uint64_t slices = (uint64_t)input.dim_z * (uint64_t)input.dim_t;
+        uint64_t encoded_bytes = bc6h_encoded_size(input.dim_x, input.dim_y) * slices;
+        if (!input.data_ptr || input.data_bytes < encoded_bytes) {
+            spdlog::error("Input Buffer holds {0} of {1} encoded bytes", (input.data_ptr) ? input.data_bytes : 0, encoded_bytes);
+            return false;
+        }
+
+        uint64_t buffer_size = (uint64_t)input.dim_x * (uint64_t)input.dim_y * slices * output_channels * (output_bits / 8);
         if (buffer_size > output.data_bytes) {
             spdlog::error("Output Buffer {0} bytes too small", buffer_size - output.data_bytes);
-            busy.store(false);
             return false;
         }
 
-        // Setup empty floating-point RGBA image to deduce needed buffersize.
-        nvtt::Surface surface;
-        surface.setImage3D(encoding, input.dim_x, input.dim_y, input.dim_z, input.data_ptr);
-
-        const float* r_ptr = (input.channels >= 1) ? surface.channel(0) : nullptr;
-        const float* g_ptr = (input.channels >= 2) ? surface.channel(1) : nullptr;
-        const float* b_ptr = (input.channels >= 3) ? surface.channel(2) : nullptr;
-        const float* a_ptr = (input.channels >= 4) ? surface.channel(3) : nullptr;
-
-        float* out_ptr = reinterpret_cast<float*>(output.data_ptr);
-        for (auto p = 0; p < (uint64_t)input.dim_x * (uint64_t)input.dim_y * (uint64_t)input.dim_z * (uint64_t)input.dim_t; p++) {
-            if (r_ptr) {
-                out_ptr[p * input.channels + 0UL] = r_ptr[p];
-            }
-            if (g_ptr) {
-                out_ptr[p * input.channels + 1UL] = g_ptr[p];
-            }
-            if (b_ptr) {
-                out_ptr[p * input.channels + 2UL] = b_ptr[p];
-            }
-            if (a_ptr) {
-                out_ptr[p * input.channels + 3UL] = a_ptr[p];
-            }
+        // Blocks are decoded straight into interleaved halves or floats, rows of blocks are spread over all hardware threads.
+        if (!bc6h_decode_volume(input.data_ptr, input.dim_x, input.dim_y, slices, encoding == nvtt::Format_BC6S, output_channels, output_bits, output.data_ptr, 0)) {
+            spdlog::error("Decompression failed");
+            return false;
         }
 
         // Prepare output
@@ -369,82 +549,177 @@ namespace texpress {
         output.dim_z = input.dim_z;
         output.dim_t = input.dim_t;
         output.channels = output_channels;
-        //output.gl_format = (uint32_t)gl::GLenum::GL_RGBA;
-        //output.gl_internal = (uint32_t)gl::GLenum::GL_RGBA32F;
-        output.gl_format = (uint32_t)gl_internal(output.channels, 32, true);
+        output.gl_internal = (uint32_t)gl_internal(output.channels, output_bits, true);
         output.gl_format = (uint32_t)gl_format(output.channels);
 
-        busy.store(false);
         return true;
     }
 
-    bool Encoder::decompress(const nvtt::Format encoding, const EncoderData& input, EncoderData& output, uint64_t slice) {
-        // Multithread safety
-        if (busy.exchange(true)) {
+    bool Encoder::decompress(const nvtt::Format encoding, const EncoderData& input, EncoderData& output, uint64_t slice) const {
+        if (!output.data_ptr) {
+            spdlog::error("Output Buffer not initialized");
+            return false;
+        }
+
+        if (encoding != nvtt::Format_BC6S && encoding != nvtt::Format_BC6U) {
+            spdlog::error("Decompression supports BC6H only");
             return false;
         }
 
-        if (!output.data_ptr) {
-            spdlog::error("Output Buffer not initialized");
-            busy.store(false);
+        uint64_t slices = (uint64_t)input.dim_z * (uint64_t)input.dim_t;
+        uint64_t encoded_bytes = bc6h_encoded_size(input.dim_x, input.dim_y) * slices;
+        if (!input.data_ptr || input.data_bytes < encoded_bytes) {
+            spdlog::error("Input Buffer holds {0} of {1} encoded bytes", (input.data_ptr) ? input.data_bytes : 0, encoded_bytes);
             return false;
         }
 
-        output.channels = input.channels;
+        if (slice >= slices) {
+            spdlog::error("Slice {0} outside of the {1} encoded slices", slice, slices);
+            return false;
+        }
+
+        output.channels = std::clamp<uint8_t>(input.channels, 1, 4);
+        uint8_t output_bits = decoded_bits(output);
 
-        uint64_t buffer_size = input.dim_x * input.dim_y * output.channels * sizeof(float);
+        uint64_t buffer_size = (uint64_t)input.dim_x * (uint64_t)input.dim_y * output.channels * (output_bits / 8);
         if (buffer_size > output.data_bytes) {
             spdlog::error("Output Buffer {0} bytes too small", buffer_size - output.data_bytes);
-            busy.store(false);
             return false;
         }
 
-        // Setup empty floating-point RGBA image to deduce needed buffersize.
-        uint64_t offset = slice * input.data_bytes / ((uint64_t)input.dim_z * (uint64_t)input.dim_t);
-        nvtt::Surface surface;
-        surface.setImage3D(encoding, input.dim_x, input.dim_y, 1, input.data_ptr + offset);
-
-        const float* r_ptr = (output.channels >= 1) ? surface.channel(0) : nullptr;
-        const float* g_ptr = (output.channels >= 2) ? surface.channel(1) : nullptr;
-        const float* b_ptr = (output.channels >= 3) ? surface.channel(2) : nullptr;
-        const float* a_ptr = (output.channels >= 4) ? surface.channel(3) : nullptr;
-
-        float* out_ptr = reinterpret_cast<float*>(output.data_ptr);
-        uint32_t processed = 0;
-        for (auto p = 0; p < input.dim_x * input.dim_y; p++) {
-            if (r_ptr) {
-                out_ptr[p * output.channels + 0] = r_ptr[p];
-                processed++;
-            }
-            if (g_ptr) {
-                out_ptr[p * output.channels + 1] = g_ptr[p];
-                processed++;
-            }
-            if (b_ptr) {
-                out_ptr[p * output.channels + 2] = b_ptr[p];
-                processed++;
-            }
-            if (a_ptr) {
-                out_ptr[p * output.channels + 3] = a_ptr[p];
-                processed++;
-            }
+        TraceScope trace("decompress/slice", buffer_size);
+        uint64_t offset = slice * bc6h_encoded_size(input.dim_x, input.dim_y);
+        if (!bc6h_decode_volume(input.data_ptr + offset, input.dim_x, input.dim_y, 1, encoding == nvtt::Format_BC6S, output.channels, output_bits, output.data_ptr, 0)) {
+            spdlog::error("Decompression of slice {0} failed", slice);
+            return false;
         }
 
-        output.data_ptr = reinterpret_cast<uint8_t*>(out_ptr + processed);
+        output.data_ptr += buffer_size;
 
         // Prepare output
         output.dim_x = input.dim_x;
         output.dim_y = input.dim_y;
         output.dim_z += 1;
         output.dim_t = 1;
-        output.gl_format = (uint32_t)gl_internal(output.channels, 32, true);
+        output.gl_internal = (uint32_t)gl_internal(output.channels, output_bits, true);
         output.gl_format = (uint32_t)gl_format(output.channels);
 
-        busy.store(false);
         return true;
     }
 
-    bool Encoder::decompress_gpu(const nvtt::Format encoding, const EncoderData& input, EncoderData& output) {
+    bool Encoder::decompress_volume(const DecompressSettings& settings, const EncoderData& input, EncoderData& output) const {
+        if (!output.data_ptr || !input.data_ptr) {
+            spdlog::error("Output Buffer not initialized");
+            return false;
+        }
+
+        bool is_signed = false;
+        if (input.gl_internal == (uint32_t)gl::GLenum::GL_COMPRESSED_RGB_BPTC_SIGNED_FLOAT) {
+            is_signed = true;
+        }
+        else if (input.gl_internal != (uint32_t)gl::GLenum::GL_COMPRESSED_RGB_BPTC_UNSIGNED_FLOAT) {
+            spdlog::error("Could not deduce nvtt encoding of gl_internal with value {0}.", input.gl_internal);
+            return false;
+        }
+
+        if (settings.t_offset >= input.dim_t || settings.z_offset >= input.dim_z) {
+            spdlog::error("Slice range starts outside of the volume");
+            return false;
+        }
+
+        const uint32_t t_count = (settings.t_count) ? std::min(settings.t_count, input.dim_t - settings.t_offset) : input.dim_t - settings.t_offset;
+        const uint32_t z_count = (settings.z_count) ? std::min(settings.z_count, input.dim_z - settings.z_offset) : input.dim_z - settings.z_offset;
+        const uint64_t slices = (uint64_t)t_count * (uint64_t)z_count;
+
+        const uint8_t output_channels = std::clamp<uint8_t>(input.channels, 1, 4);
+        const uint8_t output_bits = decoded_bits(output);
+        const uint64_t slice_bytes_in = bc6h_encoded_size(input.dim_x, input.dim_y);
+        const uint64_t slice_texels = (uint64_t)input.dim_x * (uint64_t)input.dim_y;
+        const uint64_t slice_bytes_out = slice_texels * output_channels * (output_bits / 8);
+
+        const uint64_t encoded_bytes = slice_bytes_in * input.dim_z * input.dim_t;
+        if (input.data_bytes < encoded_bytes) {
+            spdlog::error("Input Buffer holds {0} of {1} encoded bytes", input.data_bytes, encoded_bytes);
+            return false;
+        }
+
+        if (slice_bytes_out * slices > output.data_bytes) {
+            spdlog::error("Output Buffer {0} bytes too small", slice_bytes_out * slices - output.data_bytes);
+            return false;
+        }
+
+        // Fused denormalization with the peaks of the slice's position in the whole volume
+        const bool denormalizing = !settings.denormalize_peaks.empty();
+        std::vector<float> volume_peaks_denorm;
+        if (denormalizing) {
+            const uint64_t peaks_required = (settings.denormalize_mode == NormalizeMode::NORMALIZE_SLICE) ? 2 * (uint64_t)input.dim_z * input.dim_t * output_channels : 2 * (uint64_t)output_channels;
+            if (settings.denormalize_peaks.size() < peaks_required) {
+                spdlog::error("Denormalizing while decompressing requires {0} peaks", peaks_required);
+                return false;
+            }
+
+            if (settings.denormalize_mode == NormalizeMode::NORMALIZE_VOLUME) {
+                volume_peaks_denorm = volume_peaks(settings.denormalize_peaks, output_channels);
+            }
+        }
+
+        // Few large slices still use all threads, each slice spreads its block rows over the remaining ones
+        const uint32_t workers = worker_count(settings.threads, slices);
+        const uint32_t threads_total = thread_count(settings.threads);
+        const uint32_t slice_threads = std::max(threads_total / workers, 1u);
+
+        TraceScope trace("decompress", slice_bytes_out * slices);
+        std::atomic<uint64_t> next_slice = 0;
+        std::atomic<bool> failed = false;
+
+        run_workers(workers, [&](uint32_t) {
+            for (uint64_t slice = next_slice++; slice < slices && !failed; slice = next_slice++) {
+                TraceScope trace_slice("decompress/slice", slice_bytes_out);
+                const uint64_t t = settings.t_offset + slice / z_count;
+                const uint64_t z = settings.z_offset + slice % z_count;
+                const uint64_t source = t * input.dim_z + z;
+                uint8_t* dest = output.data_ptr + slice * slice_bytes_out;
+
+                if (!bc6h_decode_volume(input.data_ptr + source * slice_bytes_in, input.dim_x, input.dim_y, 1, is_signed, output_channels, output_bits, dest, slice_threads)) {
+                    spdlog::error("Decompression of slice {0} failed", source);
+                    failed = true;
+                    return;
+                }
+
+                if (denormalizing) {
+                    const float* peaks = (settings.denormalize_mode == NormalizeMode::NORMALIZE_SLICE) ? settings.denormalize_peaks.data() + 2 * source * output_channels : volume_peaks_denorm.data();
+                    if (output_bits == 16)
+                        denormalize_slice((const uint16_t*)dest, slice_texels, output_channels, peaks, (uint16_t*)dest);
+                    else
+                        denormalize_slice((const float*)dest, slice_texels, output_channels, peaks, (float*)dest);
+                }
+            }
+        });
+
+        // Prepare output
+        output.dim_x = input.dim_x;
+        output.dim_y = input.dim_y;
+        output.dim_z = z_count;
+        output.dim_t = t_count;
+        output.channels = output_channels;
+        output.gl_internal = (uint32_t)gl_internal(output.channels, output_bits, true);
+        output.gl_format = (uint32_t)gl_format(output.channels);
+
+        return !failed;
+    }
+
+#if defined(TEXPRESS_HEADLESS)
+    // Headless builds have no OpenGL context to decode on
+    bool Encoder::decompress_gpu(const nvtt::Format encoding, const EncoderData& input, EncoderData& output) const {
+        spdlog::error("GPU decompression is unavailable in headless builds");
+        return false;
+    }
+#else
+    bool Encoder::decompress_gpu(const nvtt::Format encoding, const EncoderData& input, EncoderData& output) const {
+        // The shader objects below are shared by all instances
+        static std::mutex gpu_mutex;
+        std::lock_guard<std::mutex> lock(gpu_mutex);
+
         static std::string compute_shader_source_text = R"(#version 450
 
 layout (local_size_x = 4, local_size_y = 4, local_size_z = 1) in;
@@ -511,6 +786,7 @@ void main()
 
         return true;
     }
+#endif
 
 
     bool Encoder::populate_EncoderData(EncoderData& enc_data, Texture& tex_input) {
@@ -533,6 +809,16 @@ void main()
         );
     }
 
+    bool Encoder::populate_EncoderData(EncoderData& enc_data, const TextureView& view_input) {
+        enc_data.gl_format = (uint32_t)view_input.gl_format;
+        enc_data.gl_internal = (uint32_t)view_input.gl_internal;
+
+        return populate_EncoderData_base(enc_data,
+            view_input.dimensions.x, view_input.dimensions.y, view_input.dimensions.z, view_input.dimensions.w,
+            view_input.channels, view_input.bytes(), const_cast<uint8_t*>(view_input.data)
+        );
+    }
+
     bool Encoder::populate_Texture(Texture& tex, EncoderData& enc_data) {
         tex.dimensions = { enc_data.dim_x, enc_data.dim_y, enc_data.dim_z, enc_data.dim_t };
         tex.channels = enc_data.channels;
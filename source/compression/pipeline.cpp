@@ -0,0 +1,567 @@
+#include <texpress/compression/pipeline.hpp>
+#include <texpress/core/trace.hpp>
+#include <spdlog/spdlog.h>
+#include <texpress/helpers/ktxhelper.hpp>
+#include <texpress/io/file_io.hpp>
+#include <texpress/utility/half.hpp>
+#include <texpress/utility/stringtools.hpp>
+#include <texpress/utility/synthetic.hpp>
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+namespace texpress {
+    namespace {
+        typedef std::chrono::high_resolution_clock Clock;
+
+        double seconds_since(const Clock::time_point& t0) {
+            return std::chrono::duration<double>(Clock::now() - t0).count();
+        }
+
+        std::string extension(const std::string& path) {
+            return str_lowercase(std::filesystem::path(path).extension().string());
+        }
+
+        // Raw floats with dimensions in a leading header or a "_dims" sidecar, as saved by the GUI
+        bool load_raw(const PipelineSettings& settings, Texture& tex) {
+            const std::string& path = settings.input_path;
+            auto path_dims = std::filesystem::path(path).replace_extension("").string() + "_dims" + std::filesystem::path(path).extension().string();
+            uint64_t header_bytes = 0;
+
+            if (std::filesystem::exists(path_dims)) {
+                file_read(path_dims.c_str(), (char*)&tex.dimensions.x, sizeof(tex.dimensions));
+            }
+            else {
+                file_read(path.c_str(), (char*)&tex.dimensions.x, sizeof(tex.dimensions));
+                header_bytes = sizeof(tex.dimensions);
+            }
+
+            uint64_t elements = (uint64_t)tex.dimensions.x * (uint64_t)tex.dimensions.y * (uint64_t)tex.dimensions.z * (uint64_t)tex.dimensions.w;
+            if (!elements) {
+                spdlog::error("Invalid dimensions in " + path);
+                return false;
+            }
+
+            uint64_t values = (file_size(path.c_str()) - header_bytes) / sizeof(float);
+            tex.channels = values / elements;
+            if (tex.channels < 1 || tex.channels > 4) {
+                spdlog::error("Unsupported number of channels {0}", tex.channels);
+                return false;
+            }
+
+            const uint8_t bits = (settings.half) ? 16 : 32;
+            tex.gl_internal = gl_internal(tex.channels, bits, true);
+            tex.gl_format = gl_format(tex.channels);
+            tex.gl_type = (settings.half) ? gl::GLenum::GL_HALF_FLOAT : gl::GLenum::GL_FLOAT;
+            tex.data.resize(values * (bits / 8));
+
+            if (settings.half)
+                return file_read_half(path.c_str(), (uint16_t*)tex.data.data(), values, header_bytes);
+
+            return file_read(path.c_str(), (char*)tex.data.data(), tex.data.size(), header_bytes);
+        }
+
+        bool load_hdf5(const PipelineSettings& settings, Texture& tex) {
+            if (settings.datasets.empty()) {
+                spdlog::error("No HDF5 datasets given");
+                return false;
+            }
+
+            hdf5 file(settings.input_path.c_str());
+            auto dims = file.region_dimensions(settings.datasets[0].c_str(), settings.region);
+            if (dims.empty())
+                return false;
+
+            for (int i = 0; i < tex.dimensions.length(); i++) {
+                tex.dimensions[i] = (i < dims.size()) ? dims[i] : 1;
+            }
+
+            tex.channels = settings.datasets.size();
+            tex.gl_internal = gl_internal(tex.channels, (settings.half) ? 16 : 32, true);
+            tex.gl_format = gl_format(tex.channels);
+            tex.gl_type = (settings.half) ? gl::GLenum::GL_HALF_FLOAT : gl::GLenum::GL_FLOAT;
+
+            return file.read_region<float>(settings.datasets, settings.region, tex.data, settings.encoder.threads, settings.half);
+        }
+
+        bool load_input(const PipelineSettings& settings, Texture& tex) {
+            // Synthetic regression input, generated instead of loaded
+            ABCSettings abc;
+            abc.threads = settings.encoder.threads;
+            if (parse_abc(settings.input_path, abc)) {
+                if (!settings.half)
+                    return generate_abc(abc, tex);
+
+                Texture field;
+                return generate_abc(abc, field) && convert_texture(field, tex, 16, settings.encoder.threads);
+            }
+
+            if (!std::filesystem::exists(settings.input_path)) {
+                spdlog::error("Input " + settings.input_path + " does not exist");
+                return false;
+            }
+
+            auto ext = extension(settings.input_path);
+            if (ext == ".raw")
+                return load_raw(settings, tex);
+
+            if (ext == ".h5" || ext == ".hdf5" || ext == ".hdf")
+                return load_hdf5(settings, tex);
+
+            if (ext == ".ktx") {
+                load_ktx(settings.input_path.c_str(), tex);
+                return !tex.data.empty();
+            }
+
+            spdlog::error("Unsupported input " + settings.input_path);
+            return false;
+        }
+
+        bool load_source(const PipelineSettings& settings, Texture& tex) {
+            TraceScope trace("load");
+            const bool loaded = load_input(settings, tex);
+            trace.set_bytes(tex.bytes());
+            return loaded;
+        }
+
+        // KTX or raw with a "_dims" sidecar, as streaming writes it
+        bool save_texture(const Texture& tex, const std::string& path) {
+            TraceScope trace("save", tex.bytes());
+            if (extension(path) == ".ktx")
+                return save_ktx(tex, path.c_str());
+
+            const std::string path_dims = std::filesystem::path(path).replace_extension("").string() + "_dims.raw";
+            return file_save(path_dims.c_str(), (char*)&tex.dimensions.x, sizeof(tex.dimensions))
+                && file_save(path.c_str(), (char*)tex.data.data(), tex.bytes());
+        }
+
+        std::vector<uint64_t> split_numbers(const std::string& list) {
+            std::vector<uint64_t> numbers;
+            std::stringstream stream(list);
+            std::string item;
+            while (std::getline(stream, item, ',')) {
+                numbers.push_back(std::stoull(item));
+            }
+            return numbers;
+        }
+
+        std::vector<std::string> split_list(const std::string& list) {
+            std::vector<std::string> items;
+            std::stringstream stream(list);
+            std::string item;
+            while (std::getline(stream, item, ',')) {
+                if (!item.empty())
+                    items.push_back(item);
+            }
+            return items;
+        }
+    }
+
+    bool run_pipeline(const PipelineSettings& settings, PipelineStats* stats) {
+        TraceScope trace("pipeline");
+        PipelineStats result;
+        auto finish = [&](bool success) {
+            result.success = success;
+            if (stats)
+                *stats = result;
+            return success;
+        };
+
+        // Load
+        auto t0 = Clock::now();
+        Texture tex_source;
+        if (!load_source(settings, tex_source)) {
+            spdlog::error("Loading " + settings.input_path + " failed");
+            return finish(false);
+        }
+        result.bytes_source = tex_source.bytes();
+        trace.set_bytes(result.bytes_source);
+        result.seconds_load = seconds_since(t0);
+
+        Texture tex_normalized;
+        Texture tex_encoded;
+        BrickedVolume bricked;
+        std::vector<float> peaks;
+        const bool normalizing = settings.normalize != PipelineNormalize::PIPELINE_NORMALIZE_NONE;
+        const NormalizeMode mode = (settings.normalize == PipelineNormalize::PIPELINE_NORMALIZE_VOLUME) ? NormalizeMode::NORMALIZE_VOLUME : NormalizeMode::NORMALIZE_SLICE;
+        const uint8_t bits = float_bits(tex_source);
+
+        if (tex_source.compressed()) {
+            // Already encoded, only the decoding stages apply
+            tex_encoded = std::move(tex_source);
+            tex_source = Texture();
+        }
+        else {
+            if (!bits) {
+                spdlog::error("Unsupported data type in " + settings.input_path);
+                return finish(false);
+            }
+
+            EncoderSettings encoder_settings = settings.encoder;
+
+            // Normalize
+            t0 = Clock::now();
+            if (normalizing && settings.fused) {
+                const bool found = (bits == 16) ? find_peaks_parallel((const uint16_t*)tex_source.data.data(), tex_source.dimensions, tex_source.channels, peaks, encoder_settings.threads)
+                    : find_peaks_parallel((const float*)tex_source.data.data(), tex_source.dimensions, tex_source.channels, peaks, encoder_settings.threads);
+                if (!found)
+                    return finish(false);
+
+                encoder_settings.normalize_peaks = peaks;
+                encoder_settings.normalize_mode = mode;
+            }
+            else if (normalizing) {
+                if (!normalize(tex_source, tex_normalized, peaks, mode, bits, encoder_settings.threads))
+                    return finish(false);
+            }
+            result.seconds_normalize = seconds_since(t0);
+
+            // Compress
+            t0 = Clock::now();
+            Texture& tex_input = (normalizing && !settings.fused) ? tex_normalized : tex_source;
+            EncoderData input{};
+            Encoder::populate_EncoderData(input, tex_input);
+            input.gl_format = (uint32_t)tex_input.gl_format;
+            input.gl_internal = (uint32_t)tex_input.gl_internal;
+
+            EncoderData output{};
+            Encoder::initialize_buffer(tex_encoded.data, encoder_settings, input);
+            Encoder::populate_EncoderData(output, tex_encoded);
+
+            Encoder encoder;
+            if (!encoder.compress(encoder_settings, input, output)) {
+                spdlog::error("Compressing " + settings.input_path + " failed");
+                return finish(false);
+            }
+            if (!encoder_settings.progress_ptr) {
+                printf("\n");
+            }
+            Encoder::populate_Texture(tex_encoded, output);
+
+            // Bricked layout of the same input, for spatially local access
+            if (!settings.bricked_path.empty()) {
+                if (!compress_bricked(encoder_settings, input, bricked, settings.brick_size)) {
+                    spdlog::error("Bricked compression of " + settings.input_path + " failed");
+                    return finish(false);
+                }
+                if (!encoder_settings.progress_ptr) {
+                    printf("\n");
+                }
+            }
+            result.seconds_compress = seconds_since(t0);
+
+            // The normalized copy is only needed again as reference of normalized decoded data
+            if (settings.denormalize || !settings.error) {
+                tex_normalized = Texture();
+            }
+        }
+        result.bytes_compressed = tex_encoded.bytes();
+
+        // Decompress
+        Texture tex_decoded;
+        if (settings.decompress || settings.error || !settings.decoded_path.empty()) {
+            t0 = Clock::now();
+            EncoderData input{};
+            Encoder::populate_EncoderData(input, tex_encoded);
+            input.gl_internal = (uint32_t)tex_encoded.gl_internal;
+
+            EncoderData output{};
+            output.gl_internal = (uint32_t)gl_internal(std::clamp<int>(input.channels, 1, 4), (settings.half) ? 16 : 32, true);
+            output.data_bytes = Encoder::decoded_size(input, true, settings.half);
+            tex_decoded.data.resize(output.data_bytes);
+            output.data_ptr = tex_decoded.data.data();
+
+            DecompressSettings decompress_settings;
+            decompress_settings.threads = settings.encoder.threads;
+            if (normalizing && settings.denormalize && !peaks.empty()) {
+                decompress_settings.denormalize_peaks = peaks;
+                decompress_settings.denormalize_mode = mode;
+            }
+
+            const Encoder encoder;
+            if (!encoder.decompress_volume(decompress_settings, input, output)) {
+                spdlog::error("Decompressing " + settings.input_path + " failed");
+                return finish(false);
+            }
+            Encoder::populate_Texture(tex_decoded, output);
+            result.seconds_decompress = seconds_since(t0);
+        }
+
+        // Error metrics against what was compressed: the source, or the normalized data if it stays normalized
+        Texture tex_error;
+        if (settings.error) {
+            t0 = Clock::now();
+            const bool normalized_reference = normalizing && !settings.denormalize;
+            const Texture& reference = (normalized_reference) ? tex_normalized : tex_source;
+
+            if (reference.data.empty()) {
+                spdlog::warn("No reference for error metrics of " + settings.input_path + ", normalized data is only kept with --copy-normalized");
+            }
+            else if (!settings.error_path.empty()) {
+                component_error(reference, tex_decoded, tex_error, &result.error, settings.encoder.threads);
+            }
+            else {
+                error_stats(reference, tex_decoded, result.error, settings.encoder.threads);
+            }
+            result.seconds_error = seconds_since(t0);
+        }
+
+        // Save
+        t0 = Clock::now();
+        bool saved = true;
+        if (!settings.output_path.empty() && !tex_encoded.data.empty()) {
+            saved &= save_texture(tex_encoded, settings.output_path);
+
+            if (!peaks.empty()) {
+                std::string peaks_path = std::filesystem::path(settings.output_path).replace_extension(".peaks").string();
+                saved &= file_save(peaks_path.c_str(), (char*)peaks.data(), peaks.size() * sizeof(float));
+            }
+        }
+
+        if (!settings.bricked_path.empty() && !bricked.data.empty()) {
+            TraceScope trace_bricked("save", bricked.data.size());
+            saved &= save_bricked(settings.bricked_path.c_str(), bricked);
+        }
+
+        if (!settings.decoded_path.empty() && !tex_decoded.data.empty()) {
+            saved &= save_texture(tex_decoded, settings.decoded_path);
+        }
+
+        if (!settings.error_path.empty() && !tex_error.data.empty()) {
+            saved &= save_texture(tex_error, settings.error_path);
+        }
+        result.seconds_save = seconds_since(t0);
+
+        if (!saved) {
+            spdlog::error("Saving the results of " + settings.input_path + " failed");
+        }
+
+        return finish(saved);
+    }
+
+    bool parse_pipeline_args(const std::vector<std::string>& args, PipelineSettings& settings) {
+        bool format_given = false;
+
+        for (uint64_t i = 0; i < args.size(); i++) {
+            const std::string& flag = args[i];
+
+            // Flags followed by a value
+            auto value = [&](std::string& out) {
+                if (i + 1 >= args.size()) {
+                    spdlog::error("Missing value of " + flag);
+                    return false;
+                }
+                out = args[++i];
+                return true;
+            };
+
+            std::string v;
+            try {
+                if (flag == "--input" || flag == "-i") {
+                    if (!value(settings.input_path)) return false;
+                }
+                else if (flag == "--output" || flag == "-o") {
+                    if (!value(settings.output_path)) return false;
+                }
+                else if (flag == "--bricked") {
+                    if (!value(settings.bricked_path)) return false;
+                }
+                else if (flag == "--brick-size") {
+                    if (!value(v)) return false;
+                    auto numbers = split_numbers(v);
+                    if (numbers.size() != 1 && numbers.size() != 3) {
+                        spdlog::error("Brick size takes one or three extents");
+                        return false;
+                    }
+                    for (int d = 0; d < 3; d++) {
+                        settings.brick_size[d] = (int)numbers[(numbers.size() == 1) ? 0 : d];
+                    }
+                }
+                else if (flag == "--datasets") {
+                    if (!value(v)) return false;
+                    settings.datasets = split_list(v);
+                }
+                else if (flag == "--offset" || flag == "--count" || flag == "--stride") {
+                    if (!value(v)) return false;
+                    auto numbers = split_numbers(v);
+                    uint64_t* target = (flag == "--offset") ? settings.region.offset : (flag == "--count") ? settings.region.count : settings.region.stride;
+                    for (uint64_t d = 0; d < std::min<uint64_t>(numbers.size(), 4); d++) {
+                        target[d] = numbers[d];
+                    }
+                }
+                else if (flag == "--half") {
+                    settings.half = true;
+                }
+                else if (flag == "--normalize") {
+                    if (!value(v)) return false;
+                    v = str_lowercase(v);
+                    if (v == "none")
+                        settings.normalize = PipelineNormalize::PIPELINE_NORMALIZE_NONE;
+                    else if (v == "slice")
+                        settings.normalize = PipelineNormalize::PIPELINE_NORMALIZE_SLICE;
+                    else if (v == "volume")
+                        settings.normalize = PipelineNormalize::PIPELINE_NORMALIZE_VOLUME;
+                    else {
+                        spdlog::error("Unknown normalization " + v);
+                        return false;
+                    }
+                }
+                else if (flag == "--copy-normalized") {
+                    settings.fused = false;
+                }
+                else if (flag == "--format") {
+                    if (!value(v)) return false;
+                    v = str_lowercase(v);
+                    if (v == "bc6s")
+                        settings.encoder.encoding = nvtt::Format_BC6S;
+                    else if (v == "bc6u")
+                        settings.encoder.encoding = nvtt::Format_BC6U;
+                    else {
+                        spdlog::error("Unknown format " + v);
+                        return false;
+                    }
+                    format_given = true;
+                }
+                else if (flag == "--quality") {
+                    if (!value(v)) return false;
+                    v = str_lowercase(v);
+                    if (v == "fastest")
+                        settings.encoder.quality = nvtt::Quality_Fastest;
+                    else if (v == "normal")
+                        settings.encoder.quality = nvtt::Quality_Normal;
+                    else if (v == "production")
+                        settings.encoder.quality = nvtt::Quality_Production;
+                    else if (v == "highest")
+                        settings.encoder.quality = nvtt::Quality_Highest;
+                    else {
+                        spdlog::error("Unknown quality " + v);
+                        return false;
+                    }
+                }
+                else if (flag == "--backend") {
+                    if (!value(v)) return false;
+                    v = str_lowercase(v);
+                    if (v == "nvtt")
+                        settings.encoder.backend = EncoderBackend::BACKEND_NVTT;
+                    else if (v == "native")
+                        settings.encoder.backend = EncoderBackend::BACKEND_NATIVE;
+                    else {
+                        spdlog::error("Unknown backend " + v);
+                        return false;
+                    }
+                }
+                else if (flag == "--threads") {
+                    if (!value(v)) return false;
+                    settings.encoder.threads = std::stoul(v);
+                }
+                else if (flag == "--decompress") {
+                    settings.decompress = true;
+                }
+                else if (flag == "--keep-normalized") {
+                    settings.denormalize = false;
+                }
+                else if (flag == "--decoded") {
+                    if (!value(settings.decoded_path)) return false;
+                }
+                else if (flag == "--error") {
+                    settings.error = true;
+                }
+                else if (flag == "--error-output") {
+                    if (!value(settings.error_path)) return false;
+                    settings.error = true;
+                }
+                else {
+                    spdlog::error("Unknown argument " + flag);
+                    return false;
+                }
+            }
+            catch (const std::exception&) {
+                spdlog::error("Invalid value " + v + " of " + flag);
+                return false;
+            }
+        }
+
+        // Normalized data is non-negative, the GUI uses the unsigned format for it as well
+        if (!format_given && settings.normalize != PipelineNormalize::PIPELINE_NORMALIZE_NONE) {
+            settings.encoder.encoding = nvtt::Format_BC6U;
+        }
+
+        return true;
+    }
+
+    std::vector<std::string> split_args(const std::string& line) {
+        std::vector<std::string> args;
+        std::string current;
+        bool quoted = false;
+        bool pending = false;
+
+        for (char c : line) {
+            if (c == '"') {
+                quoted = !quoted;
+                pending = true;
+            }
+            else if (!quoted && std::isspace((unsigned char)c)) {
+                if (pending) {
+                    args.push_back(current);
+                    current.clear();
+                    pending = false;
+                }
+            }
+            else {
+                current.push_back(c);
+                pending = true;
+            }
+        }
+
+        if (pending) {
+            args.push_back(current);
+        }
+
+        return args;
+    }
+
+    bool read_job_file(const char* path, std::vector<std::vector<std::string>>& jobs) {
+        std::ifstream file(path);
+        if (!file.is_open()) {
+            spdlog::error("Job file " + std::string(path) + " could not be opened");
+            return false;
+        }
+
+        std::string line;
+        while (std::getline(file, line)) {
+            auto first = line.find_first_not_of(" \t\r");
+            if (first == std::string::npos || line[first] == '#')
+                continue;
+
+            jobs.push_back(split_args(line));
+        }
+
+        return true;
+    }
+
+    const char* pipeline_usage() {
+        return
+            "  -i, --input <path>         .raw, .h5/.hdf5 or .ktx input, or a generated ABC flow as abc[:x0,y0,z0,t0,x1,y1,z1,t1]\n"
+            "  --datasets <a,b,c>         HDF5 component datasets, e.g. /u,/v,/w\n"
+            "  --offset <x,y,z,t>         HDF5 region offset\n"
+            "  --count <x,y,z,t>          HDF5 region extent after striding, 0 reads to the end\n"
+            "  --stride <x,y,z,t>         HDF5 region stride\n"
+            "  --half                     load and decode as 16 bit halves\n"
+            "  --normalize <mode>         none, slice or volume\n"
+            "  --copy-normalized          normalize into a copy instead of while compressing\n"
+            "  --format <format>          bc6s or bc6u (default bc6s, bc6u if normalized)\n"
+            "  --quality <quality>        fastest, normal, production or highest\n"
+            "  --backend <backend>        nvtt or native\n"
+            "  --threads <n>              worker threads, 0 uses all hardware threads\n"
+            "  -o, --output <path>        compressed output, .ktx or .raw\n"
+            "  --bricked <path>           also write the compressed data in the bricked layout\n"
+            "  --brick-size <n|x,y,z>     brick extents of --bricked, default 32\n"
+            "  --decompress               decode the compressed data\n"
+            "  --keep-normalized          do not denormalize decoded data\n"
+            "  --decoded <path>           decoded output, .ktx or .raw\n"
+            "  --error                    error metrics of the decoded data\n"
+            "  --error-output <path>      per texel component error, .raw\n";
+    }
+}
@@ -0,0 +1,324 @@
+#include <texpress/compression/streaming.hpp>
+#include <spdlog/spdlog.h>
+#include <texpress/compression/bc6h.hpp>
+#include <texpress/helpers/ktxhelper.hpp>
+#include <texpress/helpers/queuehelper.hpp>
+#include <texpress/io/file_io.hpp>
+#include <texpress/io/hdf_io.hpp>
+#include <texpress/io/ktx_index.hpp>
+#include <texpress/io/output_sink.hpp>
+#include <texpress/utility/stringtools.hpp>
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <memory>
+#include <thread>
+
+namespace texpress {
+    namespace {
+        // Consecutive (t, z) slices of a single time step.
+        struct Slab {
+            uint64_t t = 0;
+            uint64_t z = 0;
+            uint64_t slices = 0;
+            std::vector<uint8_t> data;
+        };
+
+        struct StreamSource {
+            glm::ivec4 dimensions = glm::ivec4(0);
+            uint8_t channels = 0;
+            uint64_t header_bytes = 0;      // Raw: leading dimension header
+        };
+
+        bool open_source(const StreamSettings& settings, StreamSource& source) {
+            if (settings.input_format == StreamFormat::STREAM_ABC) {
+                source.dimensions = abc_dimensions(settings.abc);
+                source.channels = 3;
+                if (!source.dimensions.x || !source.dimensions.y || !source.dimensions.z || !source.dimensions.w) {
+                    spdlog::error("ABC field has an empty extent");
+                    return false;
+                }
+                return true;
+            }
+
+            if (!std::filesystem::exists(settings.input_path)) {
+                spdlog::error("Input " + settings.input_path + " does not exist");
+                return false;
+            }
+
+            if (settings.input_format == StreamFormat::STREAM_RAW) {
+                auto path = std::filesystem::path(settings.input_path);
+                auto path_dims = path.replace_extension("").string() + "_dims" + std::filesystem::path(settings.input_path).extension().string();
+                bool seperate_dims = std::filesystem::exists(path_dims);
+
+                if (seperate_dims) {
+                    file_read(path_dims.c_str(), (char*)&source.dimensions.x, sizeof(source.dimensions));
+                }
+                else {
+                    file_read(settings.input_path.c_str(), (char*)&source.dimensions.x, sizeof(source.dimensions));
+                    source.header_bytes = sizeof(source.dimensions);
+                }
+
+                uint64_t elements = (uint64_t)source.dimensions.x * (uint64_t)source.dimensions.y * (uint64_t)source.dimensions.z * (uint64_t)source.dimensions.w;
+                if (!elements) {
+                    spdlog::error("Invalid dimensions in " + settings.input_path);
+                    return false;
+                }
+
+                source.channels = (file_size(settings.input_path.c_str()) - source.header_bytes) / (elements * sizeof(float));
+            }
+            else if (settings.input_format == StreamFormat::STREAM_HDF5) {
+                if (settings.datasets.empty()) {
+                    spdlog::error("No HDF5 datasets given");
+                    return false;
+                }
+
+                hdf5 file(settings.input_path.c_str());
+                auto dims = file.region_dimensions(settings.datasets[0].c_str(), settings.region);
+                if (dims.empty())
+                    return false;
+
+                for (int i = 0; i < source.dimensions.length(); i++) {
+                    source.dimensions[i] = (i < dims.size()) ? dims[i] : 1;
+                }
+                source.channels = settings.datasets.size();
+            }
+            else {
+                spdlog::error("Unsupported input format");
+                return false;
+            }
+
+            if (source.channels < 1 || source.channels > 4) {
+                spdlog::error("Unsupported number of channels {0}", source.channels);
+                return false;
+            }
+
+            return true;
+        }
+    }
+
+    bool stream_compress(const StreamSettings& settings, StreamStats* stats) {
+        auto t0 = std::chrono::high_resolution_clock::now();
+
+        StreamSource source;
+        if (!open_source(settings, source))
+            return false;
+
+        if (settings.output_format != StreamFormat::STREAM_RAW && settings.output_format != StreamFormat::STREAM_KTX) {
+            spdlog::error("Unsupported output format");
+            return false;
+        }
+
+        if (settings.encoder.encoding != nvtt::Format_BC6S && settings.encoder.encoding != nvtt::Format_BC6U) {
+            spdlog::error("Streaming supports BC6H only");
+            return false;
+        }
+
+        const glm::ivec4& dims = source.dimensions;
+        const uint64_t slab_slices = (settings.slab_slices) ? std::min<uint64_t>(settings.slab_slices, dims.z) : dims.z;
+        const uint64_t slices_total = (uint64_t)dims.z * (uint64_t)dims.w;
+        const uint64_t slice_bytes_in = (uint64_t)dims.x * (uint64_t)dims.y * source.channels * sizeof(float);
+        const uint64_t slice_bytes_out = bc6h_encoded_size(dims.x, dims.y);
+        const gl::GLenum gl_internal_enc = (settings.encoder.encoding == nvtt::Format_BC6S) ? gl::GLenum::GL_COMPRESSED_RGB_BPTC_SIGNED_FLOAT : gl::GLenum::GL_COMPRESSED_RGB_BPTC_UNSIGNED_FLOAT;
+
+        // KTX1 stores the size of the level in 32 bits, this limits a single time step and monolithic files to 4GB
+        const bool monolithic = settings.monolithic || dims.w == 1;
+        if (settings.output_format == StreamFormat::STREAM_KTX && slice_bytes_out * dims.z > UINT32_MAX) {
+            spdlog::error("KTX files are limited to 4GB, a single time step needs {0} bytes", slice_bytes_out * dims.z);
+            return false;
+        }
+        if (settings.output_format == StreamFormat::STREAM_KTX && monolithic && slice_bytes_out * slices_total > UINT32_MAX) {
+            spdlog::error("Monolithic KTX files are limited to 4GB, write one file per time step instead");
+            return false;
+        }
+
+        BoundedQueue<Slab> read_queue(settings.queue_size);
+        std::atomic<bool> failed = false;
+        StreamStats result;
+
+        auto cancel = [&]() {
+            failed = true;
+            read_queue.close();
+        };
+
+        // Reader: splits every time step into slabs of slab_slices, synthetic inputs are generated per slab
+        auto reader = [&]() {
+            std::unique_ptr<hdf5> file;
+            if (settings.input_format == StreamFormat::STREAM_HDF5) {
+                file = std::make_unique<hdf5>(settings.input_path.c_str());
+            }
+
+            for (uint64_t t = 0; t < (uint64_t)dims.w && !failed; t++) {
+                for (uint64_t z = 0; z < (uint64_t)dims.z && !failed; z += slab_slices) {
+                    Slab slab;
+                    slab.t = t;
+                    slab.z = z;
+                    slab.slices = std::min<uint64_t>(slab_slices, dims.z - z);
+                    slab.data.resize(slab.slices * slice_bytes_in);
+
+                    bool read = false;
+                    if (settings.input_format == StreamFormat::STREAM_ABC) {
+                        read = generate_abc_slices(settings.abc, t * dims.z + z, slab.slices, (float*)slab.data.data());
+                    }
+                    else if (file) {
+                        read = file->read_slab<float>(settings.datasets, settings.region, t, z, slab.slices, slab.data.data());
+                    }
+                    else {
+                        uint64_t offset = source.header_bytes + (t * dims.z + z) * slice_bytes_in;
+                        read = file_read(settings.input_path.c_str(), (char*)slab.data.data(), slab.data.size(), offset);
+                    }
+
+                    if (!read) {
+                        spdlog::error("Reading slab ({0}, {1}) failed", t, z);
+                        cancel();
+                        return;
+                    }
+
+                    result.bytes_read += slab.data.size();
+                    if (!read_queue.push(std::move(slab)))
+                        return;
+                }
+            }
+
+            read_queue.close();
+        };
+
+        // Compressor: encodes each slab with all threads requested in the encoder settings straight into its range of the
+        // output file, KTX files receive their header before the first slab
+        auto compressor = [&]() {
+            Encoder encoder;
+            EncoderSettings encoder_settings = settings.encoder;
+            encoder_settings.progress_ptr = nullptr;
+            // A failed reader also stops the slab being encoded
+            encoder_settings.cancel_ptr = &failed;
+
+            const std::string path_dims = std::filesystem::path(settings.output_path).replace_extension("").string() + "_dims.raw";
+            std::vector<std::string> paths_ktx;
+            std::string path = settings.output_path;
+            uint64_t header_bytes = 0;
+            uint64_t slices_written = 0;
+            int percentage = -1;
+
+            // Truncates the file and writes its header
+            auto create = [&](const std::vector<uint8_t>& header) {
+                FileSink sink;
+                return sink.open(path.c_str()) && (header.empty() || sink.write(0, header.data(), header.size()));
+            };
+
+            Slab slab;
+            // Slabs still queued after a failure are dropped
+            while (!failed && read_queue.pop(slab)) {
+                EncoderData input{};
+                input.gl_format = (uint32_t)gl_format(source.channels);
+                input.gl_internal = (uint32_t)gl_internal(source.channels, 32, true);
+                input.dim_x = dims.x;
+                input.dim_y = dims.y;
+                input.dim_z = slab.slices;
+                input.dim_t = 1;
+                input.channels = source.channels;
+                input.data_bytes = slab.data.size();
+                input.data_ptr = slab.data.data();
+
+                // First slice of the slab within its output file
+                uint64_t file_slice = slab.t * dims.z + slab.z;
+                bool first = (slab.t == 0 && slab.z == 0);
+
+                if (settings.output_format == StreamFormat::STREAM_KTX) {
+                    path = (monolithic) ? str_canonical(settings.output_path, -1, -1) : str_canonical(settings.output_path, -1, slab.t);
+                    file_slice = (monolithic) ? file_slice : slab.z;
+                    first = (monolithic) ? first : (slab.z == 0);
+
+                    if (first) {
+                        uint32_t depth = (monolithic) ? dims.z * dims.w : dims.z;
+                        auto header = ktx_header(dims, gl_internal_enc, depth, slice_bytes_out * depth);
+                        if (header.empty() || !create(header)) {
+                            cancel();
+                            return;
+                        }
+                        header_bytes = header.size();
+                        paths_ktx.push_back(path);
+                    }
+                }
+                else if (first) {
+                    // Raw output matches the save dialog, dimensions are stored in a sidecar
+                    if (!file_save(path_dims.c_str(), (char*)&dims.x, sizeof(dims))) {
+                        spdlog::error("Saving " + path_dims + " failed");
+                        cancel();
+                        return;
+                    }
+                    if (!create({})) {
+                        cancel();
+                        return;
+                    }
+                    header_bytes = 0;
+                }
+
+                const uint64_t offset = header_bytes + file_slice * slice_bytes_out;
+                const uint64_t bytes = Encoder::encoded_size(encoder_settings, input);
+                EncoderData output{};
+                bool encoded = false;
+
+                if (settings.mapped_output) {
+                    MappedSink sink;
+                    encoded = sink.open(path.c_str(), offset, bytes) && encoder.compress(encoder_settings, input, output, sink);
+                }
+                else {
+                    FileSink sink;
+                    encoded = sink.open(path.c_str(), offset, false, bytes) && encoder.compress(encoder_settings, input, output, sink);
+                }
+
+                if (!encoded) {
+                    if (failed)
+                        return;
+
+                    spdlog::error("Compressing slab ({0}, {1}) failed", slab.t, slab.z);
+                    cancel();
+                    return;
+                }
+
+                result.slabs++;
+                result.bytes_written += bytes;
+                slices_written += slab.slices;
+
+                int p = int((100 * slices_written) / slices_total);
+                if (p != percentage) {
+                    percentage = p;
+                    if (settings.progress_ptr) {
+                        *settings.progress_ptr = p;
+                    }
+                    else {
+                        printf("\r%d%%", p);
+                        fflush(stdout);
+                    }
+                }
+            }
+
+            // Slice offsets for random access, see KTXReader
+            KTXIndex index;
+            if (!failed && !paths_ktx.empty() && build_ktx_index(paths_ktx, index)) {
+                save_ktx_index(ktx_index_path(settings.output_path.c_str()).c_str(), index);
+            }
+        };
+
+        std::vector<std::thread> threads;
+        threads.push_back(std::thread(reader));
+        threads.push_back(std::thread(compressor));
+
+        for (auto& thread : threads) {
+            if (thread.joinable())
+                thread.join();
+        }
+
+        auto t1 = std::chrono::high_resolution_clock::now();
+        result.seconds = std::chrono::duration<double>(t1 - t0).count();
+        if (stats) {
+            *stats = result;
+        }
+
+        if (!failed) {
+            spdlog::info("Streamed {0} slabs, {1} bytes in, {2} bytes out, {3}s", result.slabs, result.bytes_read, result.bytes_written, result.seconds);
+        }
+
+        return !failed;
+    }
+}
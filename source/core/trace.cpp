@@ -0,0 +1,241 @@
+#include <texpress/defines.hpp>
+#include <texpress/core/trace.hpp>
+#include <texpress/core/wallclock.hpp>
+#include <spdlog/spdlog.h>
+#include <algorithm>
+#include <cstdio>
+#include <map>
+#include <memory>
+#include <mutex>
+
+namespace {
+    struct ThreadBuffer {
+        std::mutex mutex;                               // Only contended while the trace is collected
+        std::vector<texpress::TraceEvent> events;
+        uint32_t thread = 0;
+    };
+
+    // Buffers stay registered after their thread exits, worker threads live only as long as a single call
+    struct Registry {
+        std::mutex mutex;
+        std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+        uint32_t next_thread = 0;
+        uint64_t origin_ns = 0;                         // Start of the trace, exported timestamps are relative to it
+    };
+
+    Registry& registry() {
+        static Registry instance;
+        return instance;
+    }
+
+    ThreadBuffer& local_buffer() {
+        thread_local std::shared_ptr<ThreadBuffer> buffer;
+        if (!buffer) {
+            buffer = std::make_shared<ThreadBuffer>();
+
+            Registry& shared = registry();
+            std::lock_guard<std::mutex> lock(shared.mutex);
+            buffer->thread = shared.next_thread++;
+            shared.buffers.push_back(buffer);
+        }
+        return *buffer;
+    }
+
+    void record(const texpress::TraceEvent& event) {
+        ThreadBuffer& buffer = local_buffer();
+        std::lock_guard<std::mutex> lock(buffer.mutex);
+        buffer.events.push_back(event);
+        buffer.events.back().thread = buffer.thread;
+    }
+
+    // Names are code literals, but quotes and backslashes would still break the JSON
+    std::string escape(const char* name) {
+        std::string escaped;
+        for (const char* c = name; *c; c++) {
+            if (*c == '"' || *c == '\\')
+                escaped.push_back('\\');
+            escaped.push_back(*c);
+        }
+        return escaped;
+    }
+}
+
+namespace texpress {
+    void trace_enable(bool enable) {
+        if (enable) {
+            trace_clear();
+            registry().origin_ns = trace_now();
+        }
+        detail::trace_active = enable;
+    }
+
+    void trace_clear() {
+        Registry& shared = registry();
+        std::lock_guard<std::mutex> lock(shared.mutex);
+
+        for (auto& buffer : shared.buffers) {
+            std::lock_guard<std::mutex> lock_buffer(buffer->mutex);
+            buffer->events.clear();
+        }
+
+        // Buffers only referenced here belong to finished threads
+        shared.buffers.erase(std::remove_if(shared.buffers.begin(), shared.buffers.end(), [](const std::shared_ptr<ThreadBuffer>& buffer) {
+            return buffer.use_count() == 1;
+        }), shared.buffers.end());
+    }
+
+    uint64_t trace_now() {
+        static Wallclock clock;
+        // 0 marks an inactive TraceScope
+        return std::max<uint64_t>(clock.timeU64(WallclockType::WALLCLK_NS), 1);
+    }
+
+    void trace_record(const char* name, uint64_t begin_ns, uint64_t end_ns, uint64_t bytes) {
+        if (!trace_enabled())
+            return;
+
+        TraceEvent event;
+        event.name = name;
+        event.type = TraceEventType::TRACE_SCOPE;
+        event.begin_ns = begin_ns;
+        event.end_ns = std::max(begin_ns, end_ns);
+        event.bytes = bytes;
+        record(event);
+    }
+
+    void trace_counter(const char* name, double value) {
+        if (!trace_enabled())
+            return;
+
+        TraceEvent event;
+        event.name = name;
+        event.type = TraceEventType::TRACE_COUNTER;
+        event.begin_ns = trace_now();
+        event.end_ns = event.begin_ns;
+        event.value = value;
+        record(event);
+    }
+
+    std::vector<TraceEvent> trace_events() {
+        std::vector<TraceEvent> events;
+
+        {
+            Registry& shared = registry();
+            std::lock_guard<std::mutex> lock(shared.mutex);
+            for (auto& buffer : shared.buffers) {
+                std::lock_guard<std::mutex> lock_buffer(buffer->mutex);
+                events.insert(events.end(), buffer->events.begin(), buffer->events.end());
+            }
+        }
+
+        std::stable_sort(events.begin(), events.end(), [](const TraceEvent& a, const TraceEvent& b) {
+            return a.begin_ns < b.begin_ns;
+        });
+        return events;
+    }
+
+    std::vector<TraceStage> trace_summary() {
+        const std::vector<TraceEvent> events = trace_events();
+
+        // Events are sorted by begin, so the busy time of a stage is the union of its spans in a single pass
+        struct Accumulator {
+            TraceStage stage;
+            uint64_t first_ns = 0;
+            uint64_t span_begin_ns = 0;
+            uint64_t span_end_ns = 0;
+            uint64_t busy_ns = 0;
+        };
+        std::map<std::string, Accumulator> stages;
+
+        for (const auto& event : events) {
+            if (event.type != TraceEventType::TRACE_SCOPE)
+                continue;
+
+            Accumulator& accumulator = stages[event.name];
+            if (!accumulator.stage.calls) {
+                accumulator.first_ns = event.begin_ns;
+                accumulator.span_begin_ns = event.begin_ns;
+                accumulator.span_end_ns = event.end_ns;
+            }
+            else if (event.begin_ns > accumulator.span_end_ns) {
+                accumulator.busy_ns += accumulator.span_end_ns - accumulator.span_begin_ns;
+                accumulator.span_begin_ns = event.begin_ns;
+                accumulator.span_end_ns = event.end_ns;
+            }
+            else {
+                accumulator.span_end_ns = std::max(accumulator.span_end_ns, event.end_ns);
+            }
+
+            accumulator.stage.calls++;
+            accumulator.stage.bytes += event.bytes;
+            accumulator.stage.seconds += (event.end_ns - event.begin_ns) * 1e-9;
+        }
+
+        // In order of first appearance, which follows the pipeline
+        std::vector<std::pair<uint64_t, TraceStage>> ordered;
+        for (auto& [name, accumulator] : stages) {
+            TraceStage& stage = accumulator.stage;
+            stage.name = name;
+            stage.seconds_wall = (accumulator.busy_ns + accumulator.span_end_ns - accumulator.span_begin_ns) * 1e-9;
+            stage.mb_per_second = (stage.seconds_wall > 0.0) ? stage.bytes / 1e6 / stage.seconds_wall : 0.0;
+            ordered.emplace_back(accumulator.first_ns, stage);
+        }
+
+        std::stable_sort(ordered.begin(), ordered.end(), [](const auto& a, const auto& b) {
+            return a.first < b.first;
+        });
+
+        std::vector<TraceStage> summary;
+        for (auto& entry : ordered) {
+            summary.push_back(std::move(entry.second));
+        }
+        return summary;
+    }
+
+    std::string trace_summary_table(const std::vector<TraceStage>& stages) {
+        char line[256];
+        std::string table;
+
+        snprintf(line, sizeof(line), "%-32s %8s %12s %10s %10s %10s\n", "stage", "calls", "MB", "seconds", "wall s", "MB/s");
+        table += line;
+
+        for (const auto& stage : stages) {
+            snprintf(line, sizeof(line), "%-32s %8llu %12.2f %10.3f %10.3f %10.1f\n", stage.name.c_str(), (unsigned long long)stage.calls,
+                stage.bytes / 1e6, stage.seconds, stage.seconds_wall, stage.mb_per_second);
+            table += line;
+        }
+
+        return table;
+    }
+
+    bool save_trace(const char* path) {
+        FILE* file = fopen(path, "w");
+        if (!file) {
+            spdlog::error("Could not write trace " + std::string(path));
+            return false;
+        }
+
+        const std::vector<TraceEvent> events = trace_events();
+        const uint64_t origin_ns = registry().origin_ns;
+
+        fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+        for (uint64_t i = 0; i < events.size(); i++) {
+            const TraceEvent& event = events[i];
+            const double ts = (event.begin_ns > origin_ns) ? (event.begin_ns - origin_ns) / 1000.0 : 0.0;
+
+            if (event.type == TraceEventType::TRACE_COUNTER) {
+                fprintf(file, "{\"name\":\"%s\",\"ph\":\"C\",\"ts\":%.3f,\"pid\":1,\"tid\":%u,\"args\":{\"value\":%.17g}}",
+                    escape(event.name).c_str(), ts, event.thread, event.value);
+            }
+            else {
+                fprintf(file, "{\"name\":\"%s\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":%u,\"args\":{\"bytes\":%llu}}",
+                    escape(event.name).c_str(), ts, (event.end_ns - event.begin_ns) / 1000.0, event.thread, (unsigned long long)event.bytes);
+            }
+            fprintf(file, "%s\n", (i + 1 < events.size()) ? "," : "");
+        }
+        fprintf(file, "]}\n");
+
+        fclose(file);
+        return true;
+    }
+}
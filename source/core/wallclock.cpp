@@ -50,7 +50,7 @@ namespace texpress
 
         return 0;
     }
-#else TEXPRESS_GLFW_TIMER
+#else
     typedef std::chrono::high_resolution_clock Time;
     typedef std::chrono::seconds Sec;
     typedef std::chrono::milliseconds Ms;
@@ -64,17 +64,16 @@ namespace texpress
         switch (type)
         {
         case WallclockType::WALLCLK_S:
-            F64Dur t_s = t;
-            return t_s.count();
+            return t.count();
 
         case WallclockType::WALLCLK_MS:
-            F64Dur t_ms = std::chrono::duration_cast<Ms>(t);
-            return t_ms.count();
+            return t.count() * 1000.0;
 
         case WallclockType::WALLCLK_NS:
-            F64Dur t_ns = std::chrono::duration_cast<Ns>(t);
-            return t_ns.count();
+            return t.count() * 1000000000.0;
         }
+
+        return 0;
     }
 
     uint64_t Wallclock::timeU64(WallclockType type)
@@ -84,17 +83,16 @@ namespace texpress
         switch (type)
         {
         case WallclockType::WALLCLK_S:
-            auto t_s = std::chrono::duration_cast<Sec>(t);
-            return t_s.count();
+            return std::chrono::duration_cast<Sec>(t).count();
 
         case WallclockType::WALLCLK_MS:
-            auto t_ms = std::chrono::duration_cast<Ms>(t);
-            return t_ms.count();
+            return std::chrono::duration_cast<Ms>(t).count();
 
         case WallclockType::WALLCLK_NS:
-            auto t_ns = std::chrono::duration_cast<Ns>(t);
-            return t_ns.count();
+            return std::chrono::duration_cast<Ns>(t).count();
         }
+
+        return 0;
     }
 #endif
 }
@@ -0,0 +1,181 @@
+#include <texpress/graphics/preview_cache.hpp>
+#if !defined(TEXPRESS_HEADLESS)
+#include <globjects/Texture.h>
+#endif
+
+namespace texpress {
+    PreviewSlice::PreviewSlice() = default;
+    PreviewSlice::~PreviewSlice() = default;
+    PreviewSlice::PreviewSlice(PreviewSlice&& temp) = default;
+    PreviewSlice& PreviewSlice::operator=(PreviewSlice&& temp) = default;
+
+    uint32_t PreviewSlice::id() const {
+#if !defined(TEXPRESS_HEADLESS)
+        return (texture) ? texture->id() : 0;
+#else
+        return 0;
+#endif
+    }
+
+    bool PreviewCache::Fingerprint::operator==(const Fingerprint& other) const {
+        return data == other.data && data_bytes == other.data_bytes && dimensions == other.dimensions
+            && channels == other.channels && gl_internal == other.gl_internal && gl_type == other.gl_type;
+    }
+
+    PreviewCache::PreviewCache(uint64_t budget_bytes, const ThumbnailSettings& thumbnail_settings)
+        : budget_bytes(budget_bytes)
+        , thumbnail_settings(thumbnail_settings)
+    {}
+
+    PreviewCache::~PreviewCache() = default;
+
+    const PreviewSlice* PreviewCache::get(const Texture* owner, const TextureView& view, uint64_t slice) {
+#if !defined(TEXPRESS_HEADLESS)
+        return fetch(owner, view, slice, 0);
+#else
+        return fetch(owner, view, slice, 1);
+#endif
+    }
+
+    const PreviewSlice* PreviewCache::thumbnail(const Texture* owner, const TextureView& view, uint64_t slice, uint32_t size) {
+        if (view.empty())
+            return nullptr;
+
+        ThumbnailPyramid& pyramid = track(owner, view);
+        return fetch(owner, view, slice, 1 + pyramid.level(size));
+    }
+
+    bool PreviewCache::build_thumbnails(const Texture* owner, const TextureView& view) {
+        if (view.empty())
+            return false;
+
+        return track(owner, view).build();
+    }
+
+    ThumbnailPyramid& PreviewCache::track(const Texture* owner, const TextureView& view) {
+        Fingerprint fingerprint;
+        fingerprint.data = view.data;
+        fingerprint.data_bytes = view.data_bytes;
+        fingerprint.dimensions = view.dimensions;
+        fingerprint.channels = view.channels;
+        fingerprint.gl_internal = view.gl_internal;
+        fingerprint.gl_type = view.gl_type;
+
+        // Reallocated, reloaded or converted data makes every slice of owner stale
+        auto known = fingerprints.find(owner);
+        if (known == fingerprints.end() || !(known->second == fingerprint)) {
+            invalidate(owner);
+            fingerprints[owner] = fingerprint;
+            pyramids[owner].reset(view, thumbnail_settings);
+        }
+
+        return pyramids[owner];
+    }
+
+    const PreviewSlice* PreviewCache::fetch(const Texture* owner, const TextureView& view, uint64_t slice, uint32_t level) {
+        if (view.empty() || slice >= view.slices())
+            return nullptr;
+
+        ThumbnailPyramid& pyramid = track(owner, view);
+
+        const Key key{ owner, slice, level };
+        auto cached = slices.find(key);
+        if (cached != slices.end()) {
+            lru.splice(lru.begin(), lru, cached->second);
+            count_hits++;
+            return &cached->second->second;
+        }
+
+        PreviewSlice preview;
+        if (!load(view, slice, level, pyramid, preview))
+            return nullptr;
+
+        count_uploads++;
+
+        // The new slice always stays, even if it exceeds the budget on its own
+        evict((budget_bytes > preview.bytes) ? budget_bytes - preview.bytes : 0);
+        bytes += preview.bytes;
+        lru.emplace_front(key, std::move(preview));
+        slices[key] = lru.begin();
+
+        return &lru.front().second;
+    }
+
+    void PreviewCache::invalidate(const Texture* owner) {
+        if (!owner) {
+            lru.clear();
+            slices.clear();
+            fingerprints.clear();
+            pyramids.clear();
+            bytes = 0;
+            return;
+        }
+
+        for (auto it = lru.begin(); it != lru.end();) {
+            if (it->first.owner == owner) {
+                bytes -= it->second.bytes;
+                slices.erase(it->first);
+                it = lru.erase(it);
+            }
+            else {
+                ++it;
+            }
+        }
+
+        fingerprints.erase(owner);
+        pyramids.erase(owner);
+    }
+
+    void PreviewCache::set_budget(uint64_t budget_bytes) {
+        this->budget_bytes = budget_bytes;
+        evict(budget_bytes);
+    }
+
+    void PreviewCache::evict(uint64_t keep_bytes) {
+        while (!lru.empty() && bytes > keep_bytes) {
+            bytes -= lru.back().second.bytes;
+            slices.erase(lru.back().first);
+            lru.pop_back();
+        }
+    }
+
+    bool PreviewCache::load(const TextureView& view, uint64_t slice, uint32_t level, ThumbnailPyramid& pyramid, PreviewSlice& output) const {
+        const uint8_t* data = view.slice(slice);
+        uint64_t data_bytes = view.slice_bytes();
+        output.size = glm::ivec2(view.dimensions);
+
+        if (level) {
+            const ThumbnailLevel* thumbnail = pyramid.get(slice, level - 1);
+            if (!thumbnail)
+                return false;
+
+            data = thumbnail->rgba.data();
+            data_bytes = thumbnail->rgba.size();
+            output.size = thumbnail->size;
+        }
+
+        output.bytes = data_bytes;
+
+#if !defined(TEXPRESS_HEADLESS)
+        output.texture = globjects::Texture::createDefault();
+
+        if (level) {
+            output.texture->image2D(0, gl::GLenum::GL_RGBA8, output.size, 0, gl::GLenum::GL_RGBA, gl::GLenum::GL_UNSIGNED_BYTE, data);
+        }
+        else if (view.compressed()) {
+            output.texture->compressedImage2D(0, view.gl_internal, output.size, 0, (gl::GLsizei)data_bytes, data);
+        }
+        else {
+            output.texture->image2D(0, view.gl_internal, output.size, 0, view.gl_format, view.gl_type, data);
+        }
+#else
+        // No context to upload to, only thumbnails are kept
+        if (!level)
+            return false;
+
+        output.rgba.assign(data, data + data_bytes);
+#endif
+
+        return true;
+    }
+}
@@ -0,0 +1,312 @@
+#include <texpress/graphics/thumbnail_pyramid.hpp>
+#include <texpress/compression/bc6h.hpp>
+#include <texpress/helpers/threadhelper.hpp>
+#include <texpress/utility/half.hpp>
+#include <algorithm>
+#include <atomic>
+#include <cfloat>
+#include <cmath>
+#include <spdlog/spdlog.h>
+
+namespace {
+    // Sizes of all levels, largest first
+    std::vector<glm::ivec2> level_sizes(const glm::ivec4& dimensions, const texpress::ThumbnailSettings& settings) {
+        const int longest = std::max(dimensions.x, dimensions.y);
+        const float scale = std::min(1.0f, (float)std::max(settings.size, 1u) / (float)std::max(longest, 1));
+
+        std::vector<glm::ivec2> sizes;
+        glm::ivec2 size(std::max(1, (int)std::lround(dimensions.x * scale)), std::max(1, (int)std::lround(dimensions.y * scale)));
+        sizes.push_back(size);
+
+        while (std::max(size.x, size.y) / 2 >= (int)std::max(settings.min_size, 1u)) {
+            size = glm::ivec2(std::max(size.x / 2, 1), std::max(size.y / 2, 1));
+            sizes.push_back(size);
+        }
+
+        return sizes;
+    }
+
+    // Sums of the texels falling into each thumbnail texel
+    struct Accumulator {
+        glm::ivec2 size;
+        uint8_t channels;                       // Accumulated channels, 1 for magnitudes
+        bool magnitude;
+        std::vector<uint32_t> column;           // Thumbnail column of every source column
+        std::vector<float> sums;
+        std::vector<uint32_t> counts;
+
+        Accumulator(const glm::ivec2& size, uint32_t dim_x, uint8_t source_channels, bool magnitude)
+            : size(size)
+            , channels((magnitude) ? 1 : source_channels)
+            , magnitude(magnitude)
+            , column(dim_x)
+            , sums((uint64_t)size.x * (uint64_t)size.y * channels, 0.0f)
+            , counts((uint64_t)size.x * (uint64_t)size.y, 0)
+        {
+            for (uint32_t x = 0; x < dim_x; x++) {
+                column[x] = (uint32_t)((uint64_t)x * size.x / dim_x);
+            }
+        }
+
+        // Texels with NaN or inf are left out
+        void add(uint32_t row, uint32_t x, const float* texel, uint8_t source_channels) {
+            float value[4];
+            for (uint8_t c = 0; c < source_channels; c++) {
+                if (!std::isfinite(texel[c]))
+                    return;
+                value[c] = texel[c];
+            }
+
+            const uint64_t dest = (uint64_t)row * size.x + column[x];
+            if (magnitude) {
+                float length = 0.0f;
+                for (uint8_t c = 0; c < source_channels; c++) {
+                    length += value[c] * value[c];
+                }
+                sums[dest] += std::sqrt(length);
+            }
+            else {
+                for (uint8_t c = 0; c < channels; c++) {
+                    sums[dest * channels + c] += value[c];
+                }
+            }
+            counts[dest]++;
+        }
+    };
+
+    // Averages of level 0, mapped to 8 bit by the fixed range of settings or the range of each channel
+    void to_rgba(Accumulator& accumulator, const texpress::ThumbnailSettings& settings, texpress::ThumbnailLevel& level) {
+        const uint64_t texels = accumulator.counts.size();
+        const uint8_t channels = accumulator.channels;
+
+        float lo[4] = { FLT_MAX, FLT_MAX, FLT_MAX, FLT_MAX };
+        float hi[4] = { -FLT_MAX, -FLT_MAX, -FLT_MAX, -FLT_MAX };
+        for (uint64_t i = 0; i < texels; i++) {
+            if (!accumulator.counts[i])
+                continue;
+
+            for (uint8_t c = 0; c < channels; c++) {
+                float& mean = accumulator.sums[i * channels + c];
+                mean /= (float)accumulator.counts[i];
+                lo[c] = std::min(lo[c], mean);
+                hi[c] = std::max(hi[c], mean);
+            }
+        }
+
+        if (settings.range_max > settings.range_min) {
+            std::fill(lo, lo + 4, settings.range_min);
+            std::fill(hi, hi + 4, settings.range_max);
+        }
+
+        level.size = accumulator.size;
+        level.rgba.assign(texels * 4, 0);
+        for (uint64_t i = 0; i < texels; i++) {
+            uint8_t* dest = level.rgba.data() + i * 4;
+
+            // Missing channels stay black and opaque, magnitudes are gray
+            dest[3] = 255;
+            if (!accumulator.counts[i])
+                continue;
+
+            for (uint8_t c = 0; c < channels; c++) {
+                const float range = hi[c] - lo[c];
+                const float value = (range > 0.0f) ? (accumulator.sums[i * channels + c] - lo[c]) / range : 0.0f;
+                dest[c] = (uint8_t)std::lround(std::clamp(value, 0.0f, 1.0f) * 255.0f);
+            }
+
+            if (accumulator.magnitude) {
+                dest[1] = dest[0];
+                dest[2] = dest[0];
+            }
+        }
+    }
+
+    // 2x2 box filter, the last row or column of odd sizes is folded into the one before
+    void halve(const texpress::ThumbnailLevel& input, const glm::ivec2& size, texpress::ThumbnailLevel& output) {
+        output.size = size;
+        output.rgba.resize((uint64_t)size.x * (uint64_t)size.y * 4);
+
+        for (int y = 0; y < size.y; y++) {
+            const int y0 = std::min(y * 2, input.size.y - 1);
+            const int y1 = (y == size.y - 1) ? input.size.y - 1 : std::min(y * 2 + 1, input.size.y - 1);
+
+            for (int x = 0; x < size.x; x++) {
+                const int x0 = std::min(x * 2, input.size.x - 1);
+                const int x1 = (x == size.x - 1) ? input.size.x - 1 : std::min(x * 2 + 1, input.size.x - 1);
+
+                for (int c = 0; c < 4; c++) {
+                    uint32_t sum = 0;
+                    uint32_t count = 0;
+                    for (int sy = y0; sy <= y1; sy++) {
+                        for (int sx = x0; sx <= x1; sx++) {
+                            sum += input.rgba[((uint64_t)sy * input.size.x + sx) * 4 + c];
+                            count++;
+                        }
+                    }
+                    output.rgba[((uint64_t)y * size.x + x) * 4 + c] = (uint8_t)((sum + count / 2) / count);
+                }
+            }
+        }
+    }
+}
+
+namespace texpress {
+    bool build_thumbnail(const TextureView& view, uint64_t slice, const ThumbnailSettings& settings, std::vector<ThumbnailLevel>& levels) {
+        if (view.empty() || slice >= view.slices())
+            return false;
+
+        const uint32_t dim_x = view.dimensions.x;
+        const uint32_t dim_y = view.dimensions.y;
+        if (!dim_x || !dim_y)
+            return false;
+
+        const std::vector<glm::ivec2> sizes = level_sizes(view.dimensions, settings);
+        const bool magnitude = settings.mode == ThumbnailMode::THUMBNAIL_MAGNITUDE;
+        const uint8_t* data = view.slice(slice);
+
+        uint8_t channels = std::clamp<uint8_t>(view.channels, 1, 4);
+        if (view.compressed()) {
+            channels = 3;
+        }
+
+        Accumulator accumulator(sizes[0], dim_x, channels, magnitude);
+
+        if (view.compressed()) {
+            const bool is_signed = view.gl_internal == gl::GLenum::GL_COMPRESSED_RGB_BPTC_SIGNED_FLOAT;
+            if (!is_signed && view.gl_internal != gl::GLenum::GL_COMPRESSED_RGB_BPTC_UNSIGNED_FLOAT) {
+                spdlog::warn("Only BC6H compressed slices can be reduced to thumbnails");
+                return false;
+            }
+
+            const uint32_t blocks_x = (dim_x + 3) / 4;
+            const uint32_t blocks_y = (dim_y + 3) / 4;
+            uint16_t block_half[48];
+            float block[48];
+
+            for (uint32_t by = 0; by < blocks_y; by++) {
+                for (uint32_t bx = 0; bx < blocks_x; bx++) {
+                    bc6h_decode_block(data + ((uint64_t)by * blocks_x + bx) * BC6H_BLOCK_BYTES, is_signed, block_half);
+                    convert_to_float(block_half, block, 48);
+
+                    // Padding texels of edge blocks are not part of the slice
+                    for (uint32_t y = by * 4; y < std::min(by * 4 + 4, dim_y); y++) {
+                        const uint32_t row = (uint32_t)((uint64_t)y * sizes[0].y / dim_y);
+                        for (uint32_t x = bx * 4; x < std::min(bx * 4 + 4, dim_x); x++) {
+                            accumulator.add(row, x, block + ((y - by * 4) * 4 + (x - bx * 4)) * 3, 3);
+                        }
+                    }
+                }
+            }
+        }
+        else if (view.gl_type == gl::GLenum::GL_FLOAT || view.gl_type == gl::GLenum::GL_HALF_FLOAT) {
+            const bool half = view.gl_type == gl::GLenum::GL_HALF_FLOAT;
+            const uint64_t row_values = (uint64_t)dim_x * channels;
+            std::vector<float> converted((half) ? row_values : 0);
+
+            for (uint32_t y = 0; y < dim_y; y++) {
+                const float* values;
+                if (half) {
+                    convert_to_float((const uint16_t*)data + y * row_values, converted.data(), row_values);
+                    values = converted.data();
+                }
+                else {
+                    values = (const float*)data + y * row_values;
+                }
+
+                const uint32_t row = (uint32_t)((uint64_t)y * sizes[0].y / dim_y);
+                for (uint32_t x = 0; x < dim_x; x++) {
+                    accumulator.add(row, x, values + (uint64_t)x * channels, channels);
+                }
+            }
+        }
+        else {
+            spdlog::warn("Only float, half and BC6H slices can be reduced to thumbnails");
+            return false;
+        }
+
+        levels.resize(sizes.size());
+        to_rgba(accumulator, settings, levels[0]);
+        for (uint64_t i = 1; i < sizes.size(); i++) {
+            halve(levels[i - 1], sizes[i], levels[i]);
+        }
+
+        return true;
+    }
+
+    void ThumbnailPyramid::reset(const TextureView& view, const ThumbnailSettings& settings) {
+        clear();
+        source = view;
+        options = settings;
+        thumbnails.resize((view.empty()) ? 0 : view.slices());
+    }
+
+    void ThumbnailPyramid::clear() {
+        source = TextureView{};
+        thumbnails.clear();
+        thumbnails.shrink_to_fit();
+        bytes_total = 0;
+    }
+
+    bool ThumbnailPyramid::build() {
+        const uint64_t slices = thumbnails.size();
+        if (!slices)
+            return false;
+
+        std::atomic<uint64_t> next_slice = 0;
+        std::atomic<uint64_t> bytes_built = 0;
+        std::atomic<bool> failed = false;
+
+        // Every worker only writes the levels of the slices it took
+        run_workers(worker_count(options.threads, slices), [&](uint32_t) {
+            for (uint64_t slice = next_slice++; slice < slices && !failed; slice = next_slice++) {
+                if (!thumbnails[slice].empty())
+                    continue;
+
+                if (!build_thumbnail(source, slice, options, thumbnails[slice])) {
+                    failed = true;
+                    return;
+                }
+
+                uint64_t slice_bytes = 0;
+                for (const auto& level : thumbnails[slice]) {
+                    slice_bytes += level.rgba.size();
+                }
+                bytes_built += slice_bytes;
+            }
+        });
+
+        bytes_total += bytes_built;
+        return !failed;
+    }
+
+    const ThumbnailLevel* ThumbnailPyramid::get(uint64_t slice, uint32_t level) {
+        if (slice >= thumbnails.size())
+            return nullptr;
+
+        auto& thumbnail = thumbnails[slice];
+        if (thumbnail.empty()) {
+            if (!build_thumbnail(source, slice, options, thumbnail))
+                return nullptr;
+
+            for (const auto& built : thumbnail) {
+                bytes_total += built.rgba.size();
+            }
+        }
+
+        return &thumbnail[std::min<uint64_t>(level, thumbnail.size() - 1)];
+    }
+
+    uint32_t ThumbnailPyramid::level(uint32_t size) const {
+        const std::vector<glm::ivec2> sizes = level_sizes(source.dimensions, options);
+
+        uint32_t level = 0;
+        while (level + 1 < sizes.size() && (uint32_t)std::max(sizes[level + 1].x, sizes[level + 1].y) >= size) {
+            level++;
+        }
+        return level;
+    }
+
+    uint32_t ThumbnailPyramid::levels() const {
+        return (uint32_t)level_sizes(source.dimensions, options).size();
+    }
+}
@@ -1,7 +1,10 @@
 #pragma once
 #include <texpress/helpers/ktxhelper.hpp>
+#include <texpress/core/trace.hpp>
+#include <texpress/io/ktx_index.hpp>
 #include <texpress/utility/stringtools.hpp>
 #include <string>
+#include <cstring>
 #include <ktx.h>
 #include <fp16.h>
 
@@ -58,6 +61,7 @@ namespace texpress {
 
         // Each iteration produces a seperate file
         uint64_t iterations = (monolithic) ? 1 : range.w;
+        std::vector<std::string> filepaths;
 
         if (as_texture_array) {
             uint64_t slice_elements = size / (range.w * range.z * type_size);
@@ -75,6 +79,7 @@ namespace texpress {
 
                 std::string filepath = (monolithic) ? str_canonical(path, -1, -1) : str_canonical(path, -1, i);
                 ktxTexture_WriteToNamedFile(ktxTexture(texture), filepath.c_str());
+                filepaths.push_back(filepath);
             }
         }
         else {
@@ -89,6 +94,7 @@ namespace texpress {
 
                 std::string filepath = (monolithic) ? str_canonical(path, -1, -1) : str_canonical(path, -1, i);
                 ktxTexture_WriteToNamedFile(ktxTexture(texture), filepath.c_str());
+                filepaths.push_back(filepath);
             }
 
             texture->pData = nullptr;
@@ -96,6 +102,12 @@ namespace texpress {
 
         ktxTexture_Destroy(ktxTexture(texture));
 
+        // Slice offsets for random access without loading the files
+        KTXIndex index;
+        if (build_ktx_index(filepaths, index)) {
+            save_ktx_index(ktx_index_path(path).c_str(), index);
+        }
+
         return true;
     }
 
@@ -205,6 +217,52 @@ namespace texpress {
 
 
 
+    std::vector<uint8_t> ktx_header(const glm::ivec4& dimensions, gl::GLenum gl_internal_format, uint32_t depth, uint64_t image_bytes) {
+        static const uint8_t identifier[12] = { 0xAB, 0x4B, 0x54, 0x58, 0x20, 0x31, 0x31, 0xBB, 0x0D, 0x0A, 0x1A, 0x0A };
+        static const char key[] = "Dimensions";
+
+        // imageSize is a 32 bit field, larger levels cannot be described
+        if (image_bytes > UINT32_MAX)
+            return {};
+
+        // Key and value are padded to 4 bytes
+        uint32_t kv_bytes = sizeof(key) + sizeof(dimensions);
+        uint32_t kv_padded = (kv_bytes + 3) & ~3u;
+
+        uint32_t fields[13] = {
+            0x04030201,                                         // endianness
+            0,                                                  // glType, compressed
+            1,                                                  // glTypeSize
+            0,                                                  // glFormat, compressed
+            (uint32_t)gl_internal_format,
+            (uint32_t)gl::GLenum::GL_RGB,                       // glBaseInternalFormat
+            (uint32_t)std::max(dimensions.x, 1),
+            (uint32_t)std::max(dimensions.y, 1),
+            depth,
+            0,                                                  // numberOfArrayElements
+            1,                                                  // numberOfFaces
+            1,                                                  // numberOfMipmapLevels
+            (uint32_t)sizeof(uint32_t) + kv_padded              // bytesOfKeyValueData
+        };
+
+        std::vector<uint8_t> header(sizeof(identifier) + sizeof(fields) + sizeof(uint32_t) + kv_padded + sizeof(uint32_t), 0);
+        uint8_t* ptr = header.data();
+        std::memcpy(ptr, identifier, sizeof(identifier));
+        ptr += sizeof(identifier);
+        std::memcpy(ptr, fields, sizeof(fields));
+        ptr += sizeof(fields);
+        std::memcpy(ptr, &kv_bytes, sizeof(kv_bytes));
+        ptr += sizeof(kv_bytes);
+        std::memcpy(ptr, key, sizeof(key));
+        std::memcpy(ptr + sizeof(key), &dimensions, sizeof(dimensions));
+        ptr += kv_padded;
+
+        uint32_t image_size = (uint32_t)image_bytes;
+        std::memcpy(ptr, &image_size, sizeof(image_size));
+
+        return header;
+    }
+
     void load_ktx(const char* path, uint8_t* data_ptr, uint8_t& channels, glm::ivec4& dimensions, gl::GLenum& gl_internal, gl::GLenum& gl_format, gl::GLenum& gl_type) {
         ktxTexture* texture;
         KTX_error_code result;
@@ -305,6 +363,7 @@ namespace texpress {
     }
 
     bool save_ktx(const Texture& input, const char* path, bool as_texture_array, bool save_monolithic) {
+        TraceScope trace("save/ktx", input.bytes());
         return save_ktx(input.data.data(), path, input.dimensions, input.gl_internal, input.bytes(), as_texture_array, save_monolithic);
     }
 
@@ -313,7 +372,9 @@ namespace texpress {
     }
 
     void load_ktx(const char* path, Texture& tex) {
+        TraceScope trace("load/ktx");
         tex.data.resize(ktx_size(path));
+        trace.set_bytes(tex.bytes());
         load_ktx(path, tex.data.data(), tex.channels, tex.dimensions, tex.gl_internal, tex.gl_format, tex.gl_type);
     }
 }
\ No newline at end of file
@@ -1,5 +1,7 @@
 
 #include <texpress/io/file_io.hpp>
+#include <texpress/utility/half.hpp>
+#include <algorithm>
 #include <fstream>
 #include <spdlog/spdlog.h>
 
@@ -77,6 +79,33 @@ bool texpress::file_read(const char* path, char* buffer, uint64_t buffer_size, u
     return true;
 
 }
+bool texpress::file_read_half(const char* path, uint16_t* buffer, uint64_t count, uint64_t offset) {
+    std::ifstream file(path, std::ios::binary);
+
+    if (!file.is_open()) {
+        spdlog::warn("File " + std::string(path) + "could not be opened!");
+        return false;
+    }
+
+    file.seekg(offset, std::ios::beg);
+
+    // Floats read at once
+    std::vector<float> chunk(std::min<uint64_t>(count, 1 << 20));
+    for (uint64_t i = 0; i < count; i += chunk.size()) {
+        uint64_t n = std::min<uint64_t>(chunk.size(), count - i);
+        if (!file.read((char*)chunk.data(), n * sizeof(float))) {
+            spdlog::warn("Problem during fileread");
+            return false;
+        }
+
+        convert_to_half(chunk.data(), buffer + i, n);
+    }
+
+    file.close();
+
+    return true;
+}
+
 bool texpress::file_save(const char* path, char* buffer, uint64_t buffer_size, bool append, FileType type) {
     // Default: open file at the end of file
     std::ios::ios_base::openmode file_mode = std::ios::out;
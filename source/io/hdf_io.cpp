@@ -1,5 +1,7 @@
 #include <texpress/io/hdf_io.hpp>
 #include <spdlog/spdlog.h>
+#include <H5Dpublic.h>
+#include <H5Ppublic.h>
 
 namespace texpress
 {
@@ -124,11 +126,18 @@ namespace texpress
     }
 
     bool HDF5Tree::parse(std::string file_path) {
-        HighFive::File file(file_path, HighFive::File::ReadOnly);
+        std::lock_guard<std::mutex> lock(hdf5::library_mutex);
+        try {
+            HighFive::File file(file_path, HighFive::File::ReadOnly);
 
-        root = new HDF5Node{ "", HighFive::ObjectType::Group, nullptr, {} };
+            root = new HDF5Node{ "", HighFive::ObjectType::Group, nullptr, {} };
 
-        return parse(file, "/");
+            return parse(file, "/");
+        }
+        catch (const HighFive::Exception& e) {
+            spdlog::error("Could not parse " + file_path + ": " + e.what());
+            return false;
+        }
     }
 
     void HDF5Tree::list_paths(HDF5Node* node, std::vector<std::string>& paths) {
@@ -175,17 +184,138 @@ namespace texpress
     }
 
 
-    hdf5::hdf5(const char* path, bool write) {
+    hdf5::hdf5(const char* path, bool write) :
+        file(nullptr),
+        filepath(path)
+    {
         unsigned int flags = HighFive::File::ReadOnly + write;
-        file = new HighFive::File(path, flags);
-        filepath = path;
+        std::lock_guard<std::mutex> lock(library_mutex);
+        try {
+            file = new HighFive::File(path, flags);
+        }
+        catch (const HighFive::Exception& e) {
+            spdlog::error("Could not open " + std::string(path) + ": " + e.what());
+        }
     }
 
     hdf5::~hdf5() {
+        std::lock_guard<std::mutex> lock(library_mutex);
         delete file;
     }
 
+    std::mutex hdf5::library_mutex;
+
+    bool hdf5::hyperslab(const std::vector<std::size_t>& dimensions, const HDF5Region& region, std::vector<std::size_t>& offsets, std::vector<std::size_t>& counts, std::vector<std::size_t>& strides) {
+        const int rank = dimensions.size();
+        offsets.assign(rank, 0);
+        counts.assign(dimensions.begin(), dimensions.end());
+        strides.assign(rank, 1);
+
+        const char* names = "xyzt";
+        int previous = rank;
+        for (int d = 0; d < 4; d++) {
+            int axis = (region.axes[d] >= 0) ? region.axes[d] : rank - 1 - d;
+
+            // Axes missing in the dataset have a single element
+            if (axis < 0 || axis >= rank) {
+                if (region.offset[d] != 0 || region.count[d] > 1) {
+                    spdlog::error("Axis {0} is not part of the dataset", names[d]);
+                    return false;
+                }
+                continue;
+            }
+
+            // Interleaved output keeps the HDF5 order, x has to vary fastest
+            if (axis >= previous) {
+                spdlog::error("Axis {0} has to be stored in a higher HDF5 dimension than the following axes", names[d]);
+                return false;
+            }
+            previous = axis;
+
+            uint64_t stride = std::max<uint64_t>(region.stride[d], 1);
+            if (region.offset[d] >= dimensions[axis]) {
+                spdlog::error("Offset {0} of axis {1} exceeds its extent {2}", region.offset[d], names[d], dimensions[axis]);
+                return false;
+            }
+
+            uint64_t available = (dimensions[axis] - region.offset[d] + stride - 1) / stride;
+            if (region.count[d] > available) {
+                spdlog::error("Axis {0} has only {1} elements from offset {2} with stride {3}", names[d], available, region.offset[d], stride);
+                return false;
+            }
+
+            offsets[axis] = region.offset[d];
+            counts[axis] = (region.count[d]) ? region.count[d] : available;
+            strides[axis] = stride;
+        }
+
+        return true;
+    }
+
+    std::vector<std::size_t> hdf5::shape(const char* ds) {
+        if (!file)
+            return {};
+
+        std::lock_guard<std::mutex> lock(library_mutex);
+        try {
+            return file->getDataSet(ds).getDimensions();
+        }
+        catch (const HighFive::Exception& e) {
+            spdlog::error("Dataset " + std::string(ds) + " of " + std::string(filepath) + " could not be opened: " + e.what());
+            return {};
+        }
+    }
+
+    std::vector<uint64_t> hdf5::region_dimensions(const char* ds, const HDF5Region& region) {
+        std::vector<std::size_t> dimensions = shape(ds);
+        if (dimensions.empty())
+            return {};
+
+        std::vector<std::size_t> offsets, counts, strides;
+        if (!hyperslab(dimensions, region, offsets, counts, strides))
+            return {};
+
+        std::vector<uint64_t> extent(4, 1);
+        for (int d = 0; d < 4; d++) {
+            int axis = (region.axes[d] >= 0) ? region.axes[d] : (int)dimensions.size() - 1 - d;
+            if (axis >= 0 && axis < dimensions.size())
+                extent[d] = counts[axis];
+        }
+
+        return extent;
+    }
+
+    uint64_t hdf5::block_rows(const std::string& ds, uint64_t split, uint64_t row_bytes, uint64_t stride) {
+        // About 8MB per component and block keeps a block of all components in L3 while interleaving
+        const uint64_t target_bytes = 8 * 1024 * 1024;
+
+        uint64_t rows = std::max<uint64_t>(target_bytes / std::max<uint64_t>(row_bytes, 1), 1);
+
+        std::lock_guard<std::mutex> lock(library_mutex);
+        try {
+            HighFive::DataSet dataset = file->getDataSet(ds);
+            hid_t plist = H5Dget_create_plist(dataset.getId());
+            if (plist >= 0) {
+                if (H5Pget_layout(plist) == H5D_CHUNKED && stride == 1) {
+                    std::vector<hsize_t> chunk(dataset.getDimensions().size(), 1);
+                    H5Pget_chunk(plist, (int)chunk.size(), chunk.data());
+
+                    // Never split a chunk between two blocks, it would be decompressed twice
+                    uint64_t chunk_rows = (split < chunk.size()) ? std::max<uint64_t>(chunk[split], 1) : 1;
+                    rows = std::max<uint64_t>(rows / chunk_rows, 1) * chunk_rows;
+                }
+                H5Pclose(plist);
+            }
+        }
+        catch (const HighFive::Exception&) {
+            // Without the layout blocks are simply not aligned to chunks
+        }
+
+        return rows;
+    }
+
     bool hdf5::read(HighFive::DataSet dataset, uint64_t offset, uint64_t stride, uint8_t* data_ptr) {
+        std::lock_guard<std::mutex> lock(library_mutex);
         auto dimensions = dataset.getDimensions();
         uint64_t elements = (dataset.getElementCount() - offset) / stride;
 
@@ -200,7 +330,13 @@ namespace texpress
             i_elements.push_back((dimensions[j] - i_offsets[j]) / i_strides[j]);
         }
 
-        dataset.select(i_offsets, i_elements, i_strides).read<uint8_t>(data_ptr, dataset.getDataType());
+        try {
+            dataset.select(i_offsets, i_elements, i_strides).read<uint8_t>(data_ptr, dataset.getDataType());
+        }
+        catch (const HighFive::Exception& e) {
+            spdlog::error(std::string("Reading failed: ") + e.what());
+            return false;
+        }
 
         return true;
     }
@@ -212,8 +348,7 @@ namespace texpress
 
     std::vector<std::size_t> hdf5::get_grid(const char* ds, bool desc_order)
     {
-        HighFive::DataSet        dataset = file->getDataSet(ds);
-        std::vector<std::size_t> grid = dataset.getDimensions();
+        std::vector<std::size_t> grid = shape(ds);
         std::uint8_t             grid_dim = grid.size();
 
         std::size_t  grid_t = (grid_dim == 4) ? grid[grid_dim - 4] : 0;
@@ -250,8 +385,7 @@ namespace texpress
 
     std::vector<std::size_t> hdf5::get_grid_fixsize(const char* ds, bool desc_order, std::size_t fillvalue)
     {
-        HighFive::DataSet        dataset = file->getDataSet(ds);
-        std::vector<std::size_t> grid = dataset.getDimensions();
+        std::vector<std::size_t> grid = shape(ds);
         std::uint8_t             grid_dim = grid.size();
 
         std::size_t  grid_t = (grid_dim == 4) ? grid[grid_dim - 4] : 0;
@@ -293,8 +427,7 @@ namespace texpress
 
     std::size_t hdf5::get_grid_dim(const char* ds)
     {
-        HighFive::DataSet        dataset = file->getDataSet(ds);
-        std::vector<std::size_t> grid = dataset.getDimensions();
+        std::vector<std::size_t> grid = shape(ds);
 
         return grid.size();
     }
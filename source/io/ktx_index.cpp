@@ -0,0 +1,295 @@
+#include <texpress/io/ktx_index.hpp>
+#include <texpress/io/file_io.hpp>
+#include <texpress/compression/bc6h.hpp>
+#include <texpress/utility/stringtools.hpp>
+#include <spdlog/spdlog.h>
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+
+namespace texpress {
+    namespace {
+        const uint8_t KTX1_IDENTIFIER[12] = { 0xAB, 0x4B, 0x54, 0x58, 0x20, 0x31, 0x31, 0xBB, 0x0D, 0x0A, 0x1A, 0x0A };
+        const uint32_t INDEX_MAGIC = 0x49505854;    // "TXPI"
+        const uint32_t INDEX_VERSION = 1;
+
+        struct KTX1Header {
+            uint32_t endianness;
+            uint32_t gl_type;
+            uint32_t gl_type_size;
+            uint32_t gl_format;
+            uint32_t gl_internal_format;
+            uint32_t gl_base_internal_format;
+            uint32_t width;
+            uint32_t height;
+            uint32_t depth;
+            uint32_t array_elements;
+            uint32_t faces;
+            uint32_t mip_levels;
+            uint32_t kv_bytes;
+        };
+
+        struct KTX1File {
+            KTX1Header header;
+            glm::ivec4 dimensions = glm::ivec4(0);  // from the "Dimensions" key, 0 if missing
+            uint64_t data_offset = 0;               // first byte of the first image
+            uint64_t image_bytes = 0;
+        };
+
+        bool parse_ktx1(const std::string& path, KTX1File& file) {
+            uint8_t identifier[12];
+            if (!file_exists(path.c_str()) || !file_read(path.c_str(), (char*)identifier, sizeof(identifier))) {
+                spdlog::error("KTX file " + path + " could not be read");
+                return false;
+            }
+
+            if (std::memcmp(identifier, KTX1_IDENTIFIER, sizeof(identifier)) != 0) {
+                spdlog::error(path + " is not a KTX1 file");
+                return false;
+            }
+
+            file_read(path.c_str(), (char*)&file.header, sizeof(file.header), sizeof(identifier));
+            if (file.header.endianness != 0x04030201) {
+                spdlog::error(path + " has a foreign endianness");
+                return false;
+            }
+
+            if (file.header.mip_levels > 1 || file.header.faces > 1) {
+                spdlog::error(path + " has mipmaps or faces, which cannot be indexed");
+                return false;
+            }
+
+            // Key/value pairs: uint32 size, "key\0value", padded to 4 bytes
+            uint64_t kv_offset = sizeof(identifier) + sizeof(file.header);
+            std::vector<uint8_t> kv(file.header.kv_bytes);
+            file_read(path.c_str(), (char*)kv.data(), kv.size(), kv_offset);
+
+            for (uint64_t pos = 0; pos + sizeof(uint32_t) <= kv.size();) {
+                uint32_t pair_bytes;
+                std::memcpy(&pair_bytes, kv.data() + pos, sizeof(pair_bytes));
+                const char* key = (const char*)kv.data() + pos + sizeof(pair_bytes);
+
+                if (pair_bytes >= sizeof("Dimensions") + sizeof(file.dimensions) && std::strcmp(key, "Dimensions") == 0) {
+                    std::memcpy(&file.dimensions.x, key + sizeof("Dimensions"), sizeof(file.dimensions));
+                }
+
+                pos += sizeof(pair_bytes) + ((pair_bytes + 3) & ~3u);
+            }
+
+            uint32_t image_size = 0;
+            file_read(path.c_str(), (char*)&image_size, sizeof(image_size), kv_offset + file.header.kv_bytes);
+            file.data_offset = kv_offset + file.header.kv_bytes + sizeof(image_size);
+
+            // imageSize of non-cube arrays is the size of all layers
+            file.image_bytes = image_size;
+
+            return true;
+        }
+    }
+
+    std::string ktx_index_path(const char* path) {
+        return std::filesystem::path(str_canonical(path, -1, -1)).replace_extension("").string() + "_index.bin";
+    }
+
+    bool build_ktx_index(const std::vector<std::string>& paths, KTXIndex& index) {
+        index = KTXIndex{};
+
+        for (uint32_t f = 0; f < paths.size(); f++) {
+            KTX1File file;
+            if (!parse_ktx1(paths[f], file))
+                return false;
+
+            const uint64_t depth = std::max(file.header.depth, 1u) * std::max(file.header.array_elements, 1u);
+            const uint64_t slice_bytes = file.image_bytes / depth;
+
+            if (f == 0) {
+                index.gl_internal = gl::GLenum(file.header.gl_internal_format);
+                index.slice_bytes = slice_bytes;
+                index.dimensions = (file.dimensions.x) ? file.dimensions : glm::ivec4(file.header.width, std::max(file.header.height, 1u), depth, 1);
+            }
+            else if (slice_bytes != index.slice_bytes || gl::GLenum(file.header.gl_internal_format) != index.gl_internal) {
+                spdlog::error(paths[f] + " does not match the format of " + paths[0]);
+                return false;
+            }
+
+            index.files.push_back(std::filesystem::path(paths[f]).filename().string());
+            for (uint64_t s = 0; s < depth; s++) {
+                index.slice_files.push_back(f);
+                index.slice_offsets.push_back(file.data_offset + s * slice_bytes);
+            }
+        }
+
+        uint64_t expected = (uint64_t)std::max(index.dimensions.z, 1) * (uint64_t)std::max(index.dimensions.w, 1);
+        if (index.slices() != expected) {
+            spdlog::error("Files hold {0} slices, their dimensions describe {1}", index.slices(), expected);
+            return false;
+        }
+
+        return true;
+    }
+
+    bool save_ktx_index(const char* path, const KTXIndex& index) {
+        std::vector<uint8_t> buffer;
+        auto append = [&buffer](const void* ptr, uint64_t bytes) {
+            buffer.insert(buffer.end(), (const uint8_t*)ptr, (const uint8_t*)ptr + bytes);
+        };
+
+        uint32_t gl_internal = (uint32_t)index.gl_internal;
+        uint32_t files = index.files.size();
+        uint64_t slices = index.slices();
+
+        append(&INDEX_MAGIC, sizeof(INDEX_MAGIC));
+        append(&INDEX_VERSION, sizeof(INDEX_VERSION));
+        append(&index.dimensions.x, sizeof(index.dimensions));
+        append(&gl_internal, sizeof(gl_internal));
+        append(&index.slice_bytes, sizeof(index.slice_bytes));
+
+        append(&files, sizeof(files));
+        for (const auto& file : index.files) {
+            uint32_t length = file.size();
+            append(&length, sizeof(length));
+            append(file.data(), length);
+        }
+
+        append(&slices, sizeof(slices));
+        append(index.slice_files.data(), slices * sizeof(uint32_t));
+        append(index.slice_offsets.data(), slices * sizeof(uint64_t));
+
+        return file_save(path, (char*)buffer.data(), buffer.size());
+    }
+
+    bool load_ktx_index(const char* path, KTXIndex& index) {
+        uint64_t bytes = file_size(path);
+        std::vector<uint8_t> buffer(bytes);
+        if (!bytes || !file_read(path, (char*)buffer.data(), bytes))
+            return false;
+
+        uint64_t pos = 0;
+        auto take = [&](void* ptr, uint64_t size) {
+            if (pos + size > buffer.size())
+                return false;
+            std::memcpy(ptr, buffer.data() + pos, size);
+            pos += size;
+            return true;
+        };
+
+        uint32_t magic = 0, version = 0, gl_internal = 0, files = 0;
+        uint64_t slices = 0;
+        if (!take(&magic, sizeof(magic)) || !take(&version, sizeof(version)) || magic != INDEX_MAGIC || version != INDEX_VERSION) {
+            spdlog::error(std::string(path) + " is not a texpress KTX index");
+            return false;
+        }
+
+        index = KTXIndex{};
+        bool valid = take(&index.dimensions.x, sizeof(index.dimensions))
+            && take(&gl_internal, sizeof(gl_internal))
+            && take(&index.slice_bytes, sizeof(index.slice_bytes))
+            && take(&files, sizeof(files));
+
+        for (uint32_t f = 0; valid && f < files; f++) {
+            uint32_t length = 0;
+            valid = take(&length, sizeof(length)) && pos + length <= buffer.size();
+            if (valid) {
+                index.files.emplace_back((const char*)buffer.data() + pos, length);
+                pos += length;
+            }
+        }
+
+        valid = valid && take(&slices, sizeof(slices)) && pos + slices * (sizeof(uint32_t) + sizeof(uint64_t)) <= buffer.size();
+        if (valid) {
+            index.slice_files.resize(slices);
+            index.slice_offsets.resize(slices);
+            take(index.slice_files.data(), slices * sizeof(uint32_t));
+            take(index.slice_offsets.data(), slices * sizeof(uint64_t));
+        }
+
+        if (!valid) {
+            spdlog::error(std::string(path) + " is truncated");
+            return false;
+        }
+
+        index.gl_internal = gl::GLenum(gl_internal);
+        return true;
+    }
+
+    bool KTXReader::open(const char* path) {
+        std::string path_index = ktx_index_path(path);
+        directory = std::filesystem::path(path_index).parent_path().string();
+
+        if (file_exists(path_index.c_str()) && load_ktx_index(path_index.c_str(), idx))
+            return true;
+
+        // No sidecar: a single monolithic file or one file per time step
+        std::vector<std::string> paths{ str_canonical(path, -1, -1) };
+        if (!file_exists(paths[0].c_str())) {
+            paths.clear();
+            for (uint64_t t = 0; file_exists(str_canonical(path, -1, t).c_str()); t++) {
+                paths.push_back(str_canonical(path, -1, t));
+            }
+        }
+
+        if (paths.empty()) {
+            spdlog::error("No KTX files found for " + std::string(path));
+            return false;
+        }
+
+        return build_ktx_index(paths, idx);
+    }
+
+    bool KTXReader::read(uint64_t t, uint64_t z, uint64_t slices, uint8_t* data_ptr) const {
+        const uint64_t dim_z = std::max(idx.dimensions.z, 1);
+        const uint64_t first = t * dim_z + z;
+
+        if (z + slices > dim_z || first + slices > idx.slices()) {
+            spdlog::error("Slices [{0}, {1}) of time step {2} are out of range", z, z + slices, t);
+            return false;
+        }
+
+        // Consecutive slices of the same file are read at once
+        for (uint64_t s = first; s < first + slices;) {
+            uint64_t run = 1;
+            while (s + run < first + slices
+                && idx.slice_files[s + run] == idx.slice_files[s]
+                && idx.slice_offsets[s + run] == idx.slice_offsets[s] + run * idx.slice_bytes) {
+                run++;
+            }
+
+            std::string path = (std::filesystem::path(directory) / idx.files[idx.slice_files[s]]).string();
+            if (!file_read(path.c_str(), (char*)data_ptr + (s - first) * idx.slice_bytes, run * idx.slice_bytes, idx.slice_offsets[s]))
+                return false;
+
+            s += run;
+        }
+
+        return true;
+    }
+
+    bool KTXReader::decode(uint64_t t, uint64_t z, uint64_t slices, Texture& output, uint8_t channels, uint32_t threads) const {
+        const bool bc6h = idx.gl_internal == gl::GLenum::GL_COMPRESSED_RGB_BPTC_SIGNED_FLOAT || idx.gl_internal == gl::GLenum::GL_COMPRESSED_RGB_BPTC_UNSIGNED_FLOAT;
+
+        std::vector<uint8_t> blocks(slices * idx.slice_bytes);
+        if (!read(t, z, slices, blocks.data()))
+            return false;
+
+        output.dimensions = { idx.dimensions.x, idx.dimensions.y, slices, 1 };
+
+        if (!bc6h) {
+            // Stored uncompressed, nothing to decode
+            output.channels = gl_channels(idx.gl_internal);
+            output.gl_internal = idx.gl_internal;
+            output.gl_format = gl_format(output.channels);
+            output.gl_type = gl_type(idx.gl_internal);
+            output.data = std::move(blocks);
+            return true;
+        }
+
+        output.channels = std::clamp<uint8_t>(channels, 1, 4);
+        output.gl_internal = gl_internal(output.channels, 32, true);
+        output.gl_format = gl_format(output.channels);
+        output.gl_type = gl::GLenum::GL_FLOAT;
+        output.data.resize((uint64_t)idx.dimensions.x * (uint64_t)idx.dimensions.y * slices * output.channels * sizeof(float));
+
+        const bool is_signed = idx.gl_internal == gl::GLenum::GL_COMPRESSED_RGB_BPTC_SIGNED_FLOAT;
+        return bc6h_decode_volume(blocks.data(), idx.dimensions.x, idx.dimensions.y, slices, is_signed, output.channels, 32, output.data.data(), threads);
+    }
+}
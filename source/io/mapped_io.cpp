@@ -0,0 +1,149 @@
+#include <texpress/io/mapped_io.hpp>
+#include <texpress/io/file_io.hpp>
+#include <spdlog/spdlog.h>
+#include <filesystem>
+#include <cstring>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+texpress::MappedFile::~MappedFile() {
+    close();
+}
+
+bool texpress::MappedFile::open(const char* path) {
+    close();
+
+#if defined(_WIN32)
+    HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        spdlog::warn("File " + std::string(path) + " could not be opened!");
+        return false;
+    }
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size) || size.QuadPart == 0) {
+        spdlog::warn("File " + std::string(path) + " is empty!");
+        CloseHandle(file);
+        return false;
+    }
+
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!mapping) {
+        spdlog::error("File " + std::string(path) + " could not be mapped!");
+        CloseHandle(file);
+        return false;
+    }
+
+    void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (!view) {
+        spdlog::error("File " + std::string(path) + " could not be mapped!");
+        CloseHandle(mapping);
+        CloseHandle(file);
+        return false;
+    }
+
+    file_handle = file;
+    mapping_handle = mapping;
+    ptr = (const uint8_t*)view;
+    bytes = size.QuadPart;
+#else
+    int fd = ::open(path, O_RDONLY);
+    if (fd < 0) {
+        spdlog::warn("File " + std::string(path) + " could not be opened!");
+        return false;
+    }
+
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size == 0) {
+        spdlog::warn("File " + std::string(path) + " is empty!");
+        ::close(fd);
+        return false;
+    }
+
+    void* view = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (view == MAP_FAILED) {
+        spdlog::error("File " + std::string(path) + " could not be mapped!");
+        ::close(fd);
+        return false;
+    }
+
+    descriptor = fd;
+    ptr = (const uint8_t*)view;
+    bytes = info.st_size;
+#endif
+
+    return true;
+}
+
+void texpress::MappedFile::close() {
+    if (!ptr)
+        return;
+
+#if defined(_WIN32)
+    UnmapViewOfFile(ptr);
+    CloseHandle(mapping_handle);
+    CloseHandle(file_handle);
+    mapping_handle = nullptr;
+    file_handle = nullptr;
+#else
+    munmap((void*)ptr, bytes);
+    ::close(descriptor);
+    descriptor = -1;
+#endif
+
+    ptr = nullptr;
+    bytes = 0;
+}
+
+bool texpress::load_raw_mapped(const char* path, MappedFile& file, TextureView& view) {
+    auto path_dims = std::filesystem::path(path).replace_extension("").string() + "_dims" + std::filesystem::path(path).extension().string();
+    bool seperate_dims = std::filesystem::exists(path_dims);
+
+    if (!file.open(path))
+        return false;
+
+    glm::ivec4 dims = glm::ivec4(0);
+    uint64_t header_bytes = 0;
+
+    if (seperate_dims) {
+        file_read(path_dims.c_str(), (char*)&dims.x, sizeof(dims));
+    }
+    else if (file.size() >= sizeof(dims)) {
+        // Header is parsed in place, the texels start right after it
+        std::memcpy(&dims.x, file.data(), sizeof(dims));
+        header_bytes = sizeof(dims);
+    }
+
+    uint64_t elements = (uint64_t)dims.x * (uint64_t)dims.y * (uint64_t)dims.z * (uint64_t)dims.w;
+    if (dims.x <= 0 || dims.y <= 0 || dims.z <= 0 || dims.w <= 0 || !elements) {
+        spdlog::error("Invalid dimensions in " + std::string(path));
+        file.close();
+        return false;
+    }
+
+    uint64_t channels = (file.size() - header_bytes) / (elements * sizeof(float));
+    if (channels < 1 || channels > 4) {
+        spdlog::error("Unsupported number of channels {0}", channels);
+        file.close();
+        return false;
+    }
+
+    view.data = file.data() + header_bytes;
+    view.data_bytes = elements * channels * sizeof(float);
+    view.channels = channels;
+    view.dimensions = dims;
+    view.gl_type = gl::GLenum::GL_FLOAT;
+    view.gl_format = gl_format(channels);
+    view.gl_internal = gl_internal(channels, 32, true);
+
+    return true;
+}
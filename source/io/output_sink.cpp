@@ -0,0 +1,276 @@
+#include <texpress/io/output_sink.hpp>
+#include <spdlog/spdlog.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <string>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// MemorySink
+// ==========
+uint8_t* texpress::MemorySink::data(uint64_t offset, uint64_t bytes) {
+    if (!ptr || offset + bytes > capacity)
+        return nullptr;
+
+    return ptr + offset;
+}
+
+bool texpress::MemorySink::write(uint64_t offset, const void* data, uint64_t bytes) {
+    uint8_t* dest = this->data(offset, bytes);
+    if (!dest)
+        return false;
+
+    std::memcpy(dest, data, bytes);
+    return true;
+}
+
+// FileSink
+// ========
+texpress::FileSink::~FileSink() {
+    close();
+}
+
+bool texpress::FileSink::open(const char* path, uint64_t base_offset, bool truncate, uint64_t bytes) {
+    close();
+
+#if defined(_WIN32)
+    HANDLE file = CreateFileA(path, GENERIC_WRITE, FILE_SHARE_READ, nullptr, (truncate) ? CREATE_ALWAYS : OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        spdlog::error("File " + std::string(path) + " could not be opened for writing!");
+        return false;
+    }
+
+    file_handle = file;
+#else
+    int fd = ::open(path, O_WRONLY | O_CREAT | ((truncate) ? O_TRUNC : 0), 0644);
+    if (fd < 0) {
+        spdlog::error("File " + std::string(path) + " could not be opened for writing!");
+        return false;
+    }
+
+    descriptor = fd;
+#endif
+
+    origin = base_offset;
+    capacity = bytes;
+    return true;
+}
+
+void texpress::FileSink::close() {
+#if defined(_WIN32)
+    if (file_handle) {
+        CloseHandle(file_handle);
+        file_handle = nullptr;
+    }
+#else
+    if (descriptor >= 0) {
+        ::close(descriptor);
+        descriptor = -1;
+    }
+#endif
+
+    origin = 0;
+    capacity = 0;
+}
+
+bool texpress::FileSink::is_open() const {
+#if defined(_WIN32)
+    return file_handle != nullptr;
+#else
+    return descriptor >= 0;
+#endif
+}
+
+bool texpress::FileSink::write(uint64_t offset, const void* data, uint64_t bytes) {
+    if (!is_open() || offset + bytes > capacity)
+        return false;
+
+    const uint8_t* src = (const uint8_t*)data;
+    uint64_t position = origin + offset;
+
+    // Large writes and interrupted calls may return early
+    while (bytes) {
+#if defined(_WIN32)
+        DWORD chunk = (DWORD)std::min<uint64_t>(bytes, 1ull << 30);
+        DWORD written = 0;
+        OVERLAPPED overlapped{};
+        overlapped.Offset = (DWORD)(position & 0xFFFFFFFF);
+        overlapped.OffsetHigh = (DWORD)(position >> 32);
+        if (!WriteFile(file_handle, src, chunk, &written, &overlapped) || !written) {
+            spdlog::error("Writing {0} bytes at {1} failed", bytes, position);
+            return false;
+        }
+#else
+        ssize_t written = pwrite(descriptor, src, bytes, (off_t)position);
+        if (written <= 0) {
+            if (written < 0 && errno == EINTR)
+                continue;
+
+            spdlog::error("Writing {0} bytes at {1} failed", bytes, position);
+            return false;
+        }
+#endif
+        src += written;
+        position += written;
+        bytes -= written;
+    }
+
+    return true;
+}
+
+bool texpress::FileSink::flush() {
+    if (!is_open())
+        return false;
+
+#if defined(_WIN32)
+    return FlushFileBuffers(file_handle);
+#else
+    return fsync(descriptor) == 0;
+#endif
+}
+
+// MappedSink
+// ==========
+texpress::MappedSink::~MappedSink() {
+    close();
+}
+
+bool texpress::MappedSink::open(const char* path, uint64_t base, uint64_t bytes) {
+    close();
+
+    if (!bytes) {
+        spdlog::error("Cannot map an empty range of " + std::string(path));
+        return false;
+    }
+
+#if defined(_WIN32)
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    const uint64_t granularity = info.dwAllocationGranularity;
+#else
+    const uint64_t granularity = (uint64_t)sysconf(_SC_PAGESIZE);
+#endif
+
+    // Mappings start at a multiple of the allocation granularity
+    const uint64_t start = base - base % granularity;
+    const uint64_t end = base + bytes;
+
+#if defined(_WIN32)
+    HANDLE file = CreateFileA(path, GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, nullptr, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        spdlog::error("File " + std::string(path) + " could not be opened for writing!");
+        return false;
+    }
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size)) {
+        CloseHandle(file);
+        return false;
+    }
+
+    // The mapping grows the file to its maximum size
+    uint64_t file_bytes = std::max<uint64_t>(size.QuadPart, end);
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READWRITE, (DWORD)(file_bytes >> 32), (DWORD)(file_bytes & 0xFFFFFFFF), nullptr);
+    if (!mapping) {
+        spdlog::error("File " + std::string(path) + " could not be mapped!");
+        CloseHandle(file);
+        return false;
+    }
+
+    void* view = MapViewOfFile(mapping, FILE_MAP_WRITE, (DWORD)(start >> 32), (DWORD)(start & 0xFFFFFFFF), end - start);
+    if (!view) {
+        spdlog::error("File " + std::string(path) + " could not be mapped!");
+        CloseHandle(mapping);
+        CloseHandle(file);
+        return false;
+    }
+
+    file_handle = file;
+    mapping_handle = mapping;
+#else
+    int fd = ::open(path, O_RDWR | O_CREAT, 0644);
+    if (fd < 0) {
+        spdlog::error("File " + std::string(path) + " could not be opened for writing!");
+        return false;
+    }
+
+    struct stat info;
+    if (fstat(fd, &info) != 0 || ((uint64_t)info.st_size < end && ftruncate(fd, (off_t)end) != 0)) {
+        spdlog::error("File " + std::string(path) + " could not be resized!");
+        ::close(fd);
+        return false;
+    }
+
+    void* view = mmap(nullptr, end - start, PROT_READ | PROT_WRITE, MAP_SHARED, fd, (off_t)start);
+    if (view == MAP_FAILED) {
+        spdlog::error("File " + std::string(path) + " could not be mapped!");
+        ::close(fd);
+        return false;
+    }
+
+    descriptor = fd;
+#endif
+
+    ptr = (uint8_t*)view;
+    shift = base - start;
+    capacity = bytes;
+    return true;
+}
+
+void texpress::MappedSink::close() {
+    if (!ptr)
+        return;
+
+#if defined(_WIN32)
+    UnmapViewOfFile(ptr);
+    CloseHandle(mapping_handle);
+    CloseHandle(file_handle);
+    mapping_handle = nullptr;
+    file_handle = nullptr;
+#else
+    munmap(ptr, shift + capacity);
+    ::close(descriptor);
+    descriptor = -1;
+#endif
+
+    ptr = nullptr;
+    shift = 0;
+    capacity = 0;
+}
+
+uint8_t* texpress::MappedSink::data(uint64_t offset, uint64_t bytes) {
+    if (!ptr || offset + bytes > capacity)
+        return nullptr;
+
+    return ptr + shift + offset;
+}
+
+bool texpress::MappedSink::write(uint64_t offset, const void* data, uint64_t bytes) {
+    uint8_t* dest = this->data(offset, bytes);
+    if (!dest)
+        return false;
+
+    std::memcpy(dest, data, bytes);
+    return true;
+}
+
+bool texpress::MappedSink::flush() {
+    if (!ptr)
+        return false;
+
+#if defined(_WIN32)
+    return FlushViewOfFile(ptr, 0) && FlushFileBuffers(file_handle);
+#else
+    return msync(ptr, shift + capacity, MS_SYNC) == 0;
+#endif
+}
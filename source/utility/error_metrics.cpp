@@ -0,0 +1,301 @@
+#include <texpress/utility/error_metrics.hpp>
+#include <texpress/core/trace.hpp>
+#include <texpress/helpers/threadhelper.hpp>
+#include <texpress/utility/half.hpp>
+#include <spdlog/spdlog.h>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+namespace texpress {
+    namespace {
+        // Texels summed in float before being added to the double totals
+        constexpr uint64_t ERROR_BLOCK = 1024;
+
+        struct ErrorPartial {
+            double sum[4] = { 0.0, 0.0, 0.0, 0.0 };
+            double sum_sq[4] = { 0.0, 0.0, 0.0, 0.0 };
+            float max[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+            float min_ref[4] = { std::numeric_limits<float>::max(), std::numeric_limits<float>::max(), std::numeric_limits<float>::max(), std::numeric_limits<float>::max() };
+            float max_ref[4] = { std::numeric_limits<float>::lowest(), std::numeric_limits<float>::lowest(), std::numeric_limits<float>::lowest(), std::numeric_limits<float>::lowest() };
+            double distance_sum = 0.0;
+            double distance_sum_sq = 0.0;
+            float distance_max = 0.0f;
+        };
+
+        // Interleaved values of 16 (half) or 32 (float) bits
+        struct Field {
+            const void* data = nullptr;
+            int channels = 0;
+            uint8_t bits = 32;
+        };
+
+        // Float values of the texels [begin, end), halves are widened into block so no float copy of the whole field is needed
+        const float* block_values(const Field& field, uint64_t begin, uint64_t end, std::vector<float>& block) {
+            if (field.bits == 32)
+                return (const float*)field.data + begin * field.channels;
+
+            convert_to_float((const uint16_t*)field.data + begin * field.channels, block.data(), (end - begin) * field.channels);
+            return block.data();
+        }
+
+        // Channel counts are compile time constants, so the inner loops unroll and the block sums stay in registers
+        template <int CA>
+        void reduce_range(const Field& field_a, const Field& field_b, uint64_t begin, uint64_t end, ErrorPartial& partial, float* component_field, float* distance_field) {
+            const int cb = field_b.channels;
+            std::vector<float> block_a((field_a.bits == 16) ? ERROR_BLOCK * CA : 0);
+            std::vector<float> block_b((field_b.bits == 16) ? ERROR_BLOCK * cb : 0);
+
+            for (uint64_t block = begin; block < end; block += ERROR_BLOCK) {
+                const uint64_t block_end = std::min(block + ERROR_BLOCK, end);
+                const float* a_ptr = block_values(field_a, block, block_end, block_a);
+                const float* b_ptr = block_values(field_b, block, block_end, block_b);
+
+                float sum[CA] = {};
+                float sum_sq[CA] = {};
+                float max[CA] = {};
+                float min_ref[CA];
+                float max_ref[CA];
+                float distance_sum = 0.0f;
+                float distance_sum_sq = 0.0f;
+                float distance_max = 0.0f;
+
+                for (int c = 0; c < CA; c++) {
+                    min_ref[c] = partial.min_ref[c];
+                    max_ref[c] = partial.max_ref[c];
+                }
+
+                for (uint64_t i = block; i < block_end; i++) {
+                    const float* a = a_ptr + (i - block) * CA;
+                    const float* b = b_ptr + (i - block) * cb;
+                    float distance_sq = 0.0f;
+
+                    for (int c = 0; c < CA; c++) {
+                        float diff = a[c] - ((c < cb) ? b[c] : 0.0f);
+                        float abs_diff = std::fabs(diff);
+
+                        sum[c] += abs_diff;
+                        sum_sq[c] += diff * diff;
+                        max[c] = std::max(max[c], abs_diff);
+                        min_ref[c] = std::min(min_ref[c], a[c]);
+                        max_ref[c] = std::max(max_ref[c], a[c]);
+                        distance_sq += diff * diff;
+
+                        if (component_field)
+                            component_field[i * CA + c] = abs_diff;
+                    }
+
+                    float distance = std::sqrt(distance_sq);
+                    distance_sum += distance;
+                    distance_sum_sq += distance_sq;
+                    distance_max = std::max(distance_max, distance);
+
+                    if (distance_field)
+                        distance_field[i] = distance;
+                }
+
+                for (int c = 0; c < CA; c++) {
+                    partial.sum[c] += sum[c];
+                    partial.sum_sq[c] += sum_sq[c];
+                    partial.max[c] = std::max(partial.max[c], max[c]);
+                    partial.min_ref[c] = min_ref[c];
+                    partial.max_ref[c] = max_ref[c];
+                }
+                partial.distance_sum += distance_sum;
+                partial.distance_sum_sq += distance_sum_sq;
+                partial.distance_max = std::max(partial.distance_max, distance_max);
+            }
+        }
+
+        void reduce_range(const Field& field_a, const Field& field_b, uint64_t begin, uint64_t end, ErrorPartial& partial, float* component_field, float* distance_field) {
+            switch (field_a.channels) {
+            case 1:
+                reduce_range<1>(field_a, field_b, begin, end, partial, component_field, distance_field);
+                break;
+            case 2:
+                reduce_range<2>(field_a, field_b, begin, end, partial, component_field, distance_field);
+                break;
+            case 3:
+                reduce_range<3>(field_a, field_b, begin, end, partial, component_field, distance_field);
+                break;
+            case 4:
+                reduce_range<4>(field_a, field_b, begin, end, partial, component_field, distance_field);
+                break;
+            }
+        }
+
+        double psnr(double range, double mse) {
+            if (mse <= 0.0)
+                return std::numeric_limits<double>::infinity();
+
+            return 20.0 * std::log10(std::max(range, std::numeric_limits<double>::min())) - 10.0 * std::log10(mse);
+        }
+
+        bool comparable(const TextureView& reference, const TextureView& reconstruction) {
+            if (!float_bits(reference) || !float_bits(reconstruction)) {
+                spdlog::error("Error metrics require uncompressed half or float data");
+                return false;
+            }
+
+            if (reference.dimensions != reconstruction.dimensions) {
+                spdlog::error("Error metrics require textures of identical dimensions");
+                return false;
+            }
+
+            return true;
+        }
+
+        Field texture_field(const TextureView& tex) {
+            Field field;
+            field.data = tex.data;
+            field.channels = tex.channels;
+            field.bits = float_bits(tex);
+            return field;
+        }
+
+        uint64_t texel_count(const TextureView& tex) {
+            return tex.bytes() / (tex.channels * (float_bits(tex) / 8));
+        }
+
+        // Halves are widened per block inside the reduction, so half textures never need a float copy
+        bool compute_error(const Field& field_a, const Field& field_b, uint64_t texels, ErrorStats& stats, float* component_field, float* distance_field, uint32_t threads) {
+            const uint8_t channels_a = (uint8_t)field_a.channels;
+            const uint8_t channels_b = (uint8_t)field_b.channels;
+            if (!field_a.data || !field_b.data || channels_a < 1 || channels_a > 4 || channels_b < 1 || !texels) {
+                spdlog::error("Invalid input for error metrics");
+                return false;
+            }
+
+            TraceScope trace("error", texels * channels_a * sizeof(float));
+
+            // Ranges are multiples of a block, so every partial sum covers the same texels regardless of the thread count
+            const uint64_t blocks = (texels + ERROR_BLOCK - 1) / ERROR_BLOCK;
+            const uint32_t workers = worker_count(threads, blocks);
+            const uint64_t blocks_per_worker = (blocks + workers - 1) / workers;
+            std::vector<ErrorPartial> partials(workers);
+
+            run_workers(workers, [&](uint32_t w) {
+                uint64_t begin = std::min(w * blocks_per_worker * ERROR_BLOCK, texels);
+                uint64_t end = std::min((w + 1) * blocks_per_worker * ERROR_BLOCK, texels);
+                reduce_range(field_a, field_b, begin, end, partials[w], component_field, distance_field);
+            });
+
+            // Combine
+            ErrorPartial total;
+            for (const auto& partial : partials) {
+                for (int c = 0; c < 4; c++) {
+                    total.sum[c] += partial.sum[c];
+                    total.sum_sq[c] += partial.sum_sq[c];
+                    total.max[c] = std::max(total.max[c], partial.max[c]);
+                    total.min_ref[c] = std::min(total.min_ref[c], partial.min_ref[c]);
+                    total.max_ref[c] = std::max(total.max_ref[c], partial.max_ref[c]);
+                }
+                total.distance_sum += partial.distance_sum;
+                total.distance_sum_sq += partial.distance_sum_sq;
+                total.distance_max = std::max(total.distance_max, partial.distance_max);
+            }
+
+            stats = ErrorStats{};
+            stats.texels = texels;
+            stats.channels = channels_a;
+
+            double sum_sq = 0.0;
+            double peak = 0.0;
+            for (int c = 0; c < channels_a; c++) {
+                double mse = total.sum_sq[c] / texels;
+                stats.mean[c] = total.sum[c] / texels;
+                stats.rms[c] = std::sqrt(mse);
+                stats.max[c] = total.max[c];
+                stats.range[c] = (double)total.max_ref[c] - (double)total.min_ref[c];
+                stats.psnr[c] = psnr(stats.range[c], mse);
+
+                sum_sq += total.sum_sq[c];
+                peak = std::max(peak, stats.range[c]);
+            }
+
+            double mse_total = sum_sq / (texels * (uint64_t)channels_a);
+            stats.rms_total = std::sqrt(mse_total);
+            stats.psnr_total = psnr(peak, mse_total);
+            stats.distance_mean = total.distance_sum / texels;
+            stats.distance_rms = std::sqrt(total.distance_sum_sq / texels);
+            stats.distance_max = total.distance_max;
+
+            return true;
+        }
+    }
+
+    bool compute_error(const float* a_ptr, uint8_t channels_a, const float* b_ptr, uint8_t channels_b, uint64_t texels, ErrorStats& stats,
+        float* component_field, float* distance_field, uint32_t threads) {
+        Field field_a;
+        field_a.data = a_ptr;
+        field_a.channels = channels_a;
+
+        Field field_b;
+        field_b.data = b_ptr;
+        field_b.channels = channels_b;
+
+        return compute_error(field_a, field_b, texels, stats, component_field, distance_field, threads);
+    }
+
+    bool error_stats(const Texture& reference, const Texture& reconstruction, ErrorStats& stats, uint32_t threads) {
+        return error_stats(texture_view(reference), texture_view(reconstruction), stats, threads);
+    }
+
+    bool component_error(const Texture& reference, const Texture& reconstruction, Texture& error, ErrorStats* stats, uint32_t threads) {
+        return component_error(texture_view(reference), texture_view(reconstruction), error, stats, threads);
+    }
+
+    bool distance_error(const Texture& reference, const Texture& reconstruction, Texture& error, ErrorStats* stats, uint32_t threads) {
+        return distance_error(texture_view(reference), texture_view(reconstruction), error, stats, threads);
+    }
+
+    bool error_stats(const TextureView& reference, const TextureView& reconstruction, ErrorStats& stats, uint32_t threads) {
+        if (!comparable(reference, reconstruction))
+            return false;
+
+        return compute_error(texture_field(reference), texture_field(reconstruction), texel_count(reference), stats, nullptr, nullptr, threads);
+    }
+
+    bool component_error(const TextureView& reference, const TextureView& reconstruction, Texture& error, ErrorStats* stats, uint32_t threads) {
+        if (!comparable(reference, reconstruction))
+            return false;
+
+        error.data.clear();
+        error.dimensions = reference.dimensions;
+        error.channels = reference.channels;
+        error.gl_internal = gl_internal(error.channels, 32, true);
+        error.gl_format = gl_format(error.channels);
+        error.gl_type = gl::GLenum::GL_FLOAT;
+        error.data.resize(texel_count(reference) * error.channels * sizeof(float));
+
+        ErrorStats result;
+        bool success = compute_error(texture_field(reference), texture_field(reconstruction), texel_count(reference), result, (float*)error.data.data(), nullptr, threads);
+
+        if (stats)
+            *stats = result;
+
+        return success;
+    }
+
+    bool distance_error(const TextureView& reference, const TextureView& reconstruction, Texture& error, ErrorStats* stats, uint32_t threads) {
+        if (!comparable(reference, reconstruction))
+            return false;
+
+        error.data.clear();
+        error.dimensions = reference.dimensions;
+        error.channels = 1;
+        error.gl_internal = gl_internal(error.channels, 32, true);
+        error.gl_format = gl_format(error.channels);
+        error.gl_type = gl::GLenum::GL_FLOAT;
+        error.data.resize(texel_count(reference) * sizeof(float));
+
+        ErrorStats result;
+        bool success = compute_error(texture_field(reference), texture_field(reconstruction), texel_count(reference), result, nullptr, (float*)error.data.data(), threads);
+
+        if (stats)
+            *stats = result;
+
+        return success;
+    }
+}
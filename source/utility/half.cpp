@@ -0,0 +1,101 @@
+#include <texpress/defines.hpp>
+#include <texpress/utility/half.hpp>
+#include <texpress/helpers/threadhelper.hpp>
+#include <spdlog/spdlog.h>
+#include <fp16.h>
+#include <algorithm>
+#include <vector>
+
+#if defined(TEXPRESS_F16C)
+#include <immintrin.h>
+#endif
+
+namespace texpress {
+    namespace {
+        // Values converted per job
+        constexpr uint64_t CONVERT_CHUNK = 1 << 20;
+    }
+
+    void convert_to_half(const float* src, uint16_t* dest, uint64_t count) {
+        uint64_t i = 0;
+#if defined(TEXPRESS_F16C)
+        for (; i + 8 <= count; i += 8) {
+            _mm_storeu_si128((__m128i*)(dest + i), _mm256_cvtps_ph(_mm256_loadu_ps(src + i), _MM_FROUND_TO_NEAREST_INT));
+        }
+#endif
+        for (; i < count; i++) {
+            dest[i] = fp16_ieee_from_fp32_value(src[i]);
+        }
+    }
+
+    void convert_to_float(const uint16_t* src, float* dest, uint64_t count) {
+        uint64_t i = 0;
+#if defined(TEXPRESS_F16C)
+        for (; i + 8 <= count; i += 8) {
+            _mm256_storeu_ps(dest + i, _mm256_cvtph_ps(_mm_loadu_si128((const __m128i*)(src + i))));
+        }
+#endif
+        for (; i < count; i++) {
+            dest[i] = fp16_ieee_to_fp32_value(src[i]);
+        }
+    }
+
+    uint8_t float_bits(const Texture& texture) {
+        return float_bits(texture_view(texture));
+    }
+
+    uint8_t float_bits(const TextureView& view) {
+        uint64_t values = (uint64_t)std::max(view.dimensions.x, 1) * std::max(view.dimensions.y, 1) * std::max(view.dimensions.z, 1) * std::max(view.dimensions.w, 1) * view.channels;
+        if (view.compressed() || !values || view.empty())
+            return 0;
+
+        if (view.bytes() == values * sizeof(float))
+            return 32;
+
+        if (view.bytes() == values * sizeof(uint16_t))
+            return 16;
+
+        return 0;
+    }
+
+    bool convert_texture(const Texture& input, Texture& output, uint8_t bits, uint32_t threads) {
+        const uint8_t bits_in = float_bits(input);
+        if (!bits_in || (bits != 16 && bits != 32)) {
+            spdlog::error("Conversion requires uncompressed half or float data");
+            return false;
+        }
+
+        // Same representation, nothing to convert
+        if (bits_in == bits) {
+            if (&input != &output) {
+                output = input;
+            }
+            return true;
+        }
+
+        const uint64_t values = input.bytes() / (bits_in / 8);
+        std::vector<uint8_t> converted(values * (bits / 8));
+        const uint8_t* src = input.data.data();
+        uint8_t* dest = converted.data();
+
+        const uint64_t jobs = (values + CONVERT_CHUNK - 1) / CONVERT_CHUNK;
+        parallel_for(jobs, threads, [&](uint64_t job) {
+            uint64_t begin = job * CONVERT_CHUNK;
+            uint64_t count = std::min(CONVERT_CHUNK, values - begin);
+
+            if (bits == 16)
+                convert_to_half(reinterpret_cast<const float*>(src) + begin, reinterpret_cast<uint16_t*>(dest) + begin, count);
+            else
+                convert_to_float(reinterpret_cast<const uint16_t*>(src) + begin, reinterpret_cast<float*>(dest) + begin, count);
+        });
+
+        output.channels = input.channels;
+        output.dimensions = input.dimensions;
+        output.gl_format = input.gl_format;
+        output.gl_internal = gl_internal(input.channels, bits, true);
+        output.gl_type = (bits == 16) ? gl::GLenum::GL_HALF_FLOAT : gl::GLenum::GL_FLOAT;
+        output.data = std::move(converted);
+
+        return true;
+    }
+}
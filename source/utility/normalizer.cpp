@@ -0,0 +1,409 @@
+#include <texpress/defines.hpp>
+#include <texpress/utility/normalizer.hpp>
+#include <texpress/core/trace.hpp>
+#include <texpress/helpers/threadhelper.hpp>
+#include <texpress/utility/half.hpp>
+#include <spdlog/spdlog.h>
+#include <fp16.h>
+#include <algorithm>
+#include <limits>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define TEXPRESS_NORMALIZE_AVX2
+#endif
+
+namespace texpress {
+    namespace {
+        // 24 floats hold whole texels of 1 to 4 channels and whole AVX2 registers, so per lane parameters repeat every 24 values
+        constexpr uint64_t PATTERN = 24;
+        // Values per job, about 1.5MB of floats
+        constexpr uint64_t CHUNK = PATTERN * 16384;
+
+        struct Layout {
+            uint64_t slices = 0;
+            uint64_t slice_values = 0;
+            uint64_t chunks_per_slice = 0;
+
+            Layout(const glm::ivec4& dimensions, uint8_t channels) {
+                slices = (uint64_t)std::max(dimensions.z, 1) * (uint64_t)std::max(dimensions.w, 1);
+                slice_values = (uint64_t)std::max(dimensions.x, 1) * (uint64_t)std::max(dimensions.y, 1) * channels;
+                chunks_per_slice = (slice_values + CHUNK - 1) / CHUNK;
+            }
+
+            uint64_t jobs() const { return slices * chunks_per_slice; }
+        };
+
+        // Min/max of each lane of the pattern over values [0, count), the first value belongs to lane 0
+        void minmax_lanes(const float* data, uint64_t count, float* lane_min, float* lane_max) {
+            uint64_t i = 0;
+#if defined(TEXPRESS_NORMALIZE_AVX2)
+            __m256 vmin[3], vmax[3];
+            for (int v = 0; v < 3; v++) {
+                vmin[v] = _mm256_loadu_ps(lane_min + 8 * v);
+                vmax[v] = _mm256_loadu_ps(lane_max + 8 * v);
+            }
+
+            for (; i + PATTERN <= count; i += PATTERN) {
+                for (int v = 0; v < 3; v++) {
+                    __m256 x = _mm256_loadu_ps(data + i + 8 * v);
+                    vmin[v] = _mm256_min_ps(vmin[v], x);
+                    vmax[v] = _mm256_max_ps(vmax[v], x);
+                }
+            }
+
+            for (int v = 0; v < 3; v++) {
+                _mm256_storeu_ps(lane_min + 8 * v, vmin[v]);
+                _mm256_storeu_ps(lane_max + 8 * v, vmax[v]);
+            }
+#endif
+            for (; i < count; i++) {
+                uint64_t lane = i % PATTERN;
+                lane_min[lane] = std::min(lane_min[lane], data[i]);
+                lane_max[lane] = std::max(lane_max[lane], data[i]);
+            }
+        }
+
+        // output = data * scale + offset per lane, as float or half
+        void apply_lanes(const float* data, uint64_t count, const float* scale, const float* offset, uint8_t bits, uint8_t* output) {
+            uint64_t i = 0;
+            float* out_f = reinterpret_cast<float*>(output);
+            uint16_t* out_h = reinterpret_cast<uint16_t*>(output);
+#if defined(TEXPRESS_NORMALIZE_AVX2)
+            __m256 vscale[3], voffset[3];
+            for (int v = 0; v < 3; v++) {
+                vscale[v] = _mm256_loadu_ps(scale + 8 * v);
+                voffset[v] = _mm256_loadu_ps(offset + 8 * v);
+            }
+
+            for (; i + PATTERN <= count; i += PATTERN) {
+                for (int v = 0; v < 3; v++) {
+                    __m256 x = _mm256_add_ps(_mm256_mul_ps(_mm256_loadu_ps(data + i + 8 * v), vscale[v]), voffset[v]);
+                    if (bits == 32) {
+                        _mm256_storeu_ps(out_f + i + 8 * v, x);
+                    }
+                    else {
+#if defined(TEXPRESS_F16C)
+                        _mm_storeu_si128((__m128i*)(out_h + i + 8 * v), _mm256_cvtps_ph(x, _MM_FROUND_TO_NEAREST_INT));
+#else
+                        alignas(32) float tmp[8];
+                        _mm256_store_ps(tmp, x);
+                        for (int k = 0; k < 8; k++) {
+                            out_h[i + 8 * v + k] = fp16_ieee_from_fp32_value(tmp[k]);
+                        }
+#endif
+                    }
+                }
+            }
+#endif
+            for (; i < count; i++) {
+                uint64_t lane = i % PATTERN;
+                float x = data[i] * scale[lane] + offset[lane];
+                if (bits == 32) {
+                    out_f[i] = x;
+                }
+                else {
+                    out_h[i] = fp16_ieee_from_fp32_value(x);
+                }
+            }
+        }
+
+        // Same edge cases as normalize_val_per_component, expressed as value * scale + offset
+        void normalize_params(float min, float max, float& scale, float& offset) {
+            if (min != max) {
+                scale = 1.0f / (max - min);
+                offset = -min * scale;
+            }
+            else if (min == 0) {
+                scale = 1.0f;
+                offset = 0.0f;
+            }
+            else {
+                scale = 1.0f / max;
+                offset = 0.0f;
+            }
+        }
+
+        // Same edge cases as denormalize_per_component
+        void denormalize_params(float min, float max, float& scale, float& offset) {
+            if (min != max) {
+                scale = max - min;
+                offset = min;
+            }
+            else if (min == 0) {
+                scale = 1.0f;
+                offset = 0.0f;
+            }
+            else {
+                scale = max;
+                offset = 0.0f;
+            }
+        }
+
+        bool check_peaks(const glm::ivec4& dimensions, uint8_t channels, const std::vector<float>& peaks, NormalizeMode mode) {
+            if (channels < 1 || channels > 4) {
+                spdlog::error("Unsupported number of channels {0}", channels);
+                return false;
+            }
+
+            Layout layout(dimensions, channels);
+            uint64_t expected = (mode == NormalizeMode::NORMALIZE_SLICE) ? 2 * layout.slices * channels : 2 * (uint64_t)channels;
+            if (peaks.size() < expected) {
+                spdlog::error("Expected {0} peaks, got {1}", expected, peaks.size());
+                return false;
+            }
+
+            return true;
+        }
+
+        // Float input is used in place, half input is widened chunk by chunk into a scratch buffer of the calling thread
+        const float* load_values(const float* data, uint64_t count) {
+            return data;
+        }
+
+        const float* load_values(const uint16_t* data, uint64_t count) {
+            thread_local std::vector<float> scratch;
+            scratch.resize(std::max<uint64_t>(scratch.size(), count));
+            convert_to_float(data, scratch.data(), count);
+            return scratch.data();
+        }
+
+        // Applies per slice and component parameters computed by params(min, max, scale, offset) to every value
+        template <typename T, typename P>
+        void transform(const T* data_ptr, const glm::ivec4& dimensions, uint8_t channels, const std::vector<float>& peaks, NormalizeMode mode, uint8_t bits, uint8_t* output_ptr, uint32_t threads, const P& params) {
+            const Layout layout(dimensions, channels);
+            const uint64_t value_bytes = bits / 8;
+
+            // Lane parameters of each slice, computed once
+            const uint64_t param_sets = (mode == NormalizeMode::NORMALIZE_SLICE) ? layout.slices : 1;
+            std::vector<float> scales(param_sets * PATTERN);
+            std::vector<float> offsets(param_sets * PATTERN);
+            for (uint64_t s = 0; s < param_sets; s++) {
+                for (uint64_t lane = 0; lane < PATTERN; lane++) {
+                    uint64_t c = lane % channels;
+                    params(peaks[2 * (s * channels + c)], peaks[2 * (s * channels + c) + 1], scales[s * PATTERN + lane], offsets[s * PATTERN + lane]);
+                }
+            }
+
+            parallel_for(layout.jobs(), threads, [&](uint64_t job) {
+                uint64_t slice = job / layout.chunks_per_slice;
+                uint64_t begin = (job % layout.chunks_per_slice) * CHUNK;
+                uint64_t count = std::min(CHUNK, layout.slice_values - begin);
+                uint64_t value = slice * layout.slice_values + begin;
+                uint64_t set = (mode == NormalizeMode::NORMALIZE_SLICE) ? slice : 0;
+
+                apply_lanes(load_values(data_ptr + value, count), count, scales.data() + set * PATTERN, offsets.data() + set * PATTERN, bits, output_ptr + value * value_bytes);
+            });
+        }
+
+        template <typename T>
+        bool find_peaks(const T* data_ptr, const glm::ivec4& dimensions, uint8_t channels, std::vector<float>& peaks, uint32_t threads) {
+            if (!data_ptr || channels < 1 || channels > 4) {
+                spdlog::error("Invalid input for peak finding");
+                return false;
+            }
+
+            const Layout layout(dimensions, channels);
+            TraceScope trace("normalize/peaks", layout.slices * layout.slice_values * sizeof(T));
+
+            // Lane extrema of every job, reduced per slice afterwards
+            std::vector<float> job_min(layout.jobs() * PATTERN, std::numeric_limits<float>::infinity());
+            std::vector<float> job_max(layout.jobs() * PATTERN, -std::numeric_limits<float>::infinity());
+
+            parallel_for(layout.jobs(), threads, [&](uint64_t job) {
+                uint64_t slice = job / layout.chunks_per_slice;
+                uint64_t begin = (job % layout.chunks_per_slice) * CHUNK;
+                uint64_t count = std::min(CHUNK, layout.slice_values - begin);
+
+                minmax_lanes(load_values(data_ptr + slice * layout.slice_values + begin, count), count, job_min.data() + job * PATTERN, job_max.data() + job * PATTERN);
+            });
+
+            peaks.assign(2 * layout.slices * channels, 0.0f);
+            for (uint64_t s = 0; s < layout.slices; s++) {
+                for (uint64_t c = 0; c < channels; c++) {
+                    float min = std::numeric_limits<float>::infinity();
+                    float max = -std::numeric_limits<float>::infinity();
+
+                    for (uint64_t job = s * layout.chunks_per_slice; job < (s + 1) * layout.chunks_per_slice; job++) {
+                        for (uint64_t lane = c; lane < PATTERN; lane += channels) {
+                            min = std::min(min, job_min[job * PATTERN + lane]);
+                            max = std::max(max, job_max[job * PATTERN + lane]);
+                        }
+                    }
+
+                    peaks[2 * (s * channels + c)] = min;
+                    peaks[2 * (s * channels + c) + 1] = max;
+                }
+            }
+
+            return true;
+        }
+
+        template <typename T>
+        bool normalize_values(const T* data_ptr, const glm::ivec4& dimensions, uint8_t channels, const std::vector<float>& peaks, NormalizeMode mode, uint8_t bits, uint8_t* output_ptr, uint32_t threads) {
+            if (!data_ptr || !output_ptr || (bits != 16 && bits != 32) || !check_peaks(dimensions, channels, peaks, mode))
+                return false;
+
+            // Output narrower or wider than the input would overwrite unread values in place
+            if (bits != sizeof(T) * 8 && (const uint8_t*)data_ptr == output_ptr) {
+                spdlog::error("Normalizing to another precision cannot be done in place");
+                return false;
+            }
+
+            const Layout layout(dimensions, channels);
+            TraceScope trace("normalize", layout.slices * layout.slice_values * sizeof(T));
+            transform(data_ptr, dimensions, channels, peaks, mode, bits, output_ptr, threads, normalize_params);
+            return true;
+        }
+
+        // Single slice version of transform on the calling thread
+        template <typename T, typename P>
+        bool transform_slice(const T* data_ptr, uint64_t texels, uint8_t channels, const float* slice_peaks, uint8_t bits, uint8_t* output_ptr, const P& params) {
+            if (!data_ptr || !output_ptr || !slice_peaks || channels < 1 || channels > 4 || (bits != 16 && bits != 32))
+                return false;
+
+            float scale[PATTERN], offset[PATTERN];
+            for (uint64_t lane = 0; lane < PATTERN; lane++) {
+                uint64_t c = lane % channels;
+                params(slice_peaks[2 * c], slice_peaks[2 * c + 1], scale[lane], offset[lane]);
+            }
+
+            // Chunks are multiples of the pattern, so every chunk starts at lane 0
+            const uint64_t values = texels * channels;
+            for (uint64_t begin = 0; begin < values; begin += CHUNK) {
+                uint64_t count = std::min(CHUNK, values - begin);
+                apply_lanes(load_values(data_ptr + begin, count), count, scale, offset, bits, output_ptr + begin * (bits / 8));
+            }
+
+            return true;
+        }
+
+        template <typename T>
+        bool denormalize_values(const T* data_ptr, const glm::ivec4& dimensions, uint8_t channels, const std::vector<float>& peaks, NormalizeMode mode, T* output_ptr, uint32_t threads) {
+            if (!data_ptr || !output_ptr || !check_peaks(dimensions, channels, peaks, mode))
+                return false;
+
+            const Layout layout(dimensions, channels);
+            TraceScope trace("denormalize", layout.slices * layout.slice_values * sizeof(T));
+            transform(data_ptr, dimensions, channels, peaks, mode, sizeof(T) * 8, (uint8_t*)output_ptr, threads, denormalize_params);
+            return true;
+        }
+    }
+
+    bool find_peaks_parallel(const float* data_ptr, const glm::ivec4& dimensions, uint8_t channels, std::vector<float>& peaks, uint32_t threads) {
+        return find_peaks(data_ptr, dimensions, channels, peaks, threads);
+    }
+
+    bool find_peaks_parallel(const uint16_t* data_ptr, const glm::ivec4& dimensions, uint8_t channels, std::vector<float>& peaks, uint32_t threads) {
+        return find_peaks(data_ptr, dimensions, channels, peaks, threads);
+    }
+
+    std::vector<float> volume_peaks(const std::vector<float>& peaks, uint8_t channels) {
+        std::vector<float> volume(2 * (uint64_t)channels);
+        for (uint64_t c = 0; c < channels; c++) {
+            volume[2 * c] = std::numeric_limits<float>::infinity();
+            volume[2 * c + 1] = -std::numeric_limits<float>::infinity();
+        }
+
+        for (uint64_t i = 0; i + 1 < peaks.size(); i += 2) {
+            uint64_t c = (i / 2) % channels;
+            volume[2 * c] = std::min(volume[2 * c], peaks[i]);
+            volume[2 * c + 1] = std::max(volume[2 * c + 1], peaks[i + 1]);
+        }
+
+        return volume;
+    }
+
+    bool normalize(const float* data_ptr, const glm::ivec4& dimensions, uint8_t channels, const std::vector<float>& peaks, NormalizeMode mode, uint8_t bits, uint8_t* output_ptr, uint32_t threads) {
+        return normalize_values(data_ptr, dimensions, channels, peaks, mode, bits, output_ptr, threads);
+    }
+
+    bool normalize(const uint16_t* data_ptr, const glm::ivec4& dimensions, uint8_t channels, const std::vector<float>& peaks, NormalizeMode mode, uint8_t bits, uint8_t* output_ptr, uint32_t threads) {
+        return normalize_values(data_ptr, dimensions, channels, peaks, mode, bits, output_ptr, threads);
+    }
+
+    bool normalize_slice(const float* data_ptr, uint64_t texels, uint8_t channels, const float* slice_peaks, uint8_t bits, uint8_t* output_ptr) {
+        return transform_slice(data_ptr, texels, channels, slice_peaks, bits, output_ptr, normalize_params);
+    }
+
+    bool normalize_slice(const uint16_t* data_ptr, uint64_t texels, uint8_t channels, const float* slice_peaks, uint8_t bits, uint8_t* output_ptr) {
+        return transform_slice(data_ptr, texels, channels, slice_peaks, bits, output_ptr, normalize_params);
+    }
+
+    bool denormalize_slice(const float* data_ptr, uint64_t texels, uint8_t channels, const float* slice_peaks, float* output_ptr) {
+        return transform_slice(data_ptr, texels, channels, slice_peaks, 32, (uint8_t*)output_ptr, denormalize_params);
+    }
+
+    bool denormalize_slice(const uint16_t* data_ptr, uint64_t texels, uint8_t channels, const float* slice_peaks, uint16_t* output_ptr) {
+        return transform_slice(data_ptr, texels, channels, slice_peaks, 16, (uint8_t*)output_ptr, denormalize_params);
+    }
+
+    bool denormalize(const float* data_ptr, const glm::ivec4& dimensions, uint8_t channels, const std::vector<float>& peaks, NormalizeMode mode, float* output_ptr, uint32_t threads) {
+        return denormalize_values(data_ptr, dimensions, channels, peaks, mode, output_ptr, threads);
+    }
+
+    bool denormalize(const uint16_t* data_ptr, const glm::ivec4& dimensions, uint8_t channels, const std::vector<float>& peaks, NormalizeMode mode, uint16_t* output_ptr, uint32_t threads) {
+        return denormalize_values(data_ptr, dimensions, channels, peaks, mode, output_ptr, threads);
+    }
+
+    bool normalize(const Texture& input, Texture& output, std::vector<float>& peaks, NormalizeMode mode, uint8_t bits, uint32_t threads) {
+        return normalize(texture_view(input), output, peaks, mode, bits, threads);
+    }
+
+    bool normalize(const TextureView& input, Texture& output, std::vector<float>& peaks, NormalizeMode mode, uint8_t bits, uint32_t threads) {
+        const uint8_t bits_in = float_bits(input);
+        if (!bits_in) {
+            spdlog::error("Normalization requires uncompressed half or float data");
+            return false;
+        }
+
+        const bool half = (bits_in == 16);
+        const bool found = (half) ? find_peaks_parallel((const uint16_t*)input.data, input.dimensions, input.channels, peaks, threads)
+            : find_peaks_parallel((const float*)input.data, input.dimensions, input.channels, peaks, threads);
+        if (!found)
+            return false;
+
+        std::vector<float> volume;
+        if (mode == NormalizeMode::NORMALIZE_VOLUME) {
+            volume = volume_peaks(peaks, input.channels);
+        }
+        const std::vector<float>& used = (mode == NormalizeMode::NORMALIZE_VOLUME) ? volume : peaks;
+
+        output.channels = input.channels;
+        output.dimensions = input.dimensions;
+        output.gl_format = input.gl_format;
+        output.gl_internal = gl_internal(input.channels, bits, true);
+        output.gl_type = (bits == 16) ? gl::GLenum::GL_HALF_FLOAT : gl::GLenum::GL_FLOAT;
+        output.data.resize(input.bytes() / (bits_in / 8) * (bits / 8));
+
+        if (half)
+            return normalize((const uint16_t*)input.data, input.dimensions, input.channels, used, mode, bits, output.data.data(), threads);
+
+        return normalize((const float*)input.data, input.dimensions, input.channels, used, mode, bits, output.data.data(), threads);
+    }
+
+    bool denormalize(const Texture& input, Texture& output, const std::vector<float>& peaks, NormalizeMode mode, uint32_t threads) {
+        const uint8_t bits = float_bits(input);
+        if (!bits) {
+            spdlog::error("Denormalization requires uncompressed half or float data");
+            return false;
+        }
+
+        const std::vector<float> volume = (mode == NormalizeMode::NORMALIZE_VOLUME) ? volume_peaks(peaks, input.channels) : std::vector<float>();
+        const std::vector<float>& used = (mode == NormalizeMode::NORMALIZE_VOLUME) ? volume : peaks;
+
+        if (&input != &output) {
+            output.channels = input.channels;
+            output.dimensions = input.dimensions;
+            output.gl_format = input.gl_format;
+            output.gl_internal = input.gl_internal;
+            output.gl_type = input.gl_type;
+            output.data.resize(input.bytes());
+        }
+
+        if (bits == 16)
+            return denormalize((const uint16_t*)input.data.data(), input.dimensions, input.channels, used, mode, (uint16_t*)output.data.data(), threads);
+
+        return denormalize((const float*)input.data.data(), input.dimensions, input.channels, used, mode, (float*)output.data.data(), threads);
+    }
+}
@@ -0,0 +1,128 @@
+#include <texpress/utility/synthetic.hpp>
+#include <texpress/helpers/threadhelper.hpp>
+#include <spdlog/spdlog.h>
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+#include <vector>
+
+namespace {
+    // sin(s * p) and cos(s * p) of every grid position p along one axis
+    struct AxisTable {
+        std::vector<float> sin;
+        std::vector<float> cos;
+
+        AxisTable(int begin, int end, float scale) {
+            for (int p = begin; p < end; p++) {
+                sin.push_back(std::sin((float)p * scale));
+                cos.push_back(std::cos((float)p * scale));
+            }
+        }
+    };
+}
+
+namespace texpress {
+    glm::ivec4 abc_dimensions(const ABCSettings& settings) {
+        return glm::ivec4(std::max(settings.end.x - settings.begin.x, 0), std::max(settings.end.y - settings.begin.y, 0),
+            std::max(settings.end.z - settings.begin.z, 0), std::max(settings.end.w - settings.begin.w, 0));
+    }
+
+    bool generate_abc_slices(const ABCSettings& settings, uint64_t first_slice, uint64_t slices, float* output) {
+        const glm::ivec4 dims = abc_dimensions(settings);
+        if (!dims.x || !dims.y || !dims.z || !dims.w) {
+            spdlog::error("ABC field has an empty extent");
+            return false;
+        }
+
+        if (first_slice + slices > (uint64_t)dims.z * (uint64_t)dims.w) {
+            spdlog::error("ABC slices {0} to {1} are out of range", first_slice, first_slice + slices);
+            return false;
+        }
+
+        if (!output)
+            return false;
+
+        const AxisTable table_x(settings.begin.x, settings.end.x, settings.scale);
+        const AxisTable table_y(settings.begin.y, settings.end.y, settings.scale);
+        const AxisTable table_z(settings.begin.z, settings.end.z, settings.scale);
+
+        // b sin(s x) is the same in every row
+        std::vector<float> b_sin_x(dims.x);
+        for (int x = 0; x < dims.x; x++) {
+            b_sin_x[x] = settings.b * table_x.sin[x];
+        }
+
+        const uint64_t slice_values = (uint64_t)dims.x * (uint64_t)dims.y * 3;
+
+        parallel_for(slices, settings.threads, [&](uint64_t i) {
+            const uint64_t slice = first_slice + i;
+            const int z = (int)(slice % dims.z);
+            // Same operand types as the original generator: float time, double pi, so the field is bit-identical
+            const float time = (float)(settings.begin.w + (int)(slice / dims.z));
+            const float a_t = settings.a + settings.time_amplitude * time * std::sin(3.14159265359 * time * settings.time_frequency);
+
+            // Terms constant within the slice or the row
+            const float u_slice = a_t * table_z.sin[z];
+            const float v_slice = settings.c * table_z.cos[z];
+
+            float* dest = output + i * slice_values;
+            for (int y = 0; y < dims.y; y++) {
+                const float u_row = u_slice + settings.b * table_y.cos[y];
+                const float w_row = settings.c * table_y.sin[y];
+
+                for (int x = 0; x < dims.x; x++) {
+                    dest[0] = u_row;
+                    dest[1] = b_sin_x[x] + v_slice;
+                    dest[2] = w_row + a_t * table_x.cos[x];
+                    dest += 3;
+                }
+            }
+        });
+
+        return true;
+    }
+
+    bool generate_abc(const ABCSettings& settings, Texture& output) {
+        const glm::ivec4 dims = abc_dimensions(settings);
+        const uint64_t slices = (uint64_t)dims.z * (uint64_t)dims.w;
+
+        output.channels = 3;
+        output.dimensions = dims;
+        output.gl_internal = gl_internal(output.channels, 32, true);
+        output.gl_format = gl_format(output.channels);
+        output.gl_type = gl::GLenum::GL_FLOAT;
+        output.data.resize((uint64_t)dims.x * (uint64_t)dims.y * slices * output.channels * sizeof(float));
+
+        return generate_abc_slices(settings, 0, slices, (float*)output.data.data());
+    }
+
+    bool parse_abc(const std::string& spec, ABCSettings& settings) {
+        if (spec == "abc")
+            return true;
+
+        if (spec.rfind("abc:", 0) != 0)
+            return false;
+
+        std::vector<int> values;
+        std::stringstream stream(spec.substr(4));
+        std::string item;
+        try {
+            while (std::getline(stream, item, ',')) {
+                values.push_back(std::stoi(item));
+            }
+        }
+        catch (const std::exception&) {
+            spdlog::error("Invalid ABC extent " + spec);
+            return false;
+        }
+
+        if (values.size() != 8) {
+            spdlog::error("ABC extent needs x0,y0,z0,t0,x1,y1,z1,t1, got " + spec);
+            return false;
+        }
+
+        settings.begin = glm::ivec4(values[0], values[1], values[2], values[3]);
+        settings.end = glm::ivec4(values[4], values[5], values[6], values[7]);
+        return true;
+    }
+}
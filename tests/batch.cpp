@@ -0,0 +1,155 @@
+// Compresses several raw files concurrently and checks every output against compressing its input directly,
+// the pattern expansion, the memory estimate and the rejection of inputs that would write the same files.
+#include <texpress/compression/batch.hpp>
+#include <texpress/io/file_io.hpp>
+
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+    int failures = 0;
+
+    void check(bool condition, const char* what) {
+        if (!condition) {
+            std::printf("FAILED: %s\n", what);
+            failures++;
+        }
+    }
+
+    // Raw file with a leading dimension header
+    std::vector<float> write_raw(const std::string& path, const glm::ivec4& dimensions, uint32_t seed) {
+        std::mt19937 rng(seed);
+        std::uniform_real_distribution<float> value(-8.0f, 8.0f);
+        std::vector<float> texels((uint64_t)dimensions.x * dimensions.y * dimensions.z * dimensions.w * 3);
+        for (float& v : texels) {
+            v = value(rng);
+        }
+
+        std::vector<char> file(sizeof(dimensions) + texels.size() * sizeof(float));
+        std::memcpy(file.data(), &dimensions.x, sizeof(dimensions));
+        std::memcpy(file.data() + sizeof(dimensions), texels.data(), texels.size() * sizeof(float));
+        texpress::file_save(path.c_str(), file.data(), file.size());
+        return texels;
+    }
+
+    std::vector<uint8_t> compress_direct(texpress::EncoderSettings settings, const glm::ivec4& dimensions, std::vector<float>& texels) {
+        texpress::EncoderData input{};
+        input.gl_format = (uint32_t)texpress::gl_format(3);
+        input.gl_internal = (uint32_t)texpress::gl_internal(3, 32, true);
+        input.dim_x = dimensions.x;
+        input.dim_y = dimensions.y;
+        input.dim_z = dimensions.z;
+        input.dim_t = dimensions.w;
+        input.channels = 3;
+        input.data_bytes = texels.size() * sizeof(float);
+        input.data_ptr = (uint8_t*)texels.data();
+
+        int progress = 0;
+        settings.progress_ptr = &progress;
+        texpress::Encoder encoder;
+        std::vector<uint8_t> blocks(texpress::Encoder::encoded_size(settings, input));
+        texpress::MemorySink sink(blocks.data(), blocks.size());
+        texpress::EncoderData output{};
+        if (!encoder.compress(settings, input, output, sink))
+            blocks.clear();
+
+        return blocks;
+    }
+
+    std::vector<uint8_t> read_file(const std::string& path) {
+        std::vector<uint8_t> data(texpress::file_size(path.c_str()));
+        if (data.empty() || !texpress::file_read(path.c_str(), (char*)data.data(), data.size()))
+            data.clear();
+        return data;
+    }
+}
+
+int main() {
+    const std::string dir_in = "batch_test_input";
+    const std::string dir_out = "batch_test_output";
+    std::filesystem::remove_all(dir_in);
+    std::filesystem::remove_all(dir_out);
+    std::filesystem::create_directories(dir_in + "/other");
+
+    // Inputs of different sizes, so the scheduler reorders them
+    const glm::ivec4 dimensions[] = {
+        glm::ivec4(16, 8, 2, 1), glm::ivec4(40, 36, 6, 2), glm::ivec4(9, 13, 3, 1), glm::ivec4(24, 24, 4, 3), glm::ivec4(5, 4, 1, 1)
+    };
+    constexpr int FILES = sizeof(dimensions) / sizeof(dimensions[0]);
+    std::vector<std::vector<float>> texels;
+    for (int i = 0; i < FILES; i++) {
+        texels.push_back(write_raw(dir_in + "/step_" + std::to_string(i) + ".raw", dimensions[i], i));
+    }
+    write_raw(dir_in + "/other/step_0.raw", dimensions[0], 100);
+
+    // Patterns match file names only and are sorted, plain paths are passed through
+    const auto inputs = texpress::expand_inputs({ dir_in + "/step_?.raw" });
+    check(inputs.size() == FILES, "pattern expansion");
+    for (int i = 0; i < FILES && i < inputs.size(); i++) {
+        check(std::filesystem::path(inputs[i]).filename() == "step_" + std::to_string(i) + ".raw", "expanded inputs are sorted");
+    }
+    check(texpress::expand_inputs({ dir_in + "/*.h5" }).empty(), "pattern without matches");
+    check(texpress::expand_inputs({ "missing.raw" }).size() == 1, "plain path");
+
+    texpress::BatchSettings settings;
+    settings.inputs = { dir_in + "/step_*.raw" };
+    settings.output_dir = dir_out;
+    settings.output_extension = ".raw";
+    settings.pipeline.encoder.encoding = nvtt::Format_BC6S;
+    settings.pipeline.encoder.backend = texpress::EncoderBackend::BACKEND_NATIVE;
+    settings.jobs = 3;
+    int progress = 0;
+    settings.progress_ptr = &progress;
+
+    // Source and compressed data of a raw input
+    texpress::PipelineSettings largest = settings.pipeline;
+    largest.input_path = dir_in + "/step_1.raw";
+    const uint64_t texels_largest = 40 * 36 * 6 * 2;
+    check(texpress::estimate_memory(largest) == texels_largest + texels_largest * 3 * sizeof(float), "memory estimate");
+
+    // A budget that only fits the largest job alone, and one smaller than every job
+    for (uint64_t budget : { texpress::estimate_memory(largest), (uint64_t)1 }) {
+        settings.memory_budget = budget;
+        std::vector<texpress::BatchResult> results;
+        check(texpress::batch_compress(settings, results), "batch compress");
+        check(results.size() == FILES && progress == 100, "batch results");
+
+        for (int i = 0; i < FILES && i < results.size(); i++) {
+            const std::string output = dir_out + "/step_" + std::to_string(i) + ".raw";
+            const std::vector<uint8_t> expected = compress_direct(settings.pipeline.encoder, dimensions[i], texels[i]);
+            check(results[i].input == inputs[i] && results[i].stats.success, "job succeeded");
+            check(results[i].stats.bytes_compressed == expected.size(), "compressed size");
+            check(read_file(output) == expected, "output matches compressing the input directly");
+        }
+        std::filesystem::remove_all(dir_out);
+    }
+    settings.memory_budget = 0;
+
+    // Same stems would write the same outputs, nothing runs
+    {
+        texpress::BatchSettings duplicates = settings;
+        duplicates.inputs = { dir_in + "/step_0.raw", dir_in + "/other/step_0.raw" };
+        std::vector<texpress::BatchResult> results;
+        check(!texpress::batch_compress(duplicates, results), "duplicate stems are rejected");
+        check(!std::filesystem::exists(dir_out + "/step_0.raw"), "nothing is written for duplicate stems");
+    }
+
+    // A failing file fails the batch but not the other files
+    {
+        texpress::BatchSettings missing = settings;
+        missing.inputs = { dir_in + "/step_4.raw", dir_in + "/missing.raw" };
+        std::vector<texpress::BatchResult> results;
+        check(!texpress::batch_compress(missing, results), "missing input fails the batch");
+        check(results.size() == 2 && results[0].stats.success && !results[1].stats.success, "other files still succeed");
+    }
+
+    std::filesystem::remove_all(dir_in);
+    std::filesystem::remove_all(dir_out);
+
+    std::printf("%d batch checks failed\n", failures);
+    return (failures == 0) ? 0 : 1;
+}
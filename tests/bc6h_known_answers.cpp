@@ -0,0 +1,218 @@
+// Decodes fixed BC6H blocks of every mode, unsigned and signed, and compares them bit for bit with their expected half floats.
+// The expected texels follow the decoding rules of the D3D11 specification and were computed independently of this codec.
+#include <texpress/compression/bc6h.hpp>
+
+#include <cstdio>
+#include <iterator>
+
+namespace {
+    struct KnownAnswer {
+        const char* name;
+        bool is_signed;
+        uint8_t block[16];
+        uint16_t rgb[16 * 3];       // Interleaved RGB halves of the 16 texels
+    };
+
+    const KnownAnswer ANSWERS[] = {
+        { "mode 1 unsigned", false,
+          { 0x84, 0xDD, 0x57, 0x78, 0x6E, 0x49, 0x84, 0x2E, 0x5C, 0x87, 0x6F, 0xBA, 0x3C, 0xEE, 0x0E, 0x94 },
+          { 0x5B4D, 0x155A, 0x642C, 0x5BFD, 0x1575, 0x6403, 0x5B8C, 0x1564, 0x641D, 0x5C55, 0x1361, 0x64DD,
+            0x5BC5, 0x156D, 0x6410, 0x5C55, 0x1384, 0x64BA, 0x5C55, 0x1350, 0x64EE, 0x5C55, 0x13CC, 0x6472,
+            0x5C55, 0x1398, 0x64A6, 0x5C55, 0x1373, 0x64CB, 0x5C55, 0x1398, 0x64A6, 0x5C36, 0x157E, 0x63F6,
+            0x5C55, 0x13CC, 0x6472, 0x5AA3, 0x1540, 0x6453, 0x5BC5, 0x156D, 0x6410, 0x5B8C, 0x1564, 0x641D } },
+        { "mode 1 signed", true,
+          { 0x24, 0xA6, 0xC2, 0x4D, 0xC4, 0x6B, 0x40, 0x33, 0xA6, 0xFA, 0x25, 0xE3, 0x1E, 0x45, 0x38, 0xB9 },
+          { 0x49B7, 0x9DCE, 0xF2B6, 0x4971, 0x9DB4, 0xF282, 0x4852, 0x9D49, 0xF1AB, 0x49FD, 0x9DE9, 0xF2EB,
+            0x480D, 0x9D2F, 0xF177, 0x4852, 0x9D49, 0xF1AB, 0x492B, 0x9D9A, 0xF24E, 0x48DE, 0x9D7D, 0xF213,
+            0x4971, 0x9DB4, 0xF282, 0x48DE, 0x9D7D, 0xF213, 0x49FD, 0x9DE9, 0xF2EB, 0x4852, 0x9D49, 0xF1AB,
+            0x46E8, 0xA078, 0xF25E, 0x46E8, 0xA078, 0xF25E, 0x4753, 0x9FD9, 0xF07F, 0x46F9, 0xA05E, 0xF210 } },
+        { "mode 2 unsigned", false,
+          { 0xD5, 0x90, 0xFB, 0x68, 0xC1, 0xFA, 0xD8, 0xC1, 0x63, 0x0A, 0x74, 0xB7, 0x2B, 0x4E, 0x35, 0xC2 },
+          { 0x0991, 0x74B8, 0x3344, 0x1D8C, 0x7A8C, 0x35C4, 0x2657, 0x5FB1, 0x3B3A, 0x3302, 0x5FF7, 0x3701,
+            0x1702, 0x78A3, 0x34F2, 0x101B, 0x76A0, 0x3415, 0x3302, 0x5FF7, 0x3701, 0x73C4, 0x615C, 0x216C,
+            0x1D8C, 0x7A8C, 0x35C4, 0x13BD, 0x77AF, 0x348A, 0x5A6D, 0x60D0, 0x29DE, 0x3302, 0x5FF7, 0x3701,
+            0x0991, 0x74B8, 0x3344, 0x0CD6, 0x75AC, 0x33AD, 0x73C4, 0x615C, 0x216C, 0x4DC1, 0x608A, 0x2E17 } },
+        { "mode 2 signed", true,
+          { 0x45, 0x88, 0xE5, 0x43, 0x00, 0x84, 0x7E, 0x88, 0xD6, 0x3D, 0xC3, 0x3E, 0xA8, 0x95, 0xDA, 0xA2 },
+          { 0xF918, 0xE7A8, 0x40E8, 0xF918, 0x1BF4, 0x52D4, 0xF918, 0x3BF7, 0x5730, 0xF918, 0x7BFF, 0x5FE8,
+            0x5C84, 0x5BE9, 0x1360, 0xF918, 0xE7A8, 0x40E8, 0xF918, 0x3BF7, 0x5730, 0xF918, 0x5BFB, 0x5B8C,
+            0x60E0, 0x40AA, 0x1C18, 0xF918, 0xA7A0, 0x49A0, 0xF918, 0xA7A0, 0x49A0, 0xF918, 0x3BF7, 0x5730,
+            0x6E70, 0x941A, 0x3738, 0x6E70, 0x941A, 0x3738, 0xF918, 0xE7A8, 0x40E8, 0xF918, 0x3BF7, 0x5730 } },
+        { "mode 3 unsigned", false,
+          { 0x62, 0x59, 0x05, 0xD0, 0x56, 0xD7, 0x38, 0xBC, 0xE7, 0xAD, 0x90, 0x7F, 0x37, 0x0A, 0xAB, 0x5A },
+          { 0x6952, 0x00A2, 0x72D3, 0x6968, 0x00AF, 0x72C2, 0x6904, 0x010F, 0x7330, 0x6904, 0x010F, 0x7330,
+            0x6993, 0x00C9, 0x729F, 0x6904, 0x010F, 0x7330, 0x68F3, 0x00F5, 0x731D, 0x6888, 0x0055, 0x72A5,
+            0x69C1, 0x00E5, 0x727A, 0x6888, 0x0055, 0x72A5, 0x68F3, 0x00F5, 0x731D, 0x68AB, 0x0089, 0x72CC,
+            0x68E1, 0x00DA, 0x7309, 0x68AB, 0x0089, 0x72CC, 0x68BD, 0x00A3, 0x72E0, 0x689A, 0x006F, 0x72B9 } },
+        { "mode 3 signed", true,
+          { 0x02, 0x98, 0x76, 0x6A, 0xE2, 0x0D, 0xFF, 0x86, 0x36, 0x6C, 0x4E, 0xBA, 0x2A, 0x53, 0x9B, 0x9D },
+          { 0xE503, 0xDFC5, 0x2553, 0xE59F, 0xDF1F, 0x25C1, 0xE56A, 0xDEA2, 0x25F6, 0xE5AD, 0xDF3E, 0x25B3,
+            0xE503, 0xDFC5, 0x2553, 0xE528, 0xE00E, 0x2537, 0xE584, 0xDEDF, 0x25DC, 0xE577, 0xDEC0, 0x25E9,
+            0xE503, 0xDFC5, 0x2553, 0xE4F2, 0xDFA2, 0x2560, 0xE528, 0xE00E, 0x2537, 0xE5AD, 0xDF3E, 0x25B3,
+            0xE4E0, 0xDF7F, 0x256D, 0xE503, 0xDFC5, 0x2553, 0xE54B, 0xE054, 0x251D, 0xE517, 0xDFEB, 0x2545 } },
+        { "mode 4 unsigned", false,
+          { 0x66, 0x87, 0x97, 0xF6, 0x4A, 0x2E, 0xD7, 0x37, 0x7B, 0x4E, 0x3D, 0x4F, 0x64, 0x90, 0x38, 0x8B },
+          { 0x036C, 0x5032, 0x16F3, 0x036C, 0x5032, 0x16F3, 0x033D, 0x5003, 0x16ED, 0x036C, 0x5032, 0x16F3,
+            0x037B, 0x5041, 0x16F5, 0x035B, 0x5021, 0x16F1, 0x035B, 0x5021, 0x16F1, 0x0369, 0x4FFE, 0x16AC,
+            0x039A, 0x5060, 0x16FA, 0x0369, 0x4FFE, 0x16AC, 0x0369, 0x4FFE, 0x16AC, 0x035E, 0x50D2, 0x1748,
+            0x0369, 0x4FFE, 0x16AC, 0x0365, 0x5051, 0x16E9, 0x0369, 0x4FFE, 0x16AC, 0x0367, 0x5027, 0x16CA } },
+        { "mode 4 signed", true,
+          { 0x06, 0x43, 0x3D, 0xB4, 0xA5, 0x84, 0x8A, 0x54, 0x4B, 0x2B, 0xF4, 0x84, 0x18, 0xB6, 0x1D, 0x13 },
+          { 0xBB16, 0x0EA1, 0x5857, 0xBAAB, 0x0D61, 0x579C, 0xBB16, 0x0EA1, 0x5857, 0xBA87, 0x0D65, 0x57EF,
+            0xBADF, 0x0DFE, 0x57F8, 0xBB27, 0x0ED5, 0x5875, 0xBAF3, 0x0E38, 0x581A, 0xBA8C, 0x0D23, 0x57BB,
+            0xBAF3, 0x0E38, 0x581A, 0xBAF3, 0x0E38, 0x581A, 0xBAF3, 0x0E38, 0x581A, 0xBA6D, 0x0EF4, 0x592F,
+            0xBB27, 0x0ED5, 0x5875, 0xBAF3, 0x0E38, 0x581A, 0xBB04, 0x0E6C, 0x5838, 0xBA8C, 0x0D23, 0x57BB } },
+        { "mode 5 unsigned", false,
+          { 0x0A, 0x6A, 0x3A, 0xBB, 0x77, 0x5F, 0x3D, 0xC6, 0x11, 0xEC, 0xE9, 0xFF, 0xA4, 0x7F, 0xFA, 0xDD },
+          { 0x3357, 0x25F3, 0x3C1D, 0x3345, 0x25BD, 0x3C89, 0x3340, 0x25B0, 0x3CA3, 0x3340, 0x25B0, 0x3CA3,
+            0x3340, 0x25B0, 0x3CA3, 0x334D, 0x25D7, 0x3C54, 0x334D, 0x25D7, 0x3C54, 0x3345, 0x25BD, 0x3C89,
+            0x3340, 0x25B0, 0x3CA3, 0x3340, 0x25B0, 0x3CA3, 0x334D, 0x25D7, 0x3C54, 0x3345, 0x25BD, 0x3C89,
+            0x32E3, 0x267A, 0x3B00, 0x32E3, 0x2657, 0x3B39, 0x32E3, 0x2632, 0x3B75, 0x32E3, 0x2632, 0x3B75 } },
+        { "mode 5 signed", true,
+          { 0x8A, 0x70, 0xD5, 0x34, 0x84, 0xE3, 0x70, 0xB0, 0xBE, 0xC8, 0xA9, 0xC0, 0x9F, 0xC1, 0x49, 0xBA },
+          { 0x8F13, 0x33E2, 0xBAE9, 0x8F13, 0x33E2, 0xBAE9, 0x8F13, 0x33C4, 0xBAE9, 0x8F13, 0x33A5, 0xBAE9,
+            0x8EFD, 0x3375, 0xBC8D, 0x8EF4, 0x3367, 0xBC9B, 0x8F18, 0x339D, 0xBC65, 0x8EFD, 0x3375, 0xBC8D,
+            0x8F32, 0x33C4, 0xBC3E, 0x8F0E, 0x338F, 0xBC73, 0x8F18, 0x339D, 0xBC65, 0x8F21, 0x33AA, 0xBC58,
+            0x8F21, 0x33AA, 0xBC58, 0x8F21, 0x33AA, 0xBC58, 0x8EF4, 0x3367, 0xBC9B, 0x8F21, 0x33AA, 0xBC58 } },
+        { "mode 6 unsigned", false,
+          { 0xEE, 0xCA, 0xF1, 0x77, 0xD8, 0x36, 0xB7, 0xEC, 0x4C, 0x4F, 0x83, 0xB5, 0xD3, 0x79, 0xDD, 0xD4 },
+          { 0x1531, 0x7519, 0x0E69, 0x16A5, 0x73E3, 0x0C3B, 0x15D3, 0x7502, 0x0DA9, 0x14D9, 0x749E, 0x0DEE,
+            0x14AE, 0x7461, 0x0DB1, 0x14B5, 0x768D, 0x0F9F, 0x1586, 0x756D, 0x0E30, 0x1426, 0x73A4, 0x0CF4,
+            0x1505, 0x74DB, 0x0E2B, 0x14B5, 0x768D, 0x0F9F, 0x1540, 0x75CD, 0x0EAA, 0x1426, 0x73A4, 0x0CF4,
+            0x1452, 0x73E1, 0x0D31, 0x165F, 0x7442, 0x0CB5, 0x1540, 0x75CD, 0x0EAA, 0x1426, 0x73A4, 0x0CF4 } },
+        { "mode 6 signed", true,
+          { 0x8E, 0x47, 0x35, 0xDF, 0x7A, 0x96, 0x0B, 0xA7, 0x1B, 0xAB, 0xFB, 0x25, 0xBD, 0x7A, 0x17, 0x88 },
+          { 0x1F59, 0x330A, 0xC491, 0x2492, 0x31A6, 0xBFB2, 0x205E, 0x32C4, 0xC39D, 0x1E53, 0x3350, 0xC585,
+            0x2208, 0x3192, 0xC7B9, 0x1B98, 0x3340, 0xC6E2, 0x1876, 0x3412, 0xC67A, 0x2077, 0x31FB, 0xC785,
+            0x2208, 0x3192, 0xC7B9, 0x1876, 0x3412, 0xC67A, 0x1B98, 0x3340, 0xC6E2, 0x1EE6, 0x3263, 0xC751,
+            0x1E53, 0x3350, 0xC585, 0x1D4E, 0x3396, 0xC67A, 0x1F59, 0x330A, 0xC491, 0x2181, 0x3277, 0xC28E } },
+        { "mode 7 unsigned", false,
+          { 0xD2, 0xAD, 0x6D, 0x36, 0x00, 0xEE, 0x11, 0xDE, 0x83, 0xF6, 0x72, 0x69, 0x22, 0xED, 0xAC, 0xFA },
+          { 0x3586, 0x6A52, 0x0D52, 0x2C52, 0x638A, 0x0E4A, 0x3348, 0x6AD9, 0x1277, 0x3348, 0x6AD9, 0x1277,
+            0x3586, 0x6D62, 0x0C80, 0x3586, 0x6C5D, 0x0CC6, 0x3068, 0x67D4, 0x10BD, 0x3068, 0x67D4, 0x10BD,
+            0x3586, 0x7090, 0x0BA7, 0x3586, 0x7090, 0x0BA7, 0x34A5, 0x6C47, 0x1348, 0x31EB, 0x696B, 0x11A6,
+            0x3586, 0x6F8A, 0x0BED, 0x3586, 0x6C5D, 0x0CC6, 0x3586, 0x7196, 0x0B62, 0x31EB, 0x696B, 0x11A6 } },
+        { "mode 7 signed", true,
+          { 0x12, 0xE0, 0xF8, 0x0E, 0x1C, 0xE0, 0x4B, 0xC5, 0xCB, 0x38, 0x75, 0x59, 0x80, 0x97, 0xF0, 0xA0 },
+          { 0x007A, 0x8F26, 0x08A0, 0x0364, 0x8FFC, 0x10F4, 0x975F, 0x90EC, 0x0254, 0x90A6, 0x94D7, 0x83D4,
+            0x00F4, 0x8F49, 0x09FD, 0x9AA4, 0x8F04, 0x0554, 0x9AA4, 0x8F04, 0x0554, 0x90A6, 0x94D7, 0x83D4,
+            0x95BC, 0x91E0, 0x00D5, 0x9901, 0x8FF8, 0x03D4, 0x9901, 0x8FF8, 0x03D4, 0x93EB, 0x92EF, 0x80D5,
+            0x8F04, 0x95CC, 0x8554, 0x9AA4, 0x8F04, 0x0554, 0x93EB, 0x92EF, 0x80D5, 0x975F, 0x90EC, 0x0254 } },
+        { "mode 8 unsigned", false,
+          { 0xF6, 0x5F, 0xA4, 0x6A, 0x1A, 0x00, 0x44, 0x77, 0xA2, 0x7D, 0xCA, 0x1F, 0x8F, 0x5C, 0xAE, 0xB9 },
+          { 0x5976, 0x1EC2, 0x1BD2, 0x774A, 0x15DB, 0x1A0E, 0x7689, 0x1540, 0x1851, 0x7956, 0x177E, 0x1EC2,
+            0x6ABB, 0x20F0, 0x1ADE, 0x127A, 0x15CC, 0x1FBD, 0x7689, 0x1540, 0x1851, 0x774A, 0x15DB, 0x1A0E,
+            0x3503, 0x1A28, 0x1DD5, 0x4832, 0x1C94, 0x1CC6, 0x6ABB, 0x20F0, 0x1ADE, 0x7956, 0x177E, 0x1EC2,
+            0x5976, 0x1EC2, 0x1BD2, 0x4832, 0x1C94, 0x1CC6, 0x127A, 0x15CC, 0x1FBD, 0x23BE, 0x17FA, 0x1EC9 } },
+        { "mode 8 signed", true,
+          { 0x56, 0x40, 0x56, 0xBE, 0x6A, 0x44, 0x93, 0x23, 0xC4, 0x97, 0x47, 0xC3, 0x4D, 0xF6, 0xBD, 0x53 },
+          { 0x0431, 0xCE51, 0x5D78, 0x09B3, 0xC34C, 0x606F, 0x0D3E, 0xBC36, 0x6257, 0x045C, 0xCFEC, 0x4DFC,
+            0x0D3E, 0xBC36, 0x6257, 0x0D69, 0xE634, 0x60C8, 0x0621, 0xD448, 0x51A9, 0x0621, 0xD448, 0x51A9,
+            0x09AC, 0xDD00, 0x5904, 0x0F2E, 0xEA90, 0x6476, 0x10F4, 0xEEEC, 0x6824, 0x0D3E, 0xBC36, 0x6257,
+            0x09AC, 0xDD00, 0x5904, 0x0F04, 0xB8AC, 0x634C, 0x09B3, 0xC34C, 0x606F, 0x05F6, 0xCAC6, 0x5E6C } },
+        { "mode 9 unsigned", false,
+          { 0xBA, 0x18, 0xEB, 0x63, 0x0F, 0x07, 0xB1, 0x54, 0x52, 0x58, 0x65, 0x58, 0xEA, 0x34, 0x2D, 0xCB },
+          { 0x5FBB, 0x6871, 0x5468, 0x6014, 0x6B3A, 0x4C67, 0x5FAA, 0x67E6, 0x55FA, 0x6014, 0x6B3A, 0x4C67,
+            0x5FCC, 0x68FD, 0x52D7, 0x5FCC, 0x68FD, 0x52D7, 0x6003, 0x6AAF, 0x4DF8, 0x5EEA, 0x6236, 0x4CC2,
+            0x5FCC, 0x68FD, 0x52D7, 0x5EEA, 0x6236, 0x4CC2, 0x609E, 0x6202, 0x4AFC, 0x5EEA, 0x6236, 0x4CC2,
+            0x6252, 0x61CE, 0x4937, 0x5EEA, 0x6236, 0x4CC2, 0x6252, 0x61CE, 0x4937, 0x5EEA, 0x6236, 0x4CC2 } },
+        { "mode 9 signed", true,
+          { 0x5A, 0x68, 0x7E, 0x33, 0x3F, 0xD6, 0x52, 0x53, 0x15, 0x37, 0x43, 0x6D, 0x44, 0x10, 0x15, 0x6A },
+          { 0x406C, 0x845C, 0xE444, 0x4457, 0x89F5, 0x1D62, 0x4254, 0x8715, 0xA530, 0x4348, 0x8872, 0x85A7,
+            0x4BBE, 0x82AA, 0xD828, 0x4457, 0x89F5, 0x1D62, 0x406C, 0x845C, 0xE444, 0x4160, 0x85B8, 0xC4BA,
+            0x4A1C, 0x8934, 0xCB14, 0x4254, 0x8715, 0xA530, 0x4457, 0x89F5, 0x1D62, 0x4254, 0x8715, 0xA530,
+            0x4AA7, 0x8706, 0xCF70, 0x4C59, 0x803E, 0xDD00, 0x4254, 0x8715, 0xA530, 0x4348, 0x8872, 0x85A7 } },
+        { "mode 10 unsigned", false,
+          { 0x7E, 0x23, 0x03, 0x51, 0xC0, 0x05, 0x54, 0x91, 0xA5, 0x71, 0xCC, 0x36, 0xA4, 0xDF, 0xB0, 0xE7 },
+          { 0x4CFC, 0x21D8, 0x4990, 0x55C3, 0x29B7, 0x47BF, 0x5DAA, 0x30CD, 0x461D, 0x3B84, 0x18B4, 0x0A4B,
+            0x3D2E, 0x13AD, 0x4CD5, 0x55C3, 0x29B7, 0x47BF, 0x36E2, 0x1AE2, 0x0D04, 0x4026, 0x1686, 0x0791,
+            0x6D78, 0x3EF8, 0x42D8, 0x5DAA, 0x30CD, 0x461D, 0x2879, 0x21AA, 0x157E, 0x36E2, 0x1AE2, 0x0D04,
+            0x5DAA, 0x30CD, 0x461D, 0x44C8, 0x1458, 0x04D8, 0x36E2, 0x1AE2, 0x0D04, 0x31BD, 0x1D4E, 0x100B } },
+        { "mode 10 signed", true,
+          { 0x5E, 0x2D, 0x28, 0xDE, 0x0E, 0x86, 0x2F, 0x68, 0x52, 0x7F, 0xA6, 0x3A, 0xD3, 0x86, 0x59, 0x34 },
+          { 0xCA1C, 0x347E, 0xB149, 0xC42D, 0xDEB2, 0x860E, 0xCF9E, 0xE881, 0x03C1, 0xA093, 0xC02E, 0xA492,
+            0xAFF4, 0x1D9B, 0x8C3B, 0x8744, 0x85FE, 0x2D69, 0xAC04, 0xC9FD, 0x9AC3, 0x9521, 0xB65F, 0xAE61,
+            0x8744, 0x85FE, 0x2D69, 0xD730, 0x3FF0, 0xC3D0, 0x8744, 0x85FE, 0x2D69, 0xAC04, 0xC9FD, 0x9AC3,
+            0x9458, 0x0573, 0x1AE2, 0xD730, 0x3FF0, 0xC3D0, 0x9458, 0x0573, 0x1AE2, 0xCA1C, 0x347E, 0xB149 } },
+        { "mode 11 unsigned", false,
+          { 0xE3, 0x5B, 0x5D, 0x0A, 0x75, 0x07, 0xFA, 0xBF, 0x57, 0xFF, 0xA7, 0x39, 0xA3, 0x0E, 0x0D, 0xC3 },
+          { 0x4CD6, 0x2A04, 0x5450, 0x4551, 0x35F9, 0x5819, 0x1CE1, 0x763F, 0x6C70, 0x1CE1, 0x763F, 0x6C70,
+            0x3CDA, 0x436D, 0x5C5B, 0x30A0, 0x56DB, 0x6281, 0x3554, 0x4F62, 0x6024, 0x4CD6, 0x2A04, 0x5450,
+            0x4CD6, 0x2A04, 0x5450, 0x30A0, 0x56DB, 0x6281, 0x20A4, 0x7044, 0x6A8C, 0x5910, 0x1695, 0x4E2A,
+            0x2558, 0x68CB, 0x682E, 0x5910, 0x1695, 0x4E2A, 0x4CD6, 0x2A04, 0x5450, 0x291B, 0x62D0, 0x664A } },
+        { "mode 11 signed", true,
+          { 0x03, 0xC3, 0xF8, 0x04, 0x13, 0x18, 0x97, 0xF8, 0xD4, 0xA9, 0x8B, 0xDD, 0x03, 0xDC, 0x45, 0x42 },
+          { 0xEE56, 0x6DD4, 0x6162, 0xC59B, 0x3757, 0x74B5, 0xD4A8, 0x4B7A, 0x6D91, 0xD03B, 0x458E, 0x6FAA,
+            0xCCB0, 0x40D1, 0x7158, 0xD833, 0x5037, 0x6BE3, 0xC59B, 0x3757, 0x74B5, 0xC59B, 0x3757, 0x74B5,
+            0xEACC, 0x6917, 0x6310, 0xF64F, 0x787D, 0x5D9B, 0xC925, 0x3C14, 0x7307, 0xC59B, 0x3757, 0x74B5,
+            0xE3B6, 0x5F9D, 0x666D, 0xE741, 0x645A, 0x64BF, 0xEE56, 0x6DD4, 0x6162, 0xE741, 0x645A, 0x64BF } },
+        { "mode 12 unsigned", false,
+          { 0x47, 0xAD, 0x0D, 0xD8, 0xC3, 0xA4, 0x71, 0x81, 0xAF, 0xA7, 0xB8, 0x51, 0x3B, 0x54, 0xBC, 0xC5 },
+          { 0x1A43, 0x3C66, 0x549C, 0x1C21, 0x3AFC, 0x517C, 0x1A43, 0x3C66, 0x549C, 0x1C21, 0x3AFC, 0x517C,
+            0x1AD6, 0x3BF7, 0x53A6, 0x1CB4, 0x3A8D, 0x5086, 0x1686, 0x3F3A, 0x5ADB, 0x18F7, 0x3D61, 0x56C5,
+            0x1CB4, 0x3A8D, 0x5086, 0x17D1, 0x3E40, 0x58B2, 0x1864, 0x3DD1, 0x57BB, 0x18F7, 0x3D61, 0x56C5,
+            0x1D48, 0x3A1E, 0x4F90, 0x1CB4, 0x3A8D, 0x5086, 0x18F7, 0x3D61, 0x56C5, 0x1D48, 0x3A1E, 0x4F90 } },
+        { "mode 12 signed", true,
+          { 0x67, 0x3C, 0xD9, 0xF5, 0x88, 0x8F, 0xF6, 0x91, 0xA7, 0xEF, 0xEB, 0xCD, 0xFB, 0x2A, 0x85, 0xB4 },
+          { 0x3A2E, 0x8B60, 0xC052, 0x3954, 0x8FB0, 0x2770, 0x38BB, 0x92B5, 0x7012, 0x38D8, 0x9222, 0x623C,
+            0x3937, 0x9043, 0x3546, 0x38D8, 0x9222, 0x623C, 0x38FD, 0x916A, 0x50F1, 0x391A, 0x90D6, 0x431B,
+            0x3937, 0x9043, 0x3546, 0x38BB, 0x92B5, 0x7012, 0x3954, 0x8FB0, 0x2770, 0x3A4B, 0x8ACC, 0xCE28,
+            0x39F4, 0x8C86, 0xA4A7, 0x3995, 0x8E65, 0x084F, 0x3A11, 0x8BF3, 0xB27D, 0x3937, 0x9043, 0x3546 } },
+        { "mode 13 unsigned", false,
+          { 0x4B, 0xE1, 0xC9, 0x6B, 0x83, 0x8C, 0x1A, 0x9D, 0x65, 0x4E, 0xAE, 0x1C, 0xC3, 0xC0, 0xC4, 0x54 },
+          { 0x5517, 0x1B87, 0x6A7E, 0x5430, 0x1B2C, 0x6AF5, 0x5263, 0x1A77, 0x6BE4, 0x54AA, 0x1B5C, 0x6AB6,
+            0x5263, 0x1A77, 0x6BE4, 0x534A, 0x1AD2, 0x6B6C, 0x52DD, 0x1AA7, 0x6BA5, 0x555B, 0x1BA1, 0x6A5A,
+            0x54E1, 0x1B71, 0x6A9A, 0x52DD, 0x1AA7, 0x6BA5, 0x5591, 0x1BB7, 0x6A3E, 0x52DD, 0x1AA7, 0x6BA5,
+            0x54AA, 0x1B5C, 0x6AB6, 0x52DD, 0x1AA7, 0x6BA5, 0x54AA, 0x1B5C, 0x6AB6, 0x5474, 0x1B47, 0x6AD2 } },
+        { "mode 13 signed", true,
+          { 0xEB, 0x81, 0xF1, 0xD9, 0xF4, 0x3C, 0x19, 0xA7, 0xBE, 0x9F, 0x50, 0x9B, 0x55, 0x4D, 0xC6, 0xC7 },
+          { 0xBFE7, 0x3AB7, 0xD447, 0xC17A, 0x39D4, 0xD305, 0xC30E, 0x38F1, 0xD1C4, 0xC0A5, 0x3A4C, 0xD3AF,
+            0xBD1F, 0x3C46, 0xD67D, 0xBF11, 0x3B2E, 0xD4F0, 0xC17A, 0x39D4, 0xD305, 0xC0A5, 0x3A4C, 0xD3AF,
+            0xBF11, 0x3B2E, 0xD4F0, 0xBF11, 0x3B2E, 0xD4F0, 0xC238, 0x3969, 0xD26E, 0xBEB2, 0x3B63, 0xD53C,
+            0xBF88, 0x3AEC, 0xD492, 0xC1D9, 0x399F, 0xD2B9, 0xBFE7, 0x3AB7, 0xD447, 0xC1D9, 0x399F, 0xD2B9 } },
+        { "mode 14 unsigned", false,
+          { 0x4F, 0xC1, 0x08, 0x3B, 0x73, 0xC1, 0x6F, 0x3C, 0x3A, 0xF9, 0xBD, 0xFE, 0xA0, 0x03, 0xDA, 0x76 },
+          { 0x1FFC, 0x734F, 0x6D46, 0x1FFC, 0x7350, 0x6D47, 0x1FFC, 0x734F, 0x6D45, 0x1FFB, 0x734F, 0x6D44,
+            0x1FFB, 0x734F, 0x6D44, 0x1FFC, 0x734F, 0x6D45, 0x1FFB, 0x734F, 0x6D44, 0x1FFB, 0x734F, 0x6D44,
+            0x1FFC, 0x7350, 0x6D48, 0x1FFC, 0x734F, 0x6D45, 0x1FFC, 0x7350, 0x6D47, 0x1FFC, 0x7350, 0x6D48,
+            0x1FFC, 0x734F, 0x6D45, 0x1FFB, 0x734F, 0x6D44, 0x1FFC, 0x734F, 0x6D46, 0x1FFC, 0x734F, 0x6D46 } },
+        { "mode 14 signed", true,
+          { 0x8F, 0x34, 0x9F, 0x5D, 0x7F, 0xBD, 0xD7, 0x22, 0xD9, 0xDC, 0xFD, 0x33, 0x96, 0x4F, 0x68, 0x5E },
+          { 0x5AB6, 0xA77C, 0x2671, 0x5AB5, 0xA77E, 0x2674, 0x5AB5, 0xA77D, 0x2674, 0x5AB5, 0xA77E, 0x2674,
+            0x5AB5, 0xA77E, 0x2674, 0x5AB5, 0xA77E, 0x2675, 0x5AB6, 0xA77C, 0x2671, 0x5AB6, 0xA77C, 0x2671,
+            0x5AB6, 0xA77C, 0x2672, 0x5AB5, 0xA77D, 0x2673, 0x5AB5, 0xA77E, 0x2675, 0x5AB6, 0xA77C, 0x2671,
+            0x5AB5, 0xA77D, 0x2673, 0x5AB6, 0xA77C, 0x2672, 0x5AB5, 0xA77E, 0x2675, 0x5AB6, 0xA77C, 0x2672 } },
+        { "mode 1 signed, -0 rounds to +0", true,
+          { 0x18, 0x4E, 0xFE, 0xF9, 0xA9, 0xF7, 0xF9, 0x44, 0xD9, 0x42, 0xEB, 0x6A, 0x32, 0x9C, 0x6C, 0x38 },
+          { 0xE1BE, 0x0000, 0x3DC3, 0xDF8B, 0x80E3, 0x3A73, 0xDE54, 0x015F, 0x3B7E, 0xE2E9, 0x01B2, 0x3EB8,
+            0xE349, 0x023D, 0x3F06, 0xDF11, 0x0000, 0x3ADB, 0xDF11, 0x0000, 0x3ADB, 0xE15E, 0x808B, 0x3D75,
+            0xE289, 0x0126, 0x3E69, 0xDECE, 0x007C, 0x3B16, 0xDE91, 0x00EE, 0x3B4A, 0xE349, 0x023D, 0x3F06,
+            0xE349, 0x023D, 0x3F06, 0xDE17, 0x01D1, 0x3BB3, 0xDF8B, 0x80E3, 0x3A73, 0xE15E, 0x808B, 0x3D75 } },
+        { "reserved mode 0x13", false,
+          { 0x93, 0xA5, 0x4B, 0x7E, 0x69, 0xD7, 0x71, 0x98, 0x8A, 0xC1, 0x25, 0xD6, 0x17, 0x0B, 0xCB, 0xA0 },
+          { 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+            0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+            0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+            0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000 } },
+    };
+}
+
+int main() {
+    int failures = 0;
+
+    for (const KnownAnswer& answer : ANSWERS) {
+        uint16_t rgb[16 * 3];
+        texpress::bc6h_decode_block(answer.block, answer.is_signed, rgb);
+
+        for (int i = 0; i < 16 * 3; i++) {
+            if (rgb[i] != answer.rgb[i]) {
+                std::printf("%s: texel %d channel %d is 0x%04X, expected 0x%04X\n", answer.name, i / 3, i % 3, rgb[i], answer.rgb[i]);
+                failures++;
+                break;
+            }
+        }
+    }
+
+    std::printf("%d of %d known answer blocks differ\n", failures, int(std::size(ANSWERS)));
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,80 @@
+// Encodes random blocks at every quality level and checks that the decoded block has the error the encoder scored.
+// The codec is included directly to reach the candidate error of its internal search.
+#include "../source/compression/bc6h.cpp"
+
+#include <cstdio>
+#include <random>
+
+namespace {
+    struct Range {
+        const char* name;
+        bool is_signed;
+        float lo;
+        float hi;
+    };
+
+    // Weighted squared error of the decoded block in the interpolation domain the encoder scores in.
+    double decoded_error(const texpress::BlockInput& in, const uint8_t* block) {
+        uint16_t rgb[16 * 3];
+        texpress::bc6h_decode_block(block, in.is_signed, rgb);
+
+        double error = 0.0;
+        for (int i = 0; i < 16; i++) {
+            for (int c = 0; c < 3; c++) {
+                double d = texpress::to_target(fp16_ieee_to_fp32_value(rgb[i * 3 + c]), in.is_signed) - in.c[c][i];
+                error += in.weights[c] * d * d;
+            }
+        }
+
+        return error;
+    }
+}
+
+int main() {
+    const Range ranges[] = {
+        { "unsigned tiny", false, 0.0f, 1e-4f },
+        { "unsigned unit", false, 0.0f, 1.0f },
+        { "unsigned wide", false, 0.0f, 60000.0f },
+        { "signed unit", true, -1.0f, 1.0f },
+        { "signed wide", true, -60000.0f, 60000.0f },
+    };
+    const texpress::BC6HQuality qualities[] = {
+        texpress::BC6H_FASTEST, texpress::BC6H_NORMAL, texpress::BC6H_PRODUCTION, texpress::BC6H_HIGHEST
+    };
+    constexpr int BLOCKS = 500;
+
+    std::mt19937 rng(1234);
+    int failures = 0;
+
+    for (const Range& range : ranges) {
+        std::uniform_real_distribution<float> value(range.lo, range.hi);
+
+        for (int b = 0; b < BLOCKS; b++) {
+            float rgb[3 * 16];
+            for (float& v : rgb) {
+                v = value(rng);
+            }
+
+            texpress::BC6HOptions options;
+            options.is_signed = range.is_signed;
+            const texpress::BlockInput in = texpress::make_input(rgb, options);
+
+            for (texpress::BC6HQuality quality : qualities) {
+                const texpress::Candidate cand = texpress::encode_block(in, quality);
+                uint8_t block[texpress::BC6H_BLOCK_BYTES];
+                texpress::pack_block(cand, block);
+
+                // The decoder rounds to half floats, which moves every sample by at most a few steps of the domain
+                const double decoded = decoded_error(in, block);
+                const double bound = 1.1 * cand.error + 16 * 3 * 16.0;
+                if (decoded > bound) {
+                    std::printf("%s block %d quality %d mode %d: scored %g, decoded %g\n", range.name, b, int(quality), cand.mode + 1, cand.error, decoded);
+                    failures++;
+                }
+            }
+        }
+    }
+
+    std::printf("%d of %d blocks differ from their scored error\n", failures, int(std::size(ranges) * std::size(qualities)) * BLOCKS);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,188 @@
+// Compresses a volume brick by brick and checks every brick against encoding it on its own, the decoded voxels
+// against compressing the whole volume and the saved file against the volume in memory.
+#include <texpress/compression/bricks.hpp>
+#include <texpress/compression/bc6h.hpp>
+#include <texpress/io/file_io.hpp>
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+namespace {
+    int failures = 0;
+
+    void check(bool condition, const char* what) {
+        if (!condition) {
+            std::printf("FAILED: %s\n", what);
+            failures++;
+        }
+    }
+
+    texpress::EncoderSettings encoder_settings(uint32_t threads) {
+        texpress::EncoderSettings settings;
+        settings.encoding = nvtt::Format_BC6S;
+        settings.backend = texpress::EncoderBackend::BACKEND_NATIVE;
+        settings.threads = threads;
+        return settings;
+    }
+
+    bool same_layout(const texpress::BrickedVolume& a, const texpress::BrickedVolume& b) {
+        return a.dimensions == b.dimensions && a.brick_size == b.brick_size && a.bricks == b.bricks
+            && a.channels == b.channels && a.gl_internal == b.gl_internal && a.directory == b.directory;
+    }
+}
+
+int main() {
+    // Bricks at the upper borders are cropped along every axis
+    const glm::ivec4 dimensions(37, 21, 10, 2);
+    const glm::ivec3 brick_size(16, 8, 4);
+    const uint8_t channels = 3;
+    const char* path = "bricks_test.bricks";
+
+    std::vector<float> texels((uint64_t)dimensions.x * dimensions.y * dimensions.z * dimensions.w * channels);
+    for (uint64_t i = 0; i < texels.size(); i++) {
+        const uint64_t voxel = i / channels;
+        const float x = voxel % dimensions.x;
+        const float y = (voxel / dimensions.x) % dimensions.y;
+        const float z = (voxel / dimensions.x / dimensions.y) % dimensions.z;
+        const float t = voxel / dimensions.x / dimensions.y / dimensions.z;
+        texels[i] = std::sin(0.1f * x + 0.7f * (i % channels)) + std::cos(0.15f * y - 0.2f * z) + 0.5f * t;
+    }
+
+    texpress::EncoderData input{};
+    input.gl_format = (uint32_t)texpress::gl_format(channels);
+    input.gl_internal = (uint32_t)texpress::gl_internal(channels, 32, true);
+    input.dim_x = dimensions.x;
+    input.dim_y = dimensions.y;
+    input.dim_z = dimensions.z;
+    input.dim_t = dimensions.w;
+    input.channels = channels;
+    input.data_bytes = texels.size() * sizeof(float);
+    input.data_ptr = (uint8_t*)texels.data();
+
+    int progress = 0;
+    texpress::EncoderSettings settings = encoder_settings(3);
+    settings.progress_ptr = &progress;
+
+    texpress::BrickedVolume volume;
+    check(texpress::compress_bricked(settings, input, volume, brick_size), "compress bricked");
+    check(progress == 100, "progress");
+    check(volume.bricks == glm::ivec4(3, 3, 3, 2) && volume.brick_count() == 54, "brick grid");
+    check(volume.directory.size() == 55 && volume.data.size() == volume.directory.back(), "directory");
+
+    // Every voxel lies in the brick brick_id returns
+    bool located = true;
+    for (int t = 0; t < dimensions.w; t++) {
+        for (int z = 0; z < dimensions.z; z++) {
+            for (int y = 0; y < dimensions.y; y++) {
+                for (int x = 0; x < dimensions.x; x++) {
+                    const uint64_t id = volume.brick_id(glm::ivec4(x, y, z, t));
+                    const glm::ivec4 origin = volume.brick_origin(id);
+                    const glm::ivec3 extent = volume.brick_extent(id);
+                    located = located && id < volume.brick_count() && origin.w == t
+                        && x >= origin.x && x < origin.x + extent.x
+                        && y >= origin.y && y < origin.y + extent.y
+                        && z >= origin.z && z < origin.z + extent.z;
+                }
+            }
+        }
+    }
+    check(located, "brick of every voxel");
+    check(volume.brick_extent(volume.brick_count() - 1) == glm::ivec3(5, 5, 2), "cropped brick extent");
+
+    // Brick extents are multiples of the block size, so every brick decodes to the same voxels as compressing the whole volume
+    const texpress::Encoder encoder;
+    texpress::EncoderSettings whole = encoder_settings(0);
+    whole.progress_ptr = &progress;
+    std::vector<uint8_t> volume_blocks(texpress::Encoder::encoded_size(whole, input));
+    texpress::MemorySink sink(volume_blocks.data(), volume_blocks.size());
+    texpress::EncoderData volume_out{};
+    std::vector<float> volume_decoded(texels.size());
+    check(encoder.compress(whole, input, volume_out, sink), "compress whole volume");
+    check(texpress::bc6h_decode_volume(volume_blocks.data(), dimensions.x, dimensions.y, dimensions.z * dimensions.w, true, channels, 32, (uint8_t*)volume_decoded.data(), 0), "decode whole volume");
+
+    // Each brick is also identical to encoding its voxels alone
+    bool identical = true;
+    bool decoded_match = true;
+    for (uint64_t id = 0; id < volume.brick_count(); id++) {
+        const glm::ivec4 origin = volume.brick_origin(id);
+        const glm::ivec3 extent = volume.brick_extent(id);
+        const uint64_t row_values = (uint64_t)extent.x * channels;
+
+        std::vector<float> brick((uint64_t)extent.x * extent.y * extent.z * channels);
+        std::vector<float> brick_decoded(brick.size());
+        for (int z = 0; z < extent.z; z++) {
+            for (int y = 0; y < extent.y; y++) {
+                const uint64_t src = ((((uint64_t)origin.w * dimensions.z + origin.z + z) * dimensions.y + origin.y + y) * dimensions.x + origin.x) * channels;
+                const uint64_t dst = (uint64_t)(z * extent.y + y) * row_values;
+                std::memcpy(brick.data() + dst, texels.data() + src, row_values * sizeof(float));
+                std::memcpy(brick_decoded.data() + dst, volume_decoded.data() + src, row_values * sizeof(float));
+            }
+        }
+
+        texpress::EncoderData brick_in = input;
+        brick_in.dim_x = extent.x;
+        brick_in.dim_y = extent.y;
+        brick_in.dim_z = extent.z;
+        brick_in.dim_t = 1;
+        brick_in.data_bytes = brick.size() * sizeof(float);
+        brick_in.data_ptr = (uint8_t*)brick.data();
+
+        texpress::EncoderSettings single = encoder_settings(1);
+        single.progress_ptr = &progress;
+        std::vector<uint8_t> blocks(volume.brick_bytes(id));
+        texpress::EncoderData brick_out{};
+        brick_out.data_bytes = blocks.size();
+        brick_out.data_ptr = blocks.data();
+        identical = identical && encoder.compress(single, brick_in, brick_out)
+            && std::memcmp(blocks.data(), volume.data.data() + volume.directory[id], blocks.size()) == 0;
+
+        texpress::Texture decoded;
+        decoded_match = decoded_match && texpress::decompress_brick(volume, id, decoded, channels)
+            && decoded.dimensions == glm::ivec4(extent.x, extent.y, extent.z, 1)
+            && decoded.bytes() == brick.size() * sizeof(float)
+            && std::memcmp(decoded.data.data(), brick_decoded.data(), decoded.bytes()) == 0;
+    }
+    check(identical, "bricks match encoding them alone");
+    check(decoded_match, "decoded bricks match the decoded volume");
+
+    // Saved files load completely or directory only, single bricks are read at their offset
+    check(texpress::save_bricked(path, volume), "save bricked");
+    texpress::BrickedVolume loaded;
+    check(texpress::load_bricked(path, loaded) && same_layout(loaded, volume) && loaded.data == volume.data, "load bricked");
+
+    texpress::BrickedVolume directory;
+    check(texpress::load_bricked(path, directory, false) && same_layout(directory, volume) && directory.data.empty(), "load directory only");
+    std::vector<uint8_t> blocks;
+    const uint64_t id = volume.brick_count() - 1;
+    check(texpress::read_brick(path, directory, id, blocks) && blocks.size() == volume.brick_bytes(id)
+        && std::memcmp(blocks.data(), volume.data.data() + volume.directory[id], blocks.size()) == 0, "read brick");
+    texpress::Texture decoded;
+    check(!texpress::decompress_brick(directory, id, decoded), "decompressing without data fails");
+    check(!texpress::read_brick(path, directory, volume.brick_count(), blocks), "read past the last brick fails");
+
+    // Directory entries that decrease or point past the end of the file are rejected
+    std::vector<char> file(texpress::file_size(path));
+    texpress::file_read(path, file.data(), file.size());
+    const uint64_t directory_offset = 2 * sizeof(uint32_t) + sizeof(glm::ivec4) + sizeof(glm::ivec3) + sizeof(glm::ivec4) + 2 * sizeof(uint32_t) + sizeof(uint64_t);
+    const uint64_t corrupt = volume.directory.back() + 1;
+    std::memcpy(file.data() + directory_offset + sizeof(uint64_t), &corrupt, sizeof(corrupt));
+    check(texpress::file_save(path, file.data(), file.size()), "write corrupt file");
+    check(!texpress::load_bricked(path, loaded) && loaded.directory.empty(), "corrupt directory is rejected");
+
+    check(texpress::file_save(path, file.data(), directory_offset), "write truncated file");
+    check(!texpress::load_bricked(path, loaded), "truncated file is rejected");
+    std::remove(path);
+
+    // Other encodings and missing normalization peaks are rejected
+    texpress::EncoderSettings bc7 = settings;
+    bc7.encoding = nvtt::Format_BC7;
+    check(!texpress::compress_bricked(bc7, input, loaded, brick_size), "other encodings are rejected");
+    texpress::EncoderSettings peaks = settings;
+    peaks.normalize_peaks = { 0.0f, 1.0f };
+    check(!texpress::compress_bricked(peaks, input, loaded, brick_size), "too few peaks are rejected");
+
+    std::printf("%d brick checks failed\n", failures);
+    return (failures == 0) ? 0 : 1;
+}
@@ -0,0 +1,136 @@
+// Checks the error metrics on fields with a known, constant error per channel.
+// All values are multiples of 1/8, so the differences are exact and the expected statistics follow in closed form.
+#include <texpress/utility/error_metrics.hpp>
+#include <texpress/utility/half.hpp>
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+namespace {
+    int failures = 0;
+
+    void check(bool condition, const char* what) {
+        if (!condition) {
+            std::printf("FAILED: %s\n", what);
+            failures++;
+        }
+    }
+
+    bool near(double a, double b) {
+        return std::fabs(a - b) <= 1e-9 * std::max(1.0, std::fabs(b));
+    }
+
+    texpress::Texture float_texture(const glm::ivec4& dimensions, uint8_t channels, const std::vector<float>& values) {
+        texpress::Texture tex;
+        tex.dimensions = dimensions;
+        tex.channels = channels;
+        tex.gl_type = gl::GLenum::GL_FLOAT;
+        tex.gl_internal = texpress::gl_internal(channels, 32, true);
+        tex.gl_format = texpress::gl_format(channels);
+        tex.data.resize(values.size() * sizeof(float));
+        std::memcpy(tex.data.data(), values.data(), tex.data.size());
+        return tex;
+    }
+}
+
+int main() {
+    // Texels do not fill the last reduction block
+    const glm::ivec4 dimensions(37, 29, 3, 2);
+    const uint64_t texels = (uint64_t)dimensions.x * dimensions.y * dimensions.z * dimensions.w;
+    const float offset[3] = { 0.5f, -0.25f, 0.0f };
+    const double distance = std::sqrt(0.5 * 0.5 + 0.25 * 0.25);
+
+    // Reference channel c covers [c, c + 63 / 8]
+    std::vector<float> reference(texels * 3);
+    std::vector<float> reconstruction(texels * 3);
+    for (uint64_t i = 0; i < texels; i++) {
+        for (int c = 0; c < 3; c++) {
+            reference[i * 3 + c] = (float)((i * 7 + c) % 64) / 8.0f + c;
+            reconstruction[i * 3 + c] = reference[i * 3 + c] + offset[c];
+        }
+    }
+
+    // Closed form statistics, identical for every thread count
+    for (uint32_t threads : { 1u, 2u, 7u, 0u }) {
+        texpress::ErrorStats stats;
+        std::vector<float> component(texels * 3);
+        std::vector<float> distances(texels);
+        check(texpress::compute_error(reference.data(), 3, reconstruction.data(), 3, texels, stats, component.data(), distances.data(), threads), "compute error");
+
+        check(stats.texels == texels && stats.channels == 3, "texel and channel count");
+        for (int c = 0; c < 3; c++) {
+            check(near(stats.mean[c], std::fabs(offset[c])), "mean error");
+            check(near(stats.rms[c], std::fabs(offset[c])), "rms error");
+            check(stats.max[c] == std::fabs(offset[c]), "max error");
+            check(stats.range[c] == 63.0 / 8.0, "reference range");
+        }
+        check(near(stats.psnr[0], 20.0 * std::log10(63.0 / 8.0 / 0.5)), "psnr");
+        check(std::isinf(stats.psnr[2]), "psnr without error");
+        check(near(stats.rms_total, std::sqrt((0.25 + 0.0625) / 3.0)), "total rms");
+        // Distances are irrational and summed in float within a block
+        check(std::fabs(stats.distance_mean - distance) < 1e-5 && std::fabs(stats.distance_rms - distance) < 1e-5 && std::fabs(stats.distance_max - distance) < 1e-6, "distance");
+
+        bool fields = true;
+        for (uint64_t i = 0; i < texels; i++) {
+            fields = fields && std::fabs(distances[i] - distance) < 1e-6;
+            for (int c = 0; c < 3; c++) {
+                fields = fields && component[i * 3 + c] == std::fabs(offset[c]);
+            }
+        }
+        check(fields, "error fields");
+    }
+
+    // Channels missing in the reconstruction are compared against 0
+    {
+        std::vector<float> two(texels * 2);
+        for (uint64_t i = 0; i < texels; i++) {
+            two[i * 2] = reconstruction[i * 3];
+            two[i * 2 + 1] = reconstruction[i * 3 + 1];
+        }
+
+        double mean = 0.0;
+        for (uint64_t i = 0; i < texels; i++) {
+            mean += reference[i * 3 + 2];
+        }
+        mean /= texels;
+
+        texpress::ErrorStats stats;
+        check(texpress::compute_error(reference.data(), 3, two.data(), 2, texels, stats), "compute error with fewer channels");
+        check(near(stats.mean[0], 0.5) && near(stats.mean[2], mean), "missing channels");
+    }
+
+    // Half textures give the same results as their float values
+    {
+        texpress::Texture ref = float_texture(dimensions, 3, reference);
+        texpress::Texture rec = float_texture(dimensions, 3, reconstruction);
+        texpress::Texture ref_half;
+        check(texpress::convert_texture(ref, ref_half, 16), "convert to half");
+
+        texpress::ErrorStats stats, stats_half;
+        check(texpress::error_stats(ref, rec, stats) && texpress::error_stats(ref_half, rec, stats_half), "texture error stats");
+        check(std::memcmp(&stats, &stats_half, sizeof(stats)) == 0, "half and float stats");
+
+        texpress::Texture component, distances;
+        texpress::ErrorStats component_stats;
+        check(texpress::component_error(ref_half, rec, component, &component_stats), "component error texture");
+        check(component.channels == 3 && component.dimensions == dimensions && component.bytes() == texels * 3 * sizeof(float), "component error layout");
+        check(((const float*)component.data.data())[texels * 3 - 3] == 0.5f && near(component_stats.mean[1], 0.25), "component error values");
+        check(texpress::distance_error(texpress::texture_view(ref), texpress::texture_view(rec), distances), "distance error view");
+        check(distances.channels == 1 && distances.bytes() == texels * sizeof(float), "distance error layout");
+        check(std::fabs(((const float*)distances.data.data())[0] - distance) < 1e-6, "distance error values");
+
+        // Other dimensions or compressed data cannot be compared
+        texpress::Texture other = rec;
+        other.dimensions.w = 1;
+        other.dimensions.z *= 2;
+        check(!texpress::error_stats(ref, other, stats), "mismatching dimensions are rejected");
+        other = rec;
+        other.gl_internal = gl::GLenum::GL_COMPRESSED_RGB_BPTC_SIGNED_FLOAT;
+        check(!texpress::error_stats(ref, other, stats), "compressed data is rejected");
+    }
+
+    std::printf("%d error metric checks failed\n", failures);
+    return (failures == 0) ? 0 : 1;
+}
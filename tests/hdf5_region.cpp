@@ -0,0 +1,226 @@
+// Reads regions of interest of (t, z, y, x) component datasets and checks the interleaved values against the
+// element each output position maps to, for offsets, counts, strides, custom axes, slabs and half output.
+#include <texpress/io/hdf_io.hpp>
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace {
+    int failures = 0;
+
+    void check(bool condition, const char* what) {
+        if (!condition) {
+            std::printf("FAILED: %s\n", what);
+            failures++;
+        }
+    }
+
+    constexpr uint64_t X = 11, Y = 7, Z = 6, T = 3;
+
+    // Every element stores its own linear index, components are offset by 10000
+    float value(uint64_t c, uint64_t t, uint64_t z, uint64_t y, uint64_t x) {
+        return (float)(c * 10000 + ((t * Z + z) * Y + y) * X + x);
+    }
+
+    // Values a region of the (t, z, y, x) datasets is expected to read, interleaved in x, y, z, t order
+    std::vector<float> expected_region(const texpress::HDF5Region& region, uint64_t components) {
+        const uint64_t full[4] = { X, Y, Z, T };
+        uint64_t count[4];
+        for (int d = 0; d < 4; d++) {
+            count[d] = (region.count[d]) ? region.count[d] : (full[d] - region.offset[d] + region.stride[d] - 1) / region.stride[d];
+        }
+
+        std::vector<float> values;
+        for (uint64_t t = 0; t < count[3]; t++) {
+            for (uint64_t z = 0; z < count[2]; z++) {
+                for (uint64_t y = 0; y < count[1]; y++) {
+                    for (uint64_t x = 0; x < count[0]; x++) {
+                        for (uint64_t c = 0; c < components; c++) {
+                            values.push_back(value(c,
+                                region.offset[3] + t * region.stride[3], region.offset[2] + z * region.stride[2],
+                                region.offset[1] + y * region.stride[1], region.offset[0] + x * region.stride[0]));
+                        }
+                    }
+                }
+            }
+        }
+        return values;
+    }
+
+    bool equal(const std::vector<uint8_t>& data, const std::vector<float>& values) {
+        return data.size() == values.size() * sizeof(float) && std::memcmp(data.data(), values.data(), data.size()) == 0;
+    }
+
+    void write_file(const std::string& path) {
+        HighFive::File file(path, HighFive::File::ReadWrite | HighFive::File::Create | HighFive::File::Truncate);
+
+        for (uint64_t c = 0; c < 2; c++) {
+            std::vector<float> values;
+            for (uint64_t t = 0; t < T; t++)
+                for (uint64_t z = 0; z < Z; z++)
+                    for (uint64_t y = 0; y < Y; y++)
+                        for (uint64_t x = 0; x < X; x++)
+                            values.push_back(value(c, t, z, y, x));
+
+            file.createDataSet<float>((c == 0) ? "/u" : "/v", HighFive::DataSpace({ T, Z, Y, X })).write_raw(values.data());
+        }
+
+        // Time series of slices stored as (t, y, x) and a dataset of another shape and type
+        std::vector<float> series;
+        for (uint64_t t = 0; t < T; t++)
+            for (uint64_t y = 0; y < Y; y++)
+                for (uint64_t x = 0; x < X; x++)
+                    series.push_back(value(0, t, 0, y, x));
+        file.createDataSet<float>("/series", HighFive::DataSpace({ T, Y, X })).write_raw(series.data());
+
+        std::vector<double> other(T * Z * Y * (X - 1), 0.0);
+        file.createDataSet<double>("/other", HighFive::DataSpace({ T, Z, Y, X - 1 })).write_raw(other.data());
+    }
+}
+
+int main() {
+    const std::string path = "hdf5_region_test.h5";
+    write_file(path);
+
+    texpress::hdf5 file(path.c_str());
+    check(file.is_open(), "open file");
+    const std::vector<std::string> paths = { "/u", "/v" };
+
+    // The default region reads every element
+    {
+        texpress::HDF5Region region;
+        std::vector<uint8_t> data;
+        check(file.region_dimensions("/u", region) == std::vector<uint64_t>({ X, Y, Z, T }), "full region dimensions");
+        check(file.read_region<float>(paths, region, data) && equal(data, expected_region(region, 2)), "full region");
+    }
+
+    // Offsets, counts and strides on every axis, with counts of 0 reading up to the end
+    for (uint32_t threads : { 1u, 4u, 0u }) {
+        texpress::HDF5Region region;
+        const uint64_t offset[4] = { 1, 2, 1, 1 };
+        const uint64_t count[4] = { 4, 0, 2, 0 };
+        const uint64_t stride[4] = { 3, 2, 2, 1 };
+        for (int d = 0; d < 4; d++) {
+            region.offset[d] = offset[d];
+            region.count[d] = count[d];
+            region.stride[d] = stride[d];
+        }
+
+        std::vector<uint8_t> data;
+        check(file.region_dimensions("/u", region) == std::vector<uint64_t>({ 4, 3, 2, 2 }), "strided region dimensions");
+        check(file.read_region<float>(paths, region, data, threads) && equal(data, expected_region(region, 2)), "strided region");
+    }
+
+    // A single time step and slice, the leading dimensions select one element
+    {
+        texpress::HDF5Region region;
+        region.offset[3] = 2;
+        region.count[3] = 1;
+        region.offset[2] = 5;
+        region.count[2] = 1;
+        region.offset[1] = 3;
+
+        std::vector<uint8_t> data;
+        check(file.read_region<float>({ "/v" }, region, data) && data.size() == 4 * X * sizeof(float), "single slice size");
+        bool values = data.size() == 4 * X * sizeof(float);
+        for (uint64_t y = 0; y < 4 && values; y++) {
+            for (uint64_t x = 0; x < X; x++) {
+                values = values && ((const float*)data.data())[y * X + x] == value(1, 2, 5, 3 + y, x);
+            }
+        }
+        check(values, "single slice");
+    }
+
+    // Slabs are relative to the region and scaled by its stride
+    {
+        texpress::HDF5Region region;
+        region.offset[2] = 1;
+        region.stride[2] = 2;
+        region.offset[3] = 1;
+
+        std::vector<uint8_t> data(X * Y * 2 * paths.size() * sizeof(float));
+        check(file.read_slab<float>(paths, region, 1, 1, 2, data.data()), "read slab");
+
+        texpress::HDF5Region slab = region;
+        slab.offset[2] = 3;
+        slab.count[2] = 2;
+        slab.offset[3] = 2;
+        slab.count[3] = 1;
+        check(equal(data, expected_region(slab, 2)), "slab values");
+    }
+
+    // Half output matches converting the float values
+    {
+        texpress::HDF5Region region;
+        region.offset[0] = 2;
+        region.stride[3] = 2;
+
+        std::vector<uint8_t> data;
+        const std::vector<float> values = expected_region(region, 2);
+        std::vector<uint16_t> halfs(values.size());
+        texpress::convert_to_half(values.data(), halfs.data(), values.size());
+        check(file.read_region<float>(paths, region, data, 2, true) && data.size() == halfs.size() * sizeof(uint16_t)
+            && std::memcmp(data.data(), halfs.data(), data.size()) == 0, "half region");
+        check(!file.read_region<double>({ "/other" }, region, data, 2, true), "half of double datasets is rejected");
+    }
+
+    // Custom axes map x, y and t onto a (t, y, x) dataset, z is missing and has a single element
+    {
+        texpress::HDF5Region region;
+        region.axes[0] = 2;
+        region.axes[1] = 1;
+        region.axes[2] = 3;
+        region.axes[3] = 0;
+        region.offset[0] = 4;
+        region.offset[3] = 1;
+
+        std::vector<uint8_t> data;
+        check(file.region_dimensions("/series", region) == std::vector<uint64_t>({ X - 4, Y, 1, T - 1 }), "custom axes dimensions");
+        region.count[2] = 1;
+        check(file.read_region<float>({ "/series" }, region, data) && equal(data, expected_region(region, 1)), "custom axes");
+
+        // The default layout of a rank 3 dataset reads its first dimension as z
+        texpress::HDF5Region slices;
+        check(file.region_dimensions("/series", slices) == std::vector<uint64_t>({ X, Y, T, 1 }), "default axes of rank 3");
+    }
+
+    // Regions outside of the datasets and invalid mappings fail without data
+    {
+        std::vector<uint8_t> data;
+        texpress::HDF5Region region;
+        region.offset[0] = X;
+        check(file.region_dimensions("/u", region).empty() && !file.read_region<float>(paths, region, data), "offset past the extent");
+
+        region = texpress::HDF5Region();
+        region.offset[1] = 1;
+        region.count[1] = 4;
+        region.stride[1] = 2;
+        check(file.region_dimensions("/u", region).empty(), "count past the extent");
+
+        region = texpress::HDF5Region();
+        for (int d = 0; d < 4; d++) {
+            region.axes[d] = d;
+        }
+        check(file.region_dimensions("/u", region).empty(), "ascending axes are rejected");
+
+        region = texpress::HDF5Region();
+        region.axes[2] = 3;
+        region.axes[3] = 0;
+        region.offset[2] = 1;
+        check(file.region_dimensions("/series", region).empty(), "offset on a missing axis");
+
+        check(!file.read_region<float>({ "/u", "/other" }, texpress::HDF5Region(), data), "datasets of different shape");
+        check(file.region_dimensions("/missing", texpress::HDF5Region()).empty(), "missing dataset");
+    }
+
+    texpress::hdf5 missing("hdf5_region_missing.h5");
+    std::vector<uint8_t> data;
+    check(!missing.is_open() && !missing.read_region<float>(paths, texpress::HDF5Region(), data), "missing file");
+
+    std::remove(path.c_str());
+
+    std::printf("%d hdf5 region checks failed\n", failures);
+    return (failures == 0) ? 0 : 1;
+}
@@ -0,0 +1,119 @@
+// Writes a BC6H dataset as one KTX1 file per time step and reads slices back through the index and the reader.
+#include <texpress/io/ktx_index.hpp>
+#include <texpress/io/file_io.hpp>
+#include <texpress/helpers/ktxhelper.hpp>
+#include <texpress/compression/bc6h.hpp>
+
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+    int failures = 0;
+
+    void check(bool condition, const char* what) {
+        if (!condition) {
+            std::printf("FAILED: %s\n", what);
+            failures++;
+        }
+    }
+
+    bool same_index(const texpress::KTXIndex& a, const texpress::KTXIndex& b) {
+        return a.dimensions == b.dimensions && a.gl_internal == b.gl_internal && a.slice_bytes == b.slice_bytes
+            && a.files == b.files && a.slice_files == b.slice_files && a.slice_offsets == b.slice_offsets;
+    }
+}
+
+int main() {
+    constexpr uint32_t DIM_X = 12;
+    constexpr uint32_t DIM_Y = 8;
+    constexpr uint32_t DIM_Z = 3;
+    constexpr uint32_t DIM_T = 2;
+    const char* path = "ktx_index_test";
+    const gl::GLenum format = gl::GLenum::GL_COMPRESSED_RGB_BPTC_SIGNED_FLOAT;
+    const uint64_t slice_bytes = texpress::bc6h_encoded_size(DIM_X, DIM_Y);
+
+    // Random slices, encoded one by one like the compressor does
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<float> value(-4.0f, 4.0f);
+    std::vector<uint8_t> blocks(DIM_T * DIM_Z * slice_bytes);
+    std::vector<float> slice(DIM_X * DIM_Y * 3);
+    texpress::BC6HOptions options;
+    for (uint32_t s = 0; s < DIM_T * DIM_Z; s++) {
+        for (float& v : slice) {
+            v = value(rng);
+        }
+        check(texpress::bc6h_encode_slice((const uint8_t*)slice.data(), DIM_X, DIM_Y, 3, 32, options, blocks.data() + s * slice_bytes), "encode slice");
+    }
+
+    std::vector<std::string> paths;
+    for (uint32_t t = 0; t < DIM_T; t++) {
+        std::vector<uint8_t> file = texpress::ktx_header(glm::ivec4(DIM_X, DIM_Y, DIM_Z, DIM_T), format, DIM_Z, DIM_Z * slice_bytes);
+        file.insert(file.end(), blocks.begin() + t * DIM_Z * slice_bytes, blocks.begin() + (t + 1) * DIM_Z * slice_bytes);
+        paths.push_back(std::string(path) + "_" + std::to_string(t));
+        check(texpress::file_save(paths.back().c_str(), (char*)file.data(), file.size()), "write KTX file");
+    }
+
+    // Without a sidecar the reader parses the headers
+    const std::string path_index = texpress::ktx_index_path(path);
+    std::remove(path_index.c_str());
+
+    texpress::KTXReader reader;
+    check(reader.open(path), "open without index");
+    const texpress::KTXIndex& index = reader.index();
+    check(index.dimensions == glm::ivec4(DIM_X, DIM_Y, DIM_Z, DIM_T), "index dimensions");
+    check(index.gl_internal == format, "index format");
+    check(index.slice_bytes == slice_bytes, "index slice size");
+    check(index.slices() == DIM_T * DIM_Z && index.files.size() == DIM_T, "index slice count");
+
+    std::vector<uint8_t> read(2 * slice_bytes);
+    check(reader.read(1, 1, 2, read.data()), "read slices");
+    check(std::memcmp(read.data(), blocks.data() + (DIM_Z + 1) * slice_bytes, read.size()) == 0, "read slices content");
+    check(!reader.read(1, 2, 2, read.data()), "read past the last slice fails");
+    check(!reader.read(DIM_T, 0, 1, read.data()), "read past the last time step fails");
+
+    // Decoding matches decoding the blocks directly
+    texpress::Texture decoded;
+    check(reader.decode(1, 0, DIM_Z, decoded, 3, 2), "decode slices");
+    check(decoded.dimensions == glm::ivec4(DIM_X, DIM_Y, DIM_Z, 1) && decoded.channels == 3, "decoded dimensions");
+    std::vector<uint8_t> expected(DIM_Z * DIM_X * DIM_Y * 3 * sizeof(float));
+    const uint64_t slice_texels = DIM_X * DIM_Y * 3 * sizeof(float);
+    for (uint32_t z = 0; z < DIM_Z; z++) {
+        texpress::bc6h_decode_slice(blocks.data() + (DIM_Z + z) * slice_bytes, DIM_X, DIM_Y, true, 3, 32, expected.data() + z * slice_texels);
+    }
+    check(decoded.data == expected, "decoded content");
+
+    // The sidecar round trips and takes precedence over the headers
+    texpress::KTXIndex built;
+    check(texpress::build_ktx_index(paths, built) && same_index(built, index), "build index");
+    check(texpress::save_ktx_index(path_index.c_str(), built), "save index");
+    texpress::KTXIndex loaded;
+    check(texpress::load_ktx_index(path_index.c_str(), loaded) && same_index(loaded, built), "load index");
+
+    std::remove(paths[0].c_str());
+    texpress::KTXReader indexed;
+    check(indexed.open(path) && same_index(indexed.index(), built), "open with index");
+    check(indexed.read(1, 0, 1, read.data()) && std::memcmp(read.data(), blocks.data() + DIM_Z * slice_bytes, slice_bytes) == 0, "read through index");
+
+    // A truncated sidecar is rejected
+    std::vector<char> truncated(texpress::file_size(path_index.c_str()) - 1);
+    texpress::file_read(path_index.c_str(), truncated.data(), truncated.size());
+    texpress::file_save(path_index.c_str(), truncated.data(), truncated.size());
+    check(!texpress::load_ktx_index(path_index.c_str(), loaded), "truncated index is rejected");
+
+    // Files of different formats cannot share an index
+    std::vector<uint8_t> other = texpress::ktx_header(glm::ivec4(DIM_X, DIM_Y, DIM_Z, DIM_T), gl::GLenum::GL_COMPRESSED_RGB_BPTC_UNSIGNED_FLOAT, DIM_Z, DIM_Z * slice_bytes);
+    other.resize(other.size() + DIM_Z * slice_bytes);
+    check(texpress::file_save(paths[0].c_str(), (char*)other.data(), other.size()), "write mismatching KTX file");
+    check(!texpress::build_ktx_index(paths, built), "mismatching formats are rejected");
+
+    for (const std::string& file : paths) {
+        std::remove(file.c_str());
+    }
+    std::remove(path_index.c_str());
+
+    std::printf("%d KTX index checks failed\n", failures);
+    return (failures == 0) ? 0 : 1;
+}
@@ -0,0 +1,113 @@
+// Compares the parallel normalizer with the scalar functions of normalize.hpp and checks the denormalized round trip.
+#include <texpress/utility/normalizer.hpp>
+#include <texpress/utility/normalize.hpp>
+#include <texpress/utility/half.hpp>
+
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+namespace {
+    int failures = 0;
+
+    void check(bool condition, const char* what, int channels) {
+        if (!condition) {
+            std::printf("FAILED: %s (%d channels)\n", what, channels);
+            failures++;
+        }
+    }
+
+    float max_difference(const float* a, const float* b, uint64_t count) {
+        float difference = 0.0f;
+        for (uint64_t i = 0; i < count; i++) {
+            difference = std::max(difference, std::fabs(a[i] - b[i]));
+        }
+        return difference;
+    }
+}
+
+int main() {
+    // Slices span several chunks and end in the middle of a lane pattern
+    const glm::ivec4 dimensions(421, 317, 2, 2);
+    const uint64_t slices = dimensions.z * dimensions.w;
+    const uint64_t slice_texels = (uint64_t)dimensions.x * dimensions.y;
+
+    std::mt19937 rng(7);
+    for (int channels = 1; channels <= 4; channels++) {
+        const uint64_t count = slices * slice_texels * channels;
+        const glm::ivec4 small(dimensions.x / 8, dimensions.y / 8, 3, 1);
+        const uint64_t small_count = (uint64_t)small.x * small.y * small.z * channels;
+
+        // Every component has its own range, the last slice of the last component is constant
+        std::vector<float> values(count);
+        for (uint64_t i = 0; i < count; i++) {
+            const int c = i % channels;
+            std::uniform_real_distribution<float> value(-10.0f * c - 1.0f, 100.0f * c + 1.0f);
+            values[i] = value(rng);
+        }
+        for (uint64_t i = (slices - 1) * slice_texels * channels + channels - 1; i < count; i += channels) {
+            values[i] = 3.0f;
+        }
+
+        // Peaks, for every thread count
+        const std::vector<float> expected = texpress::find_peaks_per_component(values.data(), dimensions, channels);
+        for (uint32_t threads : { 1u, 3u, 0u }) {
+            std::vector<float> peaks;
+            check(texpress::find_peaks_parallel(values.data(), dimensions, channels, peaks, threads) && peaks == expected, "peaks", channels);
+        }
+
+        std::vector<float> peaks;
+        texpress::find_peaks_parallel(values.data(), dimensions, channels, peaks);
+
+        // Slice normalization matches normalize_val_per_component
+        std::vector<float> normalized(count);
+        check(texpress::normalize(values.data(), dimensions, channels, peaks, texpress::NORMALIZE_SLICE, 32, (uint8_t*)normalized.data()), "normalize", channels);
+
+        std::vector<float> reference(count);
+        for (uint64_t i = 0; i < count; i++) {
+            reference[i] = texpress::normalize_val_per_component(values[i], channels, peaks, i / (slice_texels * channels), i % channels);
+        }
+        check(max_difference(normalized.data(), reference.data(), count) < 1e-6f, "normalized values", channels);
+        check(normalized.back() == 1.0f, "constant slice is divided by its maximum", channels);
+
+        // Denormalizing in place restores the input
+        check(texpress::denormalize(normalized.data(), dimensions, channels, peaks, texpress::NORMALIZE_SLICE, normalized.data()), "denormalize", channels);
+        check(max_difference(normalized.data(), values.data(), count) < 1e-4f * (100.0f * channels), "denormalized values", channels);
+
+        // Volume normalization uses one range per component, which is fully covered
+        const std::vector<float> volume = texpress::volume_peaks(peaks, channels);
+        check(texpress::normalize(values.data(), dimensions, channels, volume, texpress::NORMALIZE_VOLUME, 32, (uint8_t*)normalized.data()), "volume normalize", channels);
+        for (int c = 0; c < channels; c++) {
+            float min = 1.0f, max = 0.0f;
+            for (uint64_t i = c; i < count; i += channels) {
+                min = std::min(min, normalized[i]);
+                max = std::max(max, normalized[i]);
+            }
+            check(std::fabs(min) < 1e-6f && std::fabs(max - 1.0f) < 1e-6f, "volume range", channels);
+        }
+
+        // Half input gives the same peaks as its widened values and normalizes to half output
+        std::vector<uint16_t> half(small_count);
+        std::vector<float> widened(small_count);
+        texpress::convert_to_half(values.data(), half.data(), small_count);
+        texpress::convert_to_float(half.data(), widened.data(), small_count);
+
+        std::vector<float> half_peaks, widened_peaks;
+        check(texpress::find_peaks_parallel(half.data(), small, channels, half_peaks) && texpress::find_peaks_parallel(widened.data(), small, channels, widened_peaks) && half_peaks == widened_peaks, "half peaks", channels);
+
+        std::vector<uint16_t> half_normalized(small_count);
+        std::vector<float> float_normalized(small_count);
+        check(texpress::normalize(half.data(), small, channels, half_peaks, texpress::NORMALIZE_SLICE, 16, (uint8_t*)half_normalized.data()), "half normalize", channels);
+        check(texpress::normalize(widened.data(), small, channels, widened_peaks, texpress::NORMALIZE_SLICE, 32, (uint8_t*)float_normalized.data()), "float normalize", channels);
+        texpress::convert_to_float(half_normalized.data(), widened.data(), small_count);
+        check(max_difference(widened.data(), float_normalized.data(), small_count) < 1e-3f, "half normalized values", channels);
+
+        // Narrowing in place would overwrite unread values
+        check(!texpress::normalize(values.data(), small, channels, peaks, texpress::NORMALIZE_SLICE, 16, (uint8_t*)values.data()), "narrowing in place is rejected", channels);
+        check(!texpress::normalize(values.data(), dimensions, channels, volume, texpress::NORMALIZE_SLICE, 32, (uint8_t*)normalized.data()), "too few peaks are rejected", channels);
+    }
+
+    std::printf("%d normalizer checks failed\n", failures);
+    return (failures == 0) ? 0 : 1;
+}
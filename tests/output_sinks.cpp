@@ -0,0 +1,116 @@
+// Writes slices out of order through every sink and checks the bytes that end up in memory or on disk.
+#include <texpress/io/output_sink.hpp>
+
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <vector>
+
+namespace {
+    int failures = 0;
+
+    void check(bool condition, const char* what) {
+        if (!condition) {
+            std::printf("FAILED: %s\n", what);
+            failures++;
+        }
+    }
+
+    std::vector<uint8_t> read_file(const char* path) {
+        std::ifstream file(path, std::ios::binary);
+        return std::vector<uint8_t>(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    }
+
+    // Slice s of size slice_bytes holds the byte s + 1, written back to front like threads finishing out of order
+    bool write_slices(texpress::OutputSink& sink, uint64_t slices, uint64_t slice_bytes) {
+        for (uint64_t s = slices; s-- > 0;) {
+            std::vector<uint8_t> slice(slice_bytes, (uint8_t)(s + 1));
+            if (!sink.write(s * slice_bytes, slice.data(), slice_bytes))
+                return false;
+        }
+        return true;
+    }
+
+    bool has_slices(const uint8_t* data, uint64_t slices, uint64_t slice_bytes) {
+        for (uint64_t i = 0; i < slices * slice_bytes; i++) {
+            if (data[i] != (uint8_t)(i / slice_bytes + 1))
+                return false;
+        }
+        return true;
+    }
+}
+
+int main() {
+    constexpr uint64_t SLICES = 5;
+    constexpr uint64_t SLICE_BYTES = 3000;
+    constexpr uint64_t HEADER = 100;
+    constexpr uint64_t BYTES = SLICES * SLICE_BYTES;
+    const uint8_t byte = 0;
+
+    // MemorySink
+    {
+        std::vector<uint8_t> buffer(BYTES);
+        texpress::MemorySink sink(buffer.data(), buffer.size());
+        check(write_slices(sink, SLICES, SLICE_BYTES), "memory sink write");
+        check(has_slices(buffer.data(), SLICES, SLICE_BYTES), "memory sink content");
+        check(sink.data(SLICE_BYTES, SLICE_BYTES) == buffer.data() + SLICE_BYTES, "memory sink data");
+        check(!sink.write(BYTES, &byte, 1), "memory sink rejects writes past its size");
+        check(!sink.data(BYTES - 1, 2), "memory sink rejects ranges past its size");
+    }
+
+    // FileSink keeps the header in front of the base offset when not truncating
+    {
+        const char* path = "output_sinks_file.bin";
+        {
+            std::ofstream header(path, std::ios::binary | std::ios::trunc);
+            std::vector<char> bytes(HEADER, 'H');
+            header.write(bytes.data(), bytes.size());
+        }
+
+        texpress::FileSink sink;
+        check(sink.open(path, HEADER, false, BYTES), "file sink open");
+        check(!sink.data(0, 1), "file sink has no memory");
+        check(write_slices(sink, SLICES, SLICE_BYTES), "file sink write");
+        check(!sink.write(BYTES, &byte, 1), "file sink rejects writes past its size");
+        check(sink.flush(), "file sink flush");
+        sink.close();
+        check(!sink.is_open() && !sink.write(0, &byte, 1), "closed file sink rejects writes");
+
+        std::vector<uint8_t> file = read_file(path);
+        check(file.size() == HEADER + BYTES, "file sink file size");
+        check(file.size() == HEADER + BYTES && file[0] == 'H' && file[HEADER - 1] == 'H', "file sink keeps the header");
+        check(file.size() == HEADER + BYTES && has_slices(file.data() + HEADER, SLICES, SLICE_BYTES), "file sink content");
+
+        // Truncating drops the old content
+        check(sink.open(path), "file sink reopen");
+        check(sink.write(0, &byte, 1), "file sink write after truncation");
+        sink.close();
+        check(read_file(path).size() == 1, "file sink truncates");
+        std::remove(path);
+    }
+
+    // MappedSink at a base that is not a multiple of the page size grows the file to fit
+    {
+        const char* path = "output_sinks_mapped.bin";
+        std::remove(path);
+
+        texpress::MappedSink sink;
+        check(!sink.open(path, HEADER, 0), "mapped sink rejects empty ranges");
+        check(sink.open(path, HEADER, BYTES), "mapped sink open");
+        check(write_slices(sink, SLICES, SLICE_BYTES), "mapped sink write");
+        uint8_t* data = sink.data(0, BYTES);
+        check(data && has_slices(data, SLICES, SLICE_BYTES), "mapped sink data");
+        check(!sink.write(BYTES, &byte, 1), "mapped sink rejects writes past its size");
+        check(!sink.data(BYTES - 1, 2), "mapped sink rejects ranges past its size");
+        check(sink.flush(), "mapped sink flush");
+        sink.close();
+
+        std::vector<uint8_t> file = read_file(path);
+        check(file.size() == HEADER + BYTES, "mapped sink file size");
+        check(file.size() == HEADER + BYTES && has_slices(file.data() + HEADER, SLICES, SLICE_BYTES), "mapped sink content");
+        std::remove(path);
+    }
+
+    std::printf("%d output sink checks failed\n", failures);
+    return (failures == 0) ? 0 : 1;
+}
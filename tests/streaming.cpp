@@ -0,0 +1,184 @@
+// Streams raw and synthetic inputs slab by slab and compares the output with compressing the whole volume at once.
+#include <texpress/compression/streaming.hpp>
+#include <texpress/compression/compressor.hpp>
+#include <texpress/io/file_io.hpp>
+#include <texpress/io/ktx_index.hpp>
+#include <texpress/utility/stringtools.hpp>
+
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+    int failures = 0;
+
+    void check(bool condition, const char* what) {
+        if (!condition) {
+            std::printf("FAILED: %s\n", what);
+            failures++;
+        }
+    }
+
+    texpress::EncoderSettings encoder_settings() {
+        texpress::EncoderSettings settings;
+        settings.encoding = nvtt::Format_BC6S;
+        settings.backend = texpress::EncoderBackend::BACKEND_NATIVE;
+        settings.threads = 2;
+        return settings;
+    }
+
+    // BC6H blocks of the whole volume, encoded in one call
+    std::vector<uint8_t> compress_volume(const glm::ivec4& dimensions, std::vector<float>& texels) {
+        texpress::EncoderData input{};
+        input.gl_format = (uint32_t)texpress::gl_format(3);
+        input.gl_internal = (uint32_t)texpress::gl_internal(3, 32, true);
+        input.dim_x = dimensions.x;
+        input.dim_y = dimensions.y;
+        input.dim_z = dimensions.z;
+        input.dim_t = dimensions.w;
+        input.channels = 3;
+        input.data_bytes = texels.size() * sizeof(float);
+        input.data_ptr = (uint8_t*)texels.data();
+
+        texpress::Encoder encoder;
+        texpress::EncoderSettings settings = encoder_settings();
+        int progress = 0;
+        settings.progress_ptr = &progress;
+        std::vector<uint8_t> blocks(texpress::Encoder::encoded_size(settings, input));
+        texpress::MemorySink sink(blocks.data(), blocks.size());
+        texpress::EncoderData output{};
+        if (!encoder.compress(settings, input, output, sink))
+            blocks.clear();
+
+        return blocks;
+    }
+
+    std::vector<uint8_t> read_file(const std::string& path, uint64_t offset = 0) {
+        const uint64_t bytes = texpress::file_size(path.c_str());
+        std::vector<uint8_t> data((bytes > offset) ? bytes - offset : 0);
+        if (data.empty() || !texpress::file_read(path.c_str(), (char*)data.data(), data.size(), offset))
+            data.clear();
+        return data;
+    }
+
+    // Blocks of every time step of a KTX dataset, read through the index sidecar written by the stream
+    std::vector<uint8_t> read_ktx(const std::string& path) {
+        texpress::KTXReader reader;
+        if (!reader.open(path.c_str()))
+            return {};
+
+        const texpress::KTXIndex& index = reader.index();
+        std::vector<uint8_t> blocks(index.slices() * index.slice_bytes);
+        for (int t = 0; t < index.dimensions.w; t++) {
+            uint8_t* ptr = blocks.data() + t * index.dimensions.z * index.slice_bytes;
+            if (!reader.read(t, 0, index.dimensions.z, ptr))
+                return {};
+        }
+        return blocks;
+    }
+}
+
+int main() {
+    // Raw input with a leading dimension header, slabs of 2 slices do not divide the depth
+    const glm::ivec4 dimensions(21, 14, 5, 3);
+    const std::string path_in = "streaming_input.raw";
+    const std::string path_out = "streaming_output";
+
+    std::mt19937 rng(11);
+    std::uniform_real_distribution<float> value(-50.0f, 50.0f);
+    std::vector<float> texels((uint64_t)dimensions.x * dimensions.y * dimensions.z * dimensions.w * 3);
+    for (float& v : texels) {
+        v = value(rng);
+    }
+
+    std::vector<char> file(sizeof(dimensions) + texels.size() * sizeof(float));
+    std::memcpy(file.data(), &dimensions.x, sizeof(dimensions));
+    std::memcpy(file.data() + sizeof(dimensions), texels.data(), texels.size() * sizeof(float));
+    check(texpress::file_save(path_in.c_str(), file.data(), file.size()), "write raw input");
+
+    const std::vector<uint8_t> expected = compress_volume(dimensions, texels);
+    check(!expected.empty(), "compress whole volume");
+
+    texpress::StreamSettings settings;
+    settings.input_format = texpress::StreamFormat::STREAM_RAW;
+    settings.input_path = path_in;
+    settings.slab_slices = 2;
+    settings.encoder = encoder_settings();
+    int progress = 0;
+    settings.progress_ptr = &progress;
+
+    // Raw output, through a mapping and through positional writes
+    for (bool mapped : { true, false }) {
+        settings.output_format = texpress::StreamFormat::STREAM_RAW;
+        settings.output_path = path_out + ".raw";
+        settings.mapped_output = mapped;
+
+        texpress::StreamStats stats;
+        check(texpress::stream_compress(settings, &stats), "stream raw to raw");
+        check(stats.slabs == 3 * dimensions.w && stats.bytes_read == texels.size() * sizeof(float) && stats.bytes_written == expected.size(), "raw stream stats");
+        check(progress == 100, "raw stream progress");
+        check(read_file(settings.output_path) == expected, "raw output matches the whole volume");
+
+        glm::ivec4 dims_out(0);
+        texpress::file_read((path_out + "_dims.raw").c_str(), (char*)&dims_out.x, sizeof(dims_out));
+        check(dims_out == dimensions, "raw output dimensions");
+    }
+    std::remove((path_out + ".raw").c_str());
+    std::remove((path_out + "_dims.raw").c_str());
+
+    // KTX output, one file per time step and monolithic
+    for (bool monolithic : { false, true }) {
+        settings.output_format = texpress::StreamFormat::STREAM_KTX;
+        settings.output_path = path_out;
+        settings.monolithic = monolithic;
+        settings.mapped_output = true;
+
+        check(texpress::stream_compress(settings), "stream raw to KTX");
+        check(read_ktx(path_out) == expected, "KTX output matches the whole volume");
+
+        for (int t = -1; t < dimensions.w; t++) {
+            std::remove(texpress::str_canonical(path_out, -1, t).c_str());
+        }
+        std::remove(texpress::ktx_index_path(path_out.c_str()).c_str());
+    }
+
+    // Synthetic input generated per slab matches the generated volume
+    {
+        texpress::StreamSettings abc = settings;
+        abc.input_format = texpress::StreamFormat::STREAM_ABC;
+        abc.abc.begin = glm::ivec4(-10, 0, -4, 0);
+        abc.abc.end = glm::ivec4(10, 9, 3, 2);
+        abc.output_format = texpress::StreamFormat::STREAM_RAW;
+        abc.output_path = path_out + ".raw";
+        abc.slab_slices = 3;
+
+        texpress::Texture field;
+        check(texpress::generate_abc(abc.abc, field), "generate ABC field");
+        std::vector<float> field_texels(field.bytes() / sizeof(float));
+        std::memcpy(field_texels.data(), field.data.data(), field.bytes());
+
+        check(texpress::stream_compress(abc), "stream ABC to raw");
+        check(read_file(abc.output_path) == compress_volume(field.dimensions, field_texels), "ABC output matches the whole field");
+
+        std::remove(abc.output_path.c_str());
+        std::remove((path_out + "_dims.raw").c_str());
+    }
+
+    // Missing input and encodings other than BC6H fail before anything is written
+    {
+        texpress::StreamSettings missing = settings;
+        missing.input_path = "streaming_missing.raw";
+        check(!texpress::stream_compress(missing), "missing input is rejected");
+
+        texpress::StreamSettings bc7 = settings;
+        bc7.encoder.encoding = nvtt::Format_BC7;
+        check(!texpress::stream_compress(bc7), "other encodings are rejected");
+    }
+
+    std::remove(path_in.c_str());
+
+    std::printf("%d streaming checks failed\n", failures);
+    return (failures == 0) ? 0 : 1;
+}